@@ -0,0 +1,234 @@
+#include <librog/baseline.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <librog/benchmark.hpp>
+#include <librog/binary_log.hpp>
+#include <librog/details/timing.hpp>
+#include <librog/rog.hpp>
+
+namespace rog
+{
+    namespace
+    {
+        auto median (std::vector<double> values) -> double
+        {
+            std::ranges::sort(values);
+            auto const middle = values.size() / 2;
+            return values.size() % 2 == 1
+                ? values[middle]
+                : (values[middle - 1] + values[middle]) / 2;
+        }
+
+        auto grew (double const before, double const after, double const threshold)
+            -> bool
+        {
+            return after > before && after > before * (1 + threshold);
+        }
+
+        /**
+         *  \brief Returns e.g. " (+12.5 %)", \p note is appended inside
+         *  the parentheses.
+         */
+        auto growth
+            (double const before, double const after, std::string const& note = "")
+            -> std::string
+        {
+            if (before <= 0)
+            {
+                return note.empty() ? std::string() : " (" + note + ")";
+            }
+
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "+%.1f %%", 100 * (after / before - 1));
+            return " (" + std::string(buffer) + (note.empty() ? "" : ", " + note) + ")";
+        }
+
+        auto format_count (double const value) -> std::string
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.0f", value);
+            return buffer;
+        }
+    }
+
+// Free functions:
+
+    auto measurement_of
+        (LeafTest const& t) -> Measurement
+    {
+        auto m = Measurement();
+        if constexpr (details::TrackAllocations)
+        {
+            m.allocations_ = t.allocations().count_;
+        }
+        if (auto const instructions = t.hardware_counters().instructions_)
+        {
+            m.instructions_ = static_cast<double>(*instructions);
+        }
+        return m;
+    }
+
+    auto measurement_of
+        (BenchmarkTest const& t) -> Measurement
+    {
+        auto m = Measurement();
+        auto const& s = t.stats();
+        m.times_ = s.times_;
+        auto const iterations = s.iterations_ * s.samples_;
+        if (auto const instructions = t.hardware_counters().instructions_;
+            instructions && iterations > 0)
+        {
+            m.instructions_ = static_cast<double>(*instructions)
+                            / static_cast<double>(iterations);
+        }
+        return m;
+    }
+
+// Baseline:
+
+    Baseline::Baseline
+        (BinaryLog const& log, RegressionSettings const settings) :
+        settings_ (settings)
+    {
+        for (auto i = std::size_t {0}; i < log.size(); ++i)
+        {
+            auto const e = log.entry(i);
+            if (e.kind_ == LogEntryKind::Composite
+             || e.result_ == TestResult::NotEvaluated)
+            {
+                continue;
+            }
+
+            auto m = log.measurement(i);
+            if (not m.times_.empty() || m.allocations_ || m.instructions_)
+            {
+                entries_[log.path(i)] = std::move(m);
+            }
+        }
+    }
+
+    auto Baseline::size
+        () const -> std::size_t
+    {
+        return entries_.size();
+    }
+
+    auto Baseline::regressions
+        (std::string_view const path, Measurement const& current) const
+        -> std::vector<std::string>
+    {
+        auto found = std::vector<std::string>();
+        auto const it = entries_.find(std::string(path));
+        if (it == entries_.end())
+        {
+            return found;
+        }
+
+        auto const& before = it->second;
+        auto const threshold = settings_.threshold_;
+        if (not before.times_.empty() && not current.times_.empty())
+        {
+            auto const m0 = median(before.times_);
+            auto const m1 = median(current.times_);
+            auto const p = details::mann_whitney_greater(before.times_, current.times_);
+            if (p < settings_.significance_ && grew(m0, m1, threshold))
+            {
+                using duration_t = std::chrono::duration<double, std::nano>;
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "p = %.2g", p);
+                found.emplace_back(
+                    "Median time regressed from "
+                  + details::format_duration(duration_t(m0)) + " to "
+                  + details::format_duration(duration_t(m1)) + growth(m0, m1, buffer)
+                );
+            }
+        }
+
+        if (before.allocations_ && current.allocations_)
+        {
+            auto const a0 = static_cast<double>(*before.allocations_);
+            auto const a1 = static_cast<double>(*current.allocations_);
+            if (grew(a0, a1, threshold))
+            {
+                found.emplace_back(
+                    "Allocations regressed from " + format_count(a0)
+                  + " to " + format_count(a1) + growth(a0, a1)
+                );
+            }
+        }
+
+        if (before.instructions_ && current.instructions_)
+        {
+            auto const i0 = *before.instructions_;
+            auto const i1 = *current.instructions_;
+            if (grew(i0, i1, threshold))
+            {
+                found.emplace_back(
+                    "Instructions regressed from " + format_count(i0)
+                  + " to " + format_count(i1) + growth(i0, i1)
+                );
+            }
+        }
+        return found;
+    }
+
+    auto details::mann_whitney_greater
+        (std::span<double const> const before, std::span<double const> const after)
+        -> double
+    {
+        auto const n0 = static_cast<double>(before.size());
+        auto const n1 = static_cast<double>(after.size());
+        if (before.empty() || after.empty())
+        {
+            return 1;
+        }
+
+        // Values of both samples sorted, each marked by its sample.
+        auto values = std::vector<std::pair<double, bool>>();
+        values.reserve(before.size() + after.size());
+        for (auto const v : before)
+        {
+            values.emplace_back(v, false);
+        }
+        for (auto const v : after)
+        {
+            values.emplace_back(v, true);
+        }
+        std::ranges::sort(values);
+
+        // Tied values share the mean of their ranks.
+        auto rankSum = 0.0;
+        auto ties = 0.0;
+        for (auto i = std::size_t {0}; i < values.size();)
+        {
+            auto j = i;
+            while (j < values.size() && values[j].first == values[i].first)
+            {
+                ++j;
+            }
+
+            auto const rank = static_cast<double>(i + j + 1) / 2;
+            for (auto k = i; k < j; ++k)
+            {
+                rankSum += values[k].second ? rank : 0.0;
+            }
+            auto const t = static_cast<double>(j - i);
+            ties += t * t * t - t;
+            i = j;
+        }
+
+        auto const n = n0 + n1;
+        auto const u = rankSum - n1 * (n1 + 1) / 2;
+        auto const variance = n0 * n1 / 12 * ((n + 1) - ties / (n * (n - 1)));
+        if (variance <= 0)
+        {
+            return 1;
+        }
+
+        // Continuity correction.
+        auto const z = (u - n0 * n1 / 2 - 0.5) / std::sqrt(variance);
+        return 0.5 * std::erfc(z / std::sqrt(2.0));
+    }
+}
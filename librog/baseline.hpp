@@ -0,0 +1,129 @@
+#ifndef ROG_BASELINE_HPP
+#define ROG_BASELINE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rog
+{
+    class BinaryLog;
+    class LeafTest;
+    class BenchmarkTest;
+
+    /**
+     *  \brief Measurements of a leaf or a benchmark that are compared
+     *  with a baseline. Empty values were not measured.
+     */
+    struct Measurement
+    {
+        /**
+         *  \brief Time of one iteration in each sample of a benchmark
+         *  in nanoseconds. Leaves have no samples.
+         */
+        std::vector<double> times_ {};
+
+        /**
+         *  \brief Number of allocations of a leaf, see \c AllocationStats .
+         */
+        std::optional<std::uint64_t> allocations_ {};
+
+        /**
+         *  \brief Retired instructions of a leaf, or of one iteration
+         *  of a benchmark, see \c HardwareCounters .
+         */
+        std::optional<double> instructions_ {};
+    };
+
+    /**
+     *  \brief Returns measurements of the last run of \p t .
+     */
+    auto measurement_of (LeafTest const& t) -> Measurement;
+
+    /**
+     *  \brief Returns measurements of the last run of \p t .
+     */
+    auto measurement_of (BenchmarkTest const& t) -> Measurement;
+
+    /**
+     *  \brief Specifies when a measurement regressed.
+     */
+    struct RegressionSettings
+    {
+        /**
+         *  \brief Relative growth that is considered noise, e.g. 0.05
+         *  allows medians, allocations, and instructions to grow by 5 %.
+         */
+        double threshold_ {0.05};
+
+        /**
+         *  \brief Significance level of the test that times of benchmark
+         *  samples grew.
+         */
+        double significance_ {0.01};
+    };
+
+    /**
+     *  \brief Measurements of a previous run that a run is compared with,
+     *  see \c RunSettings::baseline_ .
+     *
+     *  The baseline is read from a binary log, so a run records it with
+     *  \c BinaryLogWriter and the next run compares against it.
+     *  A benchmark regressed if the Mann-Whitney U test finds its sample
+     *  times larger at the significance level and its median grew more
+     *  than the threshold, so a single slow sample does not fail it.
+     *  Allocations and instructions regressed if they grew more than
+     *  the threshold. Times of leaves are single measurements, so they
+     *  are not compared.
+     */
+    class Baseline
+    {
+    public:
+        /**
+         *  \brief Reads measurements of leaves and benchmarks from \p log .
+         *  \param log log of the previous run.
+         *  \param settings specifies when a measurement regressed.
+         */
+        explicit Baseline (
+            BinaryLog const& log,
+            RegressionSettings settings = RegressionSettings()
+        );
+
+        /**
+         *  \brief Returns number of tests with measurements.
+         */
+        auto size () const -> std::size_t;
+
+        /**
+         *  \brief Compares \p current measurements of the test at \p path
+         *  with the baseline.
+         *  \return Descriptions of the regressions, empty if there is none
+         *  or if the test is not in the baseline.
+         */
+        auto regressions (std::string_view path, Measurement const& current) const
+            -> std::vector<std::string>;
+
+    private:
+        std::unordered_map<std::string, Measurement> entries_;
+        RegressionSettings settings_;
+    };
+
+    namespace details
+    {
+        /**
+         *  \brief One-sided Mann-Whitney U test that values of \p after
+         *  tend to be larger than values of \p before . Uses the normal
+         *  approximation with correction for ties.
+         *  \return p-value of the test, 1 if either sample is empty.
+         */
+        auto mann_whitney_greater
+            (std::span<double const> before, std::span<double const> after)
+            -> double;
+    }
+}
+
+#endif
@@ -0,0 +1,262 @@
+#include <librog/benchmark.hpp>
+#include <librog/baseline.hpp>
+#include <librog/details/cancellation.hpp>
+#include <librog/details/hardware_counters.hpp>
+#include <librog/details/run_context.hpp>
+#include <librog/details/timing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <numeric>
+#include <vector>
+
+namespace rog
+{
+    namespace
+    {
+        using clock_t = std::chrono::steady_clock;
+    }
+
+    BenchmarkTest::BenchmarkTest
+        (std::string name, BenchmarkSettings settings) :
+        Test (std::move(name)),
+        settings_ (settings),
+        evaluated_ (false)
+    {
+    }
+
+    auto BenchmarkTest::run
+        (details::RunContext& context) -> void
+    {
+        stats_ = BenchmarkStats();
+        error_.clear();
+        regression_.clear();
+        this->set_hardware_counters(HardwareCounters());
+        this->set_times({}, {});
+        evaluated_ = false;
+
+        auto const* cancelled = context.cancel_ ? &context.cancel_->flag() : nullptr;
+        if (cancelled && cancelled->load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        evaluated_ = true;
+
+        {
+            auto const events = details::lock_events(context);
+            for (auto* l : context.settings_->listeners_)
+            {
+                l->on_benchmark_started(*this, context.path_);
+            }
+        }
+
+        auto const wallStart = clock_t::now();
+        auto const cpuStart = details::thread_cpu_time();
+
+        try
+        {
+            if (not this->measure(context.settings_->hardwareCounters_, cancelled))
+            {
+                // The run was cancelled, so the benchmark is not evaluated.
+                stats_ = BenchmarkStats();
+                this->set_hardware_counters(HardwareCounters());
+                evaluated_ = false;
+            }
+        }
+        catch (std::exception const& e)
+        {
+            using namespace std::string_literals;
+            error_ = "Unhandled exception: "s + e.what();
+        }
+        catch (...)
+        {
+            error_ = "Unhandled exception.";
+        }
+
+        this->set_times(
+            clock_t::now() - wallStart,
+            details::thread_cpu_time() - cpuStart
+        );
+
+        if (auto const* baseline = context.settings_->baseline_;
+            baseline && evaluated_ && error_.empty())
+        {
+            for (auto const& r : baseline->regressions(context.path_, measurement_of(*this)))
+            {
+                regression_ += (regression_.empty() ? "" : "; ") + r;
+            }
+        }
+
+        if (context.cancel_ && (not error_.empty() || not regression_.empty()))
+        {
+            context.cancel_->add_failure();
+        }
+
+        auto const events = details::lock_events(context);
+        for (auto* l : context.settings_->listeners_)
+        {
+            l->on_benchmark_finished(*this, context.path_);
+        }
+    }
+
+    auto BenchmarkTest::result
+        () const -> TestResult
+    {
+        return
+            not evaluated_
+                ? TestResult::NotEvaluated :
+            not error_.empty()
+                ? TestResult::Fail :
+            not regression_.empty()
+                ? TestResult::Partial :
+            TestResult::Pass;
+    }
+
+    auto BenchmarkTest::summary
+        () const -> TestSummary
+    {
+        auto const r = this->result();
+        return TestSummary {
+            .pass_ = r == TestResult::Pass ? 1u : 0u,
+            .fail_ = r == TestResult::Fail ? 1u : 0u,
+            .partial_ = r == TestResult::Partial ? 1u : 0u,
+            .notEvaluated_ = r == TestResult::NotEvaluated ? 1u : 0u
+        };
+    }
+
+    auto BenchmarkTest::stats
+        () const -> BenchmarkStats const&
+    {
+        return stats_;
+    }
+
+    auto BenchmarkTest::error
+        () const -> std::string const&
+    {
+        return error_;
+    }
+
+    auto BenchmarkTest::regression
+        () const -> std::string const&
+    {
+        return regression_;
+    }
+
+    auto BenchmarkTest::settings
+        () const -> BenchmarkSettings const&
+    {
+        return settings_;
+    }
+
+    auto BenchmarkTest::accept
+        (IVisitor& v) -> void
+    {
+        v.visit(*this);
+    }
+
+    auto BenchmarkTest::run_iterations
+        (std::size_t const n) -> std::chrono::nanoseconds
+    {
+        auto const start = clock_t::now();
+        for (auto i = std::size_t {0}; i < n; ++i)
+        {
+            this->body();
+        }
+        return clock_t::now() - start;
+    }
+
+    auto BenchmarkTest::measure
+        ( bool const                     hardwareCounters
+        , std::atomic<bool> const* const cancelled ) -> bool
+    {
+        auto const is_cancelled = [cancelled]()
+        {
+            return cancelled && cancelled->load(std::memory_order_relaxed);
+        };
+
+        // Warmup.
+        auto const warmupEnd = clock_t::now() + settings_.warmupTime_;
+        do
+        {
+            this->body();
+        }
+        while (clock_t::now() < warmupEnd && not is_cancelled());
+
+        // Calibration, grows the batch until it takes long enough.
+        auto iterations = std::size_t {1};
+        for (;;)
+        {
+            if (is_cancelled())
+            {
+                return false;
+            }
+
+            auto const t = this->run_iterations(iterations);
+            if (t >= settings_.minSampleTime_)
+            {
+                break;
+            }
+
+            auto const ratio = t.count() > 0
+                ? static_cast<double>(settings_.minSampleTime_.count())
+                / static_cast<double>(t.count())
+                : 10.0;
+            auto const factor = std::clamp(1.2 * ratio, 2.0, 10.0);
+            iterations = static_cast<std::size_t>(
+                std::ceil(static_cast<double>(iterations) * factor)
+            );
+        }
+
+        // Measurement.
+        auto const sampleCount = std::max(settings_.sampleCount_, std::size_t {1});
+        auto samples = std::vector<double>();
+        samples.reserve(sampleCount);
+        auto counters = details::HardwareCounterScope(hardwareCounters);
+        for (auto i = std::size_t {0}; i < sampleCount; ++i)
+        {
+            if (is_cancelled())
+            {
+                return false;
+            }
+
+            auto const t = this->run_iterations(iterations);
+            samples.emplace_back(
+                static_cast<double>(t.count()) / static_cast<double>(iterations)
+            );
+        }
+        this->set_hardware_counters(counters.stop());
+
+        std::ranges::sort(samples);
+        auto const n = static_cast<double>(samples.size());
+        auto const mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+        auto const middle = samples.size() / 2;
+        auto const median = samples.size() % 2 == 1
+            ? samples[middle]
+            : (samples[middle - 1] + samples[middle]) / 2;
+        auto variance = 0.0;
+        for (auto const s : samples)
+        {
+            variance += (s - mean) * (s - mean);
+        }
+        variance = samples.size() > 1 ? variance / (n - 1) : 0.0;
+
+        stats_.iterations_ = iterations;
+        stats_.samples_ = samples.size();
+        stats_.mean_ = std::chrono::duration<double, std::nano>(mean);
+        stats_.median_ = std::chrono::duration<double, std::nano>(median);
+        stats_.stddev_ = std::chrono::duration<double, std::nano>(std::sqrt(variance));
+        stats_.min_ = std::chrono::duration<double, std::nano>(samples.front());
+        stats_.times_ = std::move(samples);
+
+        if (mean > 0)
+        {
+            auto const perSecond = 1e9 / mean;
+            stats_.itemsPerSecond_ =
+                static_cast<double>(settings_.itemsPerIteration_) * perSecond;
+            stats_.bytesPerSecond_ =
+                static_cast<double>(settings_.bytesPerIteration_) * perSecond;
+        }
+        return true;
+    }
+}
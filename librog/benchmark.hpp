@@ -0,0 +1,203 @@
+#ifndef ROG_BENCHMARK_HPP
+#define ROG_BENCHMARK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <librog/rog.hpp>
+
+namespace rog
+{
+    /**
+     *  \brief Settings of a benchmark.
+     */
+    struct BenchmarkSettings
+    {
+        /**
+         *  \brief Time for which the body runs before measuring.
+         */
+        std::chrono::nanoseconds warmupTime_ {std::chrono::milliseconds(50)};
+
+        /**
+         *  \brief Minimal duration of one sample. Number of iterations
+         *  in a sample is calibrated to reach it.
+         */
+        std::chrono::nanoseconds minSampleTime_ {std::chrono::milliseconds(10)};
+
+        /**
+         *  \brief Number of measured samples.
+         */
+        std::size_t sampleCount_ {20};
+
+        /**
+         *  \brief Number of items processed by one iteration.
+         *  Zero if throughput in items is not reported.
+         */
+        std::size_t itemsPerIteration_ {0};
+
+        /**
+         *  \brief Number of bytes processed by one iteration.
+         *  Zero if throughput in bytes is not reported.
+         */
+        std::size_t bytesPerIteration_ {0};
+    };
+
+    /**
+     *  \brief Statistics of a benchmark. Times are per single iteration.
+     */
+    struct BenchmarkStats
+    {
+        std::size_t iterations_ {0};
+        std::size_t samples_ {0};
+        std::chrono::duration<double, std::nano> mean_ {0};
+        std::chrono::duration<double, std::nano> median_ {0};
+        std::chrono::duration<double, std::nano> stddev_ {0};
+        std::chrono::duration<double, std::nano> min_ {0};
+        double itemsPerSecond_ {0};
+        double bytesPerSecond_ {0};
+
+        /**
+         *  \brief Time of one iteration in each sample in nanoseconds,
+         *  sorted.
+         */
+        std::vector<double> times_ {};
+    };
+
+    /**
+     *  \brief Base class for implementation of a microbenchmark.
+     *
+     *  The body is run repeatedly, first to warm up, then to calibrate
+     *  number of iterations per sample, and finally to measure samples.
+     *  Benchmarks run concurrently with other tests in a parallel run,
+     *  it is best to put them into a serial composite. In an isolated run,
+     *  benchmarks are run in the calling process after all leaves.
+     */
+    class BenchmarkTest : public Test
+    {
+    public:
+        /**
+         *  \brief Initializes the benchmark with \p name .
+         *  \param name name of the benchmark.
+         *  \param settings settings of the measurement.
+         */
+        BenchmarkTest (
+            std::string name,
+            BenchmarkSettings settings = BenchmarkSettings()
+        );
+
+        using Test::run;
+
+        /**
+         *  \brief Runs the benchmark. It is not evaluated if the run
+         *  is cancelled before the measurement completes. Errors and
+         *  regressions count as failures of the run.
+         *  \param context state shared by all tests of the run.
+         */
+        auto run (details::RunContext& context) -> void override final;
+
+        /**
+         *  \brief Returns result of the benchmark.
+         *  Pass if the body completed, Fail if it threw, Partial if it
+         *  regressed against \c RunSettings::baseline_ .
+         *  \return Result of the benchmark.
+         */
+        auto result () const -> TestResult override;
+
+        /**
+         *  \brief Returns summary with this test as the only leaf.
+         *  \return Summary of the result.
+         */
+        auto summary () const -> TestSummary override;
+
+        /**
+         *  \brief Returns statistics of the last run.
+         *  \return Statistics of the last run.
+         */
+        auto stats () const -> BenchmarkStats const&;
+
+        /**
+         *  \brief Returns description of the exception thrown by the body.
+         *  \return Error message, empty if the body did not throw.
+         */
+        auto error () const -> std::string const&;
+
+        /**
+         *  \brief Returns description of the regressions against
+         *  \c RunSettings::baseline_ .
+         *  \return Regressions, empty if the benchmark did not regress.
+         */
+        auto regression () const -> std::string const&;
+
+        /**
+         *  \brief Returns settings of the benchmark.
+         *  \return Settings of the benchmark.
+         */
+        auto settings () const -> BenchmarkSettings const&;
+
+        /**
+         *  \brief Implements the visitor design patter.
+         *  \param visitor visitor.
+         */
+        auto accept (IVisitor& visitor) -> void override;
+
+    protected:
+        /**
+         *  \brief Child classes implements single iteration
+         *  of the benchmark in this method.
+         */
+        virtual auto body () -> void = 0;
+
+    private:
+        auto run_iterations (std::size_t n) -> std::chrono::nanoseconds;
+        /**
+         *  \brief Measures the body. Stops early once \p cancelled is set.
+         *  \return false if the measurement was cancelled.
+         */
+        auto measure (
+            bool hardwareCounters,
+            std::atomic<bool> const* cancelled
+        ) -> bool;
+
+    private:
+        friend struct details::TestAccess;
+
+    private:
+        BenchmarkSettings settings_;
+        BenchmarkStats stats_;
+        std::string error_;
+        std::string regression_;
+        bool evaluated_;
+    };
+
+    /**
+     *  \brief Prevents the compiler from optimizing \p value away.
+     *  \param value value that is treated as used.
+     */
+    template<class T>
+    auto do_not_optimize (T const& value) -> void
+    {
+        #if defined(__GNUC__) || defined(__clang__)
+        __asm__ __volatile__ ("" : : "r,m" (value) : "memory");
+        #else
+        auto const* volatile p = &value;
+        static_cast<void>(p);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        #endif
+    }
+
+    /**
+     *  \brief Forces all pending writes to memory to be performed.
+     */
+    inline auto clobber_memory () -> void
+    {
+        #if defined(__GNUC__) || defined(__clang__)
+        __asm__ __volatile__ ("" : : : "memory");
+        #else
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        #endif
+    }
+}
+
+#endif
@@ -0,0 +1,794 @@
+#include <librog/binary_log.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <librog/benchmark.hpp>
+#include <librog/details/timing.hpp>
+#include <librog/rog.hpp>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rog
+{
+    namespace
+    {
+        constexpr auto Magic = std::string_view("ROGLOG\x01\n", 8);
+        constexpr auto NoNode = std::uint32_t {0xFFFFFFFF};
+        constexpr auto BlockHeaderSize = std::size_t {8};
+        constexpr auto MessageSize = std::size_t {16};
+        constexpr auto RecordSize = std::size_t {72};
+        constexpr auto MeasurementHeaderSize = std::size_t {32};
+
+        // Pending blocks are written out once they grow past this size.
+        constexpr auto FlushThreshold = std::size_t {1 << 16};
+
+        enum class BlockType : std::uint32_t
+        {
+            Names = 1,
+            Arena = 2,
+            Messages = 3,
+            Records = 4,
+            Measurements = 5
+        };
+
+        // Flags of a measurement.
+        constexpr auto HasAllocations = std::uint32_t {1};
+        constexpr auto HasInstructions = std::uint32_t {2};
+
+        auto load_u32 (char const* p) -> std::uint32_t
+        {
+            auto x = std::uint32_t {0};
+            for (auto i = 0u; i < 4; ++i)
+            {
+                x |= static_cast<std::uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+            }
+            return x;
+        }
+
+        auto load_u64 (char const* p) -> std::uint64_t
+        {
+            return static_cast<std::uint64_t>(load_u32(p))
+                 | static_cast<std::uint64_t>(load_u32(p + 4)) << 32;
+        }
+
+        auto is_failing (TestResult const r) -> bool
+        {
+            return r == TestResult::Fail || r == TestResult::Partial;
+        }
+    }
+
+// BinaryLogWriter:
+
+    BinaryLogWriter::BinaryLogWriter
+        (int const fd) :
+        out_ (fd),
+        arenaSize_ (0),
+        messageCount_ (0),
+        nodeCount_ (0)
+    {
+        out_.write(Magic);
+    }
+
+    BinaryLogWriter::~BinaryLogWriter
+        ()
+    {
+        this->write_blocks();
+    }
+
+    auto BinaryLogWriter::on_run_started
+        (Test const&) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        composites_.clear();
+        parents_.clear();
+    }
+
+    auto BinaryLogWriter::on_run_finished
+        (Test const&) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_blocks();
+        out_.flush();
+    }
+
+    auto BinaryLogWriter::on_test_finished
+        (LeafTest const& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        auto const firstMessage = messageCount_;
+        for (auto const& m : t.output())
+        {
+            this->add_message(m.type_, m.text_);
+        }
+        this->add_measurement(nodeCount_, measurement_of(t));
+        this->add_record(t, Record {
+            .node_ = nodeCount_++,
+            .parent_ = this->parent_of(t, path),
+            .kind_ = static_cast<std::uint8_t>(LogEntryKind::Leaf),
+            .result_ = t.result(),
+            .wallTime_ = t.wall_time(),
+            .cpuTime_ = t.cpu_time(),
+            .passCount_ = t.pass_count(),
+            .failCount_ = t.fail_count(),
+            .meanTime_ = 0,
+            .firstMessage_ = firstMessage
+        });
+    }
+
+    auto BinaryLogWriter::on_composite_started
+        (CompositeTest const& t, std::string_view const path) -> void
+    {
+        // Composites and their subtests are told apart by their addresses,
+        // siblings may have the same name and thus the same path.
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        auto const node = nodeCount_++;
+        composites_.insert_or_assign(&t, OpenComposite {node, std::string(path)});
+        for (auto const& st : t.subtests())
+        {
+            parents_.insert_or_assign(st.get(), node);
+            if (auto const* lazy = dynamic_cast<LazyTest const*>(st.get()))
+            {
+                // Lazy leaves are reported by their snapshots.
+                parents_.insert_or_assign(&lazy->snapshot(), node);
+            }
+        }
+    }
+
+    auto BinaryLogWriter::on_composite_finished
+        (CompositeTest const& t, std::string_view const path) -> void
+    {
+        auto const summary = t.summary();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        auto const it = composites_.find(&t);
+        if (it == composites_.end())
+        {
+            return;
+        }
+
+        this->add_record(t, Record {
+            .node_ = it->second.node_,
+            .parent_ = this->parent_of(t, path),
+            .kind_ = static_cast<std::uint8_t>(LogEntryKind::Composite),
+            .result_ = t.result(),
+            .wallTime_ = t.wall_time(),
+            .cpuTime_ = t.cpu_time(),
+            .passCount_ = summary.pass_,
+            .failCount_ = summary.fail_,
+            .meanTime_ = 0,
+            .firstMessage_ = messageCount_
+        });
+        composites_.erase(it);
+        for (auto const& st : t.subtests())
+        {
+            parents_.erase(st.get());
+            if (auto const* lazy = dynamic_cast<LazyTest const*>(st.get()))
+            {
+                parents_.erase(&lazy->snapshot());
+            }
+        }
+    }
+
+    auto BinaryLogWriter::on_benchmark_finished
+        (BenchmarkTest const& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        auto const firstMessage = messageCount_;
+        if (not t.error().empty())
+        {
+            this->add_message(TestMessageType::Fail, t.error());
+        }
+        if (not t.regression().empty())
+        {
+            this->add_message(TestMessageType::Fail, t.regression());
+        }
+        this->add_measurement(nodeCount_, measurement_of(t));
+        this->add_record(t, Record {
+            .node_ = nodeCount_++,
+            .parent_ = this->parent_of(t, path),
+            .kind_ = static_cast<std::uint8_t>(LogEntryKind::Benchmark),
+            .result_ = t.result(),
+            .wallTime_ = t.wall_time(),
+            .cpuTime_ = t.cpu_time(),
+            .passCount_ = 0,
+            .failCount_ = 0,
+            .meanTime_ = t.stats().mean_.count(),
+            .firstMessage_ = firstMessage
+        });
+    }
+
+    auto BinaryLogWriter::intern
+        (std::string_view const name) -> std::uint32_t
+    {
+        auto const [it, inserted] = nameIds_.try_emplace(
+            std::string(name),
+            static_cast<std::uint32_t>(nameIds_.size())
+        );
+        if (inserted)
+        {
+            names_.string(name);
+        }
+        return it->second;
+    }
+
+    auto BinaryLogWriter::parent_of
+        (Test const& t, std::string_view const path) const -> std::uint32_t
+    {
+        if (auto const it = parents_.find(&t); it != parents_.end())
+        {
+            return it->second;
+        }
+
+        // Tests that are not in the hierarchy, e.g. snapshots of leaves
+        // that timed out, are found by path.
+        auto const size = t.name().size() + 1;
+        if (path.size() <= size)
+        {
+            return NoNode;
+        }
+
+        auto const parentPath = path.substr(0, path.size() - size);
+        auto const it = std::ranges::find(
+            composites_,
+            parentPath,
+            [](auto const& c) -> std::string_view { return c.second.path_; }
+        );
+        return it == composites_.end() ? NoNode : it->second.node_;
+    }
+
+    auto BinaryLogWriter::add_message
+        (TestMessageType const type, std::string_view const text) -> void
+    {
+        messages_.u32(static_cast<std::uint32_t>(type));
+        messages_.u32(static_cast<std::uint32_t>(text.size()));
+        messages_.u64(arenaSize_);
+        for (auto const c : text)
+        {
+            arena_.u8(static_cast<std::uint8_t>(c));
+        }
+        arenaSize_ += text.size();
+        ++messageCount_;
+    }
+
+    auto BinaryLogWriter::add_measurement
+        (std::uint32_t const node, Measurement const& m) -> void
+    {
+        if (m.times_.empty() && not m.allocations_ && not m.instructions_)
+        {
+            return;
+        }
+
+        measurements_.u32(node);
+        measurements_.u32(
+            (m.allocations_ ? HasAllocations : 0u)
+          | (m.instructions_ ? HasInstructions : 0u)
+        );
+        measurements_.u64(m.allocations_.value_or(0));
+        measurements_.u64(std::bit_cast<std::uint64_t>(m.instructions_.value_or(0.0)));
+        measurements_.u32(static_cast<std::uint32_t>(m.times_.size()));
+        measurements_.u32(0);
+        for (auto const t : m.times_)
+        {
+            measurements_.u64(std::bit_cast<std::uint64_t>(t));
+        }
+    }
+
+    auto BinaryLogWriter::add_record
+        (Test const& t, Record const& r) -> void
+    {
+        records_.u32(r.node_);
+        records_.u32(r.parent_);
+        records_.u32(this->intern(t.name()));
+        records_.u8(r.kind_);
+        records_.u8(static_cast<std::uint8_t>(r.result_));
+        records_.u8(0);
+        records_.u8(0);
+        records_.u64(static_cast<std::uint64_t>(r.wallTime_.count()));
+        records_.u64(static_cast<std::uint64_t>(r.cpuTime_.count()));
+        records_.u64(r.passCount_);
+        records_.u64(r.failCount_);
+        records_.u64(std::bit_cast<std::uint64_t>(r.meanTime_));
+        records_.u64(r.firstMessage_);
+        records_.u32(static_cast<std::uint32_t>(messageCount_ - r.firstMessage_));
+        records_.u32(0);
+
+        auto const pending = names_.bytes().size()
+                           + arena_.bytes().size()
+                           + messages_.bytes().size()
+                           + measurements_.bytes().size()
+                           + records_.bytes().size();
+        if (pending >= FlushThreshold)
+        {
+            this->write_blocks();
+        }
+    }
+
+    auto BinaryLogWriter::write_blocks
+        () -> void
+    {
+        // Records are written last so that everything they refer to
+        // precedes them in the file.
+        auto const write_block = [this](BlockType type, details::ByteWriter& b)
+        {
+            if (b.bytes().empty())
+            {
+                return;
+            }
+            auto header = details::ByteWriter();
+            header.u32(static_cast<std::uint32_t>(type));
+            header.u32(static_cast<std::uint32_t>(b.bytes().size()));
+            out_.write(header.bytes());
+            out_.write(b.bytes());
+            b.clear();
+        };
+
+        write_block(BlockType::Names, names_);
+        write_block(BlockType::Arena, arena_);
+        write_block(BlockType::Messages, messages_);
+        write_block(BlockType::Measurements, measurements_);
+        write_block(BlockType::Records, records_);
+    }
+
+// BinaryLog:
+
+    BinaryLog::BinaryLog
+        (std::string const& path) :
+        data_ (nullptr),
+        size_ (0),
+        open_ (false)
+    {
+#if defined(__APPLE__) || defined(__linux__)
+        auto const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        struct stat st {};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            auto const size = static_cast<std::size_t>(st.st_size);
+            auto* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                data_ = static_cast<char const*>(data);
+                size_ = size;
+            }
+        }
+        ::close(fd);
+#else
+        auto file = std::ifstream(path, std::ios::binary);
+        if (not file)
+        {
+            return;
+        }
+        contents_.assign(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        );
+        data_ = contents_.data();
+        size_ = contents_.size();
+#endif
+        open_ = data_ && this->parse();
+    }
+
+    BinaryLog::~BinaryLog
+        ()
+    {
+#if defined(__APPLE__) || defined(__linux__)
+        if (data_)
+        {
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+#endif
+    }
+
+    auto BinaryLog::is_open
+        () const -> bool
+    {
+        return open_;
+    }
+
+    auto BinaryLog::size
+        () const -> std::size_t
+    {
+        return records_.size();
+    }
+
+    auto BinaryLog::entry
+        (std::size_t const i) const -> LogEntry
+    {
+        auto const* const r = records_[i];
+        auto const nameId = load_u32(r + 8);
+        auto const parentNode = load_u32(r + 4);
+        return LogEntry {
+            .kind_ = static_cast<LogEntryKind>(r[12]),
+            .result_ = static_cast<TestResult>(r[13]),
+            .name_ = nameId < names_.size() ? names_[nameId] : std::string_view(),
+            .parent_ = parentNode < nodes_.size() ? nodes_[parentNode] : NoParent,
+            .wallTime_ = std::chrono::nanoseconds(
+                static_cast<std::chrono::nanoseconds::rep>(load_u64(r + 16))
+            ),
+            .cpuTime_ = std::chrono::nanoseconds(
+                static_cast<std::chrono::nanoseconds::rep>(load_u64(r + 24))
+            ),
+            .passCount_ = load_u64(r + 32),
+            .failCount_ = load_u64(r + 40),
+            .meanTime_ = std::chrono::duration<double, std::nano>(
+                std::bit_cast<double>(load_u64(r + 48))
+            ),
+            .firstMessage_ = load_u64(r + 56),
+            .messageCount_ = load_u32(r + 64)
+        };
+    }
+
+    auto BinaryLog::message
+        (LogEntry const& e, std::uint32_t const i) const -> LogMessage
+    {
+        auto const index = e.firstMessage_ + i;
+        if (index >= messages_.size())
+        {
+            return LogMessage {TestMessageType::Info, std::string_view()};
+        }
+
+        auto const* const m = messages_[static_cast<std::size_t>(index)];
+        return LogMessage {
+            static_cast<TestMessageType>(load_u32(m)),
+            this->arena_text(load_u64(m + 8), load_u32(m + 4))
+        };
+    }
+
+    auto BinaryLog::measurement
+        (std::size_t const i) const -> Measurement
+    {
+        auto m = Measurement();
+        auto const it = measurements_.find(load_u32(records_[i]));
+        if (it == measurements_.end())
+        {
+            return m;
+        }
+
+        auto const* const p = it->second;
+        auto const flags = load_u32(p + 4);
+        if (flags & HasAllocations)
+        {
+            m.allocations_ = load_u64(p + 8);
+        }
+        if (flags & HasInstructions)
+        {
+            m.instructions_ = std::bit_cast<double>(load_u64(p + 16));
+        }
+        auto const count = std::size_t {load_u32(p + 24)};
+        m.times_.reserve(count);
+        for (auto j = std::size_t {0}; j < count; ++j)
+        {
+            m.times_.emplace_back(
+                std::bit_cast<double>(load_u64(p + MeasurementHeaderSize + 8 * j))
+            );
+        }
+        return m;
+    }
+
+    auto BinaryLog::path
+        (std::size_t i) const -> std::string
+    {
+        auto names = std::vector<std::string_view>();
+        while (i != NoParent && names.size() <= records_.size())
+        {
+            auto const e = this->entry(i);
+            names.emplace_back(e.name_);
+            i = e.parent_;
+        }
+
+        auto path = std::string();
+        for (auto it = names.rbegin(); it != names.rend(); ++it)
+        {
+            if (not path.empty())
+            {
+                path += '/';
+            }
+            path += *it;
+        }
+        return path;
+    }
+
+    auto BinaryLog::parse
+        () -> bool
+    {
+        if (size_ < Magic.size() || std::string_view(data_, Magic.size()) != Magic)
+        {
+            return false;
+        }
+
+        auto arenaSize = std::uint64_t {0};
+        auto pos = Magic.size();
+        while (size_ - pos >= BlockHeaderSize)
+        {
+            auto const type = static_cast<BlockType>(load_u32(data_ + pos));
+            auto const size = std::size_t {load_u32(data_ + pos + 4)};
+            pos += BlockHeaderSize;
+            if (size_ - pos < size)
+            {
+                // Incomplete block at the end of a log cut short.
+                break;
+            }
+
+            auto const* const block = data_ + pos;
+            switch (type)
+            {
+            case BlockType::Names:
+                for (auto p = std::size_t {0}; size - p >= 4;)
+                {
+                    auto const length = std::size_t {load_u32(block + p)};
+                    p += 4;
+                    if (size - p < length)
+                    {
+                        break;
+                    }
+                    names_.emplace_back(block + p, length);
+                    p += length;
+                }
+                break;
+
+            case BlockType::Arena:
+                arena_.emplace_back(ArenaBlock {arenaSize, {block, size}});
+                arenaSize += size;
+                break;
+
+            case BlockType::Messages:
+                for (auto p = std::size_t {0}; size - p >= MessageSize; p += MessageSize)
+                {
+                    messages_.emplace_back(block + p);
+                }
+                break;
+
+            case BlockType::Measurements:
+                for (auto p = std::size_t {0}; size - p >= MeasurementHeaderSize;)
+                {
+                    auto const count = std::size_t {load_u32(block + p + 24)};
+                    auto const length = MeasurementHeaderSize + 8 * count;
+                    if (size - p < length)
+                    {
+                        break;
+                    }
+                    measurements_[load_u32(block + p)] = block + p;
+                    p += length;
+                }
+                break;
+
+            case BlockType::Records:
+                for (auto p = std::size_t {0}; size - p >= RecordSize; p += RecordSize)
+                {
+                    auto const node = std::size_t {load_u32(block + p)};
+                    if (node >= nodes_.size())
+                    {
+                        nodes_.resize(node + 1, NoParent);
+                    }
+                    nodes_[node] = records_.size();
+                    records_.emplace_back(block + p);
+                }
+                break;
+
+            default:
+                // Unknown blocks are skipped.
+                break;
+            }
+            pos += size;
+        }
+        return true;
+    }
+
+    auto BinaryLog::arena_text
+        (std::uint64_t const offset, std::uint32_t const size) const
+        -> std::string_view
+    {
+        // Last block starting at or before the offset.
+        auto const it = std::upper_bound(
+            arena_.begin(),
+            arena_.end(),
+            offset,
+            [](std::uint64_t o, ArenaBlock const& b){ return o < b.offset_; }
+        );
+        if (it == arena_.begin())
+        {
+            return std::string_view();
+        }
+
+        auto const& b = *std::prev(it);
+        auto const start = static_cast<std::size_t>(offset - b.offset_);
+        if (start > b.data_.size() || b.data_.size() - start < size)
+        {
+            return std::string_view();
+        }
+        return b.data_.substr(start, size);
+    }
+
+// Free functions:
+
+    auto diff_logs
+        ( BinaryLog const&               before
+        , BinaryLog const&               after
+        , double const                   factor
+        , std::chrono::nanoseconds const minDifference ) -> LogDiff
+    {
+        auto const is_unit = [](LogEntry const& e)
+        {
+            return e.kind_ != LogEntryKind::Composite;
+        };
+
+        auto const time_of = [](LogEntry const& e)
+        {
+            return e.kind_ == LogEntryKind::Benchmark
+                ? e.meanTime_
+                : std::chrono::duration<double, std::nano>(e.wallTime_);
+        };
+
+        auto previous = std::unordered_map<std::string, std::size_t>();
+        for (auto i = std::size_t {0}; i < before.size(); ++i)
+        {
+            if (is_unit(before.entry(i)))
+            {
+                previous.emplace(before.path(i), i);
+            }
+        }
+
+        auto diff = LogDiff();
+        for (auto i = std::size_t {0}; i < after.size(); ++i)
+        {
+            auto const e = after.entry(i);
+            if (not is_unit(e) || e.result_ == TestResult::NotEvaluated)
+            {
+                continue;
+            }
+
+            auto path = after.path(i);
+            auto const it = previous.find(path);
+            if (it == previous.end())
+            {
+                if (is_failing(e.result_))
+                {
+                    diff.newlyFailing_.emplace_back(std::move(path));
+                }
+                continue;
+            }
+
+            auto const p = before.entry(it->second);
+            auto const wasFailing = is_failing(p.result_);
+            auto const nowFailing = is_failing(e.result_);
+            if (nowFailing && not wasFailing)
+            {
+                diff.newlyFailing_.emplace_back(path);
+            }
+            else if (not nowFailing && wasFailing)
+            {
+                diff.newlyPassing_.emplace_back(path);
+            }
+
+            auto const t0 = time_of(p);
+            auto const t1 = time_of(e);
+            auto const grewEnough =
+                e.kind_ == LogEntryKind::Benchmark || t1 - t0 > minDifference;
+            if (p.result_ != TestResult::NotEvaluated
+             && t1 > factor * t0
+             && grewEnough)
+            {
+                diff.slower_.emplace_back(SlowerTest {std::move(path), t0, t1});
+            }
+        }
+        return diff;
+    }
+
+    auto console_print_log
+        ( BinaryLog const&        log
+        , ConsoleOutputType const o
+        , ColorMode const         c ) -> void
+    {
+        auto console = Console(c);
+        auto summary = TestSummary();
+        for (auto i = std::size_t {0}; i < log.size(); ++i)
+        {
+            auto const e = log.entry(i);
+            if (e.kind_ == LogEntryKind::Composite)
+            {
+                continue;
+            }
+
+            switch (e.result_)
+            {
+            case TestResult::Pass:    ++summary.pass_;         break;
+            case TestResult::Fail:    ++summary.fail_;         break;
+            case TestResult::Partial: ++summary.partial_;      break;
+            default:                  ++summary.notEvaluated_; break;
+            }
+
+            console.print(
+                details::test_result_to_string(e.result_),
+                details::test_result_to_color(e.result_),
+                8
+            );
+            console.println(log.path(i));
+
+            if (o == ConsoleOutputType::NoLeaf)
+            {
+                continue;
+            }
+
+            if (e.kind_ == LogEntryKind::Benchmark && e.result_ == TestResult::Pass)
+            {
+                console.print("        ");
+                console.print("time", Color::Blue);
+                console.println(" mean " + details::format_duration(e.meanTime_));
+            }
+
+            for (auto j = std::uint32_t {0}; j < e.messageCount_; ++j)
+            {
+                auto const m = log.message(e, j);
+                details::print_message(
+                    console,
+                    "        ",
+                    TestMessage {m.type_, std::string(m.text_)}
+                );
+            }
+        }
+
+        console.println(
+            std::to_string(summary.pass_) + " passed, " +
+            std::to_string(summary.fail_) + " failed, " +
+            std::to_string(summary.partial_) + " partial, " +
+            std::to_string(summary.notEvaluated_) + " skipped"
+        );
+    }
+
+    auto console_print_diff
+        (LogDiff const& diff, ColorMode const c) -> void
+    {
+        auto console = Console(c);
+        if (diff.newlyFailing_.empty()
+         && diff.newlyPassing_.empty()
+         && diff.slower_.empty())
+        {
+            console.println("No differences.");
+            return;
+        }
+
+        if (not diff.newlyFailing_.empty())
+        {
+            console.println("Newly failing:", Color::Red);
+            for (auto const& path : diff.newlyFailing_)
+            {
+                console.print("    ");
+                console.println(path);
+            }
+        }
+
+        if (not diff.newlyPassing_.empty())
+        {
+            console.println("Newly passing:", Color::Green);
+            for (auto const& path : diff.newlyPassing_)
+            {
+                console.print("    ");
+                console.println(path);
+            }
+        }
+
+        if (not diff.slower_.empty())
+        {
+            console.println("Slower:", Color::Yellow);
+            for (auto const& s : diff.slower_)
+            {
+                console.print("    ");
+                console.print(details::format_duration(s.before_), Color::Default, 14);
+                console.print("-> ");
+                console.print(details::format_duration(s.after_), Color::Default, 14);
+                console.println(s.path_);
+            }
+        }
+    }
+}
@@ -0,0 +1,265 @@
+#ifndef ROG_BINARY_LOG_HPP
+#define ROG_BINARY_LOG_HPP
+
+#include <librog/baseline.hpp>
+#include <librog/details/console.hpp>
+#include <librog/details/console_output.hpp>
+#include <librog/details/file_writer.hpp>
+#include <librog/details/serialization.hpp>
+#include <librog/listeners.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rog
+{
+    enum class TestResult;
+    enum class TestMessageType;
+
+    /**
+     *  \brief Writes results into a compact binary log.
+     *
+     *  The log is a sequence of blocks that are only ever appended.
+     *  Names of tests are interned in a name table, each test is stored
+     *  as a fixed-size record that refers to its parent, and texts of its
+     *  messages are stored in a string arena. Measurements compared
+     *  by \c Baseline are stored for the tests that have any. The log can
+     *  be read by \c BinaryLog without re-running the tests. Does not own
+     *  the descriptor.
+     */
+    class BinaryLogWriter : public ITestListener
+    {
+    public:
+        explicit BinaryLogWriter (int fd);
+        ~BinaryLogWriter () override;
+        auto on_run_started (Test const&) -> void override;
+        auto on_run_finished (Test const&) -> void override;
+        auto on_test_finished (LeafTest const&, std::string_view) -> void override;
+        auto on_composite_started
+            (CompositeTest const&, std::string_view) -> void override;
+        auto on_composite_finished
+            (CompositeTest const&, std::string_view) -> void override;
+        auto on_benchmark_finished
+            (BenchmarkTest const&, std::string_view) -> void override;
+
+    private:
+        struct Record
+        {
+            std::uint32_t node_;
+            std::uint32_t parent_;
+            std::uint8_t kind_;
+            TestResult result_;
+            std::chrono::nanoseconds wallTime_;
+            std::chrono::nanoseconds cpuTime_;
+            std::uint64_t passCount_;
+            std::uint64_t failCount_;
+            double meanTime_;
+            std::uint64_t firstMessage_;
+        };
+
+        struct OpenComposite
+        {
+            std::uint32_t node_;
+            std::string path_;
+        };
+
+    private:
+        auto intern (std::string_view name) -> std::uint32_t;
+        auto parent_of (Test const&, std::string_view path) const -> std::uint32_t;
+        auto add_message (TestMessageType, std::string_view) -> void;
+        auto add_measurement (std::uint32_t node, Measurement const&) -> void;
+        auto add_record (Test const&, Record const&) -> void;
+        auto write_blocks () -> void;
+
+    private:
+        std::mutex mutex_;
+        details::FileWriter out_;
+        details::ByteWriter names_;
+        details::ByteWriter arena_;
+        details::ByteWriter messages_;
+        details::ByteWriter measurements_;
+        details::ByteWriter records_;
+        std::unordered_map<std::string, std::uint32_t> nameIds_;
+        std::unordered_map<CompositeTest const*, OpenComposite> composites_;
+        std::unordered_map<Test const*, std::uint32_t> parents_;
+        std::uint64_t arenaSize_;
+        std::uint64_t messageCount_;
+        std::uint32_t nodeCount_;
+    };
+
+    /**
+     *  \brief Kind of a test stored in a binary log.
+     */
+    enum class LogEntryKind
+    {
+        Leaf,
+        Composite,
+        Benchmark
+    };
+
+    /**
+     *  \brief Message of a test stored in a binary log.
+     *  Text points into the mapped log.
+     */
+    struct LogMessage
+    {
+        TestMessageType type_;
+        std::string_view text_;
+    };
+
+    /**
+     *  \brief Test stored in a binary log. Name points into the mapped log.
+     *  For composites, counts are numbers of passed and failed leaves.
+     *  For benchmarks, they are zero and \c meanTime_ holds mean time
+     *  of one iteration.
+     */
+    struct LogEntry
+    {
+        LogEntryKind kind_;
+        TestResult result_;
+        std::string_view name_;
+        std::size_t parent_;
+        std::chrono::nanoseconds wallTime_;
+        std::chrono::nanoseconds cpuTime_;
+        std::uint64_t passCount_;
+        std::uint64_t failCount_;
+        std::chrono::duration<double, std::nano> meanTime_;
+        std::uint64_t firstMessage_;
+        std::uint32_t messageCount_;
+    };
+
+    /**
+     *  \brief Read-only view of a log written by \c BinaryLogWriter .
+     *
+     *  The file is memory mapped where supported, otherwise it is read
+     *  into memory. A log cut short by a crash is read up to its last
+     *  complete block.
+     */
+    class BinaryLog
+    {
+    public:
+        /**
+         *  \brief Value of \c LogEntry::parent_ of top-level entries.
+         */
+        static constexpr auto NoParent = static_cast<std::size_t>(-1);
+
+    public:
+        explicit BinaryLog (std::string const& path);
+        BinaryLog (BinaryLog const&) = delete;
+        ~BinaryLog ();
+
+        /**
+         *  \brief Returns true if the file was opened and is a valid log.
+         */
+        auto is_open () const -> bool;
+
+        /**
+         *  \brief Returns number of entries. Children precede parents.
+         */
+        auto size () const -> std::size_t;
+        auto entry (std::size_t i) const -> LogEntry;
+        auto message (LogEntry const& e, std::uint32_t i) const -> LogMessage;
+
+        /**
+         *  \brief Returns measurements of entry \p i , empty if it has none.
+         */
+        auto measurement (std::size_t i) const -> Measurement;
+
+        /**
+         *  \brief Returns names of all ancestors of entry \p i
+         *  and of the entry itself joined by '/'.
+         */
+        auto path (std::size_t i) const -> std::string;
+
+    private:
+        auto parse () -> bool;
+        auto arena_text (std::uint64_t offset, std::uint32_t size) const
+            -> std::string_view;
+
+    private:
+        struct ArenaBlock
+        {
+            std::uint64_t offset_;
+            std::string_view data_;
+        };
+
+    private:
+        char const* data_;
+        std::size_t size_;
+        std::string contents_;
+        std::vector<std::string_view> names_;
+        std::vector<char const*> records_;
+        std::vector<char const*> messages_;
+        std::unordered_map<std::uint32_t, char const*> measurements_;
+        std::vector<ArenaBlock> arena_;
+        std::vector<std::size_t> nodes_;
+        bool open_;
+    };
+
+    /**
+     *  \brief Test that became slower between two logs.
+     */
+    struct SlowerTest
+    {
+        std::string path_;
+        std::chrono::duration<double, std::nano> before_;
+        std::chrono::duration<double, std::nano> after_;
+    };
+
+    /**
+     *  \brief Differences between two logs. Leaves and benchmarks
+     *  are matched by their paths.
+     */
+    struct LogDiff
+    {
+        std::vector<std::string> newlyFailing_;
+        std::vector<std::string> newlyPassing_;
+        std::vector<SlowerTest> slower_;
+    };
+
+    /**
+     *  \brief Compares results of two runs.
+     *  \param before log of the older run.
+     *  \param after log of the newer run.
+     *  \param factor a test is reported as slower if its time grew
+     *  more than \p factor times ...
+     *  \param minDifference ... and by more than \p minDifference .
+     *  Benchmarks are compared only by the \p factor of their mean time
+     *  per iteration.
+     *  \return Differences between the logs.
+     */
+    auto diff_logs (
+        BinaryLog const& before,
+        BinaryLog const& after,
+        double factor = 2.0,
+        std::chrono::nanoseconds minDifference = std::chrono::milliseconds(1)
+    ) -> LogDiff;
+
+    /**
+     *  \brief Prints results of leaves and benchmarks stored in \p log
+     *  into console.
+     *  \param log log to be printed.
+     *  \param o specifies level of details in the output.
+     *  \param c specifies whether the output is colored.
+     */
+    auto console_print_log (
+        BinaryLog const& log,
+        ConsoleOutputType o = ConsoleOutputType::NoLeaf,
+        ColorMode c = ColorMode::Auto
+    ) -> void;
+
+    /**
+     *  \brief Prints \p diff into console.
+     *  \param diff differences to be printed.
+     *  \param c specifies whether the output is colored.
+     */
+    auto console_print_diff
+        (LogDiff const& diff, ColorMode c = ColorMode::Auto) -> void;
+}
+
+#endif
@@ -0,0 +1,371 @@
+#include <librog/details/allocation.hpp>
+#include <librog/rog.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef ROG_TRACK_ALLOCATIONS
+#if defined(__linux__)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(_WIN32) || defined(_WIN64)
+#include <malloc.h>
+#endif
+#endif
+
+namespace rog::details
+{
+    namespace
+    {
+        /**
+         *  \brief Counters of a thread. They are plain data, so that
+         *  the hooks can use them at any point of life of the thread.
+         */
+        struct ThreadCounters
+        {
+            std::uint64_t allocations_;
+            std::uint64_t deallocations_;
+            std::uint64_t bytes_;
+            std::int64_t live_;
+            std::int64_t peak_;
+            bool paused_;
+        };
+
+        constinit thread_local auto counters = ThreadCounters {};
+    }
+
+// AllocationScope:
+
+    AllocationScope::AllocationScope
+        () :
+        allocations_   (counters.allocations_),
+        deallocations_ (counters.deallocations_),
+        bytes_         (counters.bytes_),
+        live_          (counters.live_),
+        outerPeak_     (counters.peak_),
+        stopped_       (false)
+    {
+        counters.peak_ = counters.live_;
+    }
+
+    AllocationScope::~AllocationScope
+        ()
+    {
+        if (not stopped_)
+        {
+            this->stop();
+        }
+    }
+
+    auto AllocationScope::stop
+        () -> AllocationStats
+    {
+        auto const allocations = counters.allocations_ - allocations_;
+        auto const deallocations = counters.deallocations_ - deallocations_;
+        auto const stats = AllocationStats {
+            allocations,
+            counters.bytes_ - bytes_,
+            static_cast<std::uint64_t>(counters.peak_ - live_),
+            static_cast<std::int64_t>(allocations - deallocations),
+            counters.live_ - live_
+        };
+
+        // The outer scope sees the peak of this one.
+        counters.peak_ = std::max(counters.peak_, outerPeak_);
+        stopped_ = true;
+        return stats;
+    }
+
+// AllocationPause:
+
+    AllocationPause::AllocationPause
+        () :
+        paused_ (counters.paused_)
+    {
+        counters.paused_ = true;
+    }
+
+    AllocationPause::~AllocationPause
+        ()
+    {
+        counters.paused_ = paused_;
+    }
+
+#ifdef ROG_TRACK_ALLOCATIONS
+
+// Hooks:
+
+    namespace
+    {
+        /**
+         *  \brief Returns size of the block at \p p as reported
+         *  by the allocator, it is at least the requested size.
+         */
+        auto usable_size (void* const p) -> std::size_t
+        {
+            #if defined(__linux__)
+            return ::malloc_usable_size(p);
+            #elif defined(__APPLE__)
+            return ::malloc_size(p);
+            #elif defined(_WIN32) || defined(_WIN64)
+            return ::_msize(p);
+            #endif
+        }
+
+        auto record_allocation (std::size_t const size) -> void
+        {
+            if (counters.paused_)
+            {
+                return;
+            }
+
+            ++counters.allocations_;
+            counters.bytes_ += size;
+            counters.live_ += static_cast<std::int64_t>(size);
+            counters.peak_ = std::max(counters.peak_, counters.live_);
+        }
+
+        auto record_deallocation (std::size_t const size) -> void
+        {
+            if (counters.paused_)
+            {
+                return;
+            }
+
+            ++counters.deallocations_;
+            counters.live_ -= static_cast<std::int64_t>(size);
+        }
+
+        /**
+         *  \brief Allocates \p size bytes, calls the new handler until
+         *  it succeeds as the default \c operator \c new .
+         */
+        auto allocate (std::size_t const size) -> void*
+        {
+            for (;;)
+            {
+                if (auto* const p = std::malloc(std::max(size, std::size_t {1})))
+                {
+                    record_allocation(usable_size(p));
+                    return p;
+                }
+
+                auto const handler = std::get_new_handler();
+                if (not handler)
+                {
+                    throw std::bad_alloc();
+                }
+                handler();
+            }
+        }
+
+        auto allocate_aligned
+            (std::size_t const size, std::align_val_t const alignment) -> void*
+        {
+            auto const align = std::max(
+                static_cast<std::size_t>(alignment),
+                sizeof(void*)
+            );
+            for (;;)
+            {
+                #if defined(_WIN32) || defined(_WIN64)
+                auto* const p = ::_aligned_malloc(std::max(size, std::size_t {1}), align);
+                if (p)
+                {
+                    record_allocation(::_aligned_msize(p, align, 0));
+                    return p;
+                }
+                #else
+                auto* p = static_cast<void*>(nullptr);
+                if (::posix_memalign(&p, align, std::max(size, std::size_t {1})) == 0)
+                {
+                    record_allocation(usable_size(p));
+                    return p;
+                }
+                #endif
+
+                auto const handler = std::get_new_handler();
+                if (not handler)
+                {
+                    throw std::bad_alloc();
+                }
+                handler();
+            }
+        }
+
+        auto deallocate (void* const p) -> void
+        {
+            if (p)
+            {
+                record_deallocation(usable_size(p));
+                std::free(p);
+            }
+        }
+
+        auto deallocate_aligned
+            (void* const p, [[maybe_unused]] std::align_val_t const alignment) -> void
+        {
+            if (not p)
+            {
+                return;
+            }
+
+            #if defined(_WIN32) || defined(_WIN64)
+            auto const align = std::max(
+                static_cast<std::size_t>(alignment),
+                sizeof(void*)
+            );
+            record_deallocation(::_aligned_msize(p, align, 0));
+            ::_aligned_free(p);
+            #else
+            record_deallocation(usable_size(p));
+            std::free(p);
+            #endif
+        }
+    }
+
+#endif
+}
+
+#ifdef ROG_TRACK_ALLOCATIONS
+
+auto operator new (std::size_t const size) -> void*
+{
+    return rog::details::allocate(size);
+}
+
+auto operator new[] (std::size_t const size) -> void*
+{
+    return rog::details::allocate(size);
+}
+
+auto operator new (std::size_t const size, std::nothrow_t const&) noexcept -> void*
+{
+    try
+    {
+        return rog::details::allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+auto operator new[] (std::size_t const size, std::nothrow_t const&) noexcept -> void*
+{
+    try
+    {
+        return rog::details::allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+auto operator new (std::size_t const size, std::align_val_t const alignment) -> void*
+{
+    return rog::details::allocate_aligned(size, alignment);
+}
+
+auto operator new[] (std::size_t const size, std::align_val_t const alignment) -> void*
+{
+    return rog::details::allocate_aligned(size, alignment);
+}
+
+auto operator new
+    (std::size_t const size, std::align_val_t const alignment, std::nothrow_t const&) noexcept
+    -> void*
+{
+    try
+    {
+        return rog::details::allocate_aligned(size, alignment);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+auto operator new[]
+    (std::size_t const size, std::align_val_t const alignment, std::nothrow_t const&) noexcept
+    -> void*
+{
+    try
+    {
+        return rog::details::allocate_aligned(size, alignment);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+auto operator delete (void* const p) noexcept -> void
+{
+    rog::details::deallocate(p);
+}
+
+auto operator delete[] (void* const p) noexcept -> void
+{
+    rog::details::deallocate(p);
+}
+
+auto operator delete (void* const p, std::size_t) noexcept -> void
+{
+    rog::details::deallocate(p);
+}
+
+auto operator delete[] (void* const p, std::size_t) noexcept -> void
+{
+    rog::details::deallocate(p);
+}
+
+auto operator delete (void* const p, std::nothrow_t const&) noexcept -> void
+{
+    rog::details::deallocate(p);
+}
+
+auto operator delete[] (void* const p, std::nothrow_t const&) noexcept -> void
+{
+    rog::details::deallocate(p);
+}
+
+auto operator delete (void* const p, std::align_val_t const alignment) noexcept -> void
+{
+    rog::details::deallocate_aligned(p, alignment);
+}
+
+auto operator delete[] (void* const p, std::align_val_t const alignment) noexcept -> void
+{
+    rog::details::deallocate_aligned(p, alignment);
+}
+
+auto operator delete
+    (void* const p, std::size_t, std::align_val_t const alignment) noexcept -> void
+{
+    rog::details::deallocate_aligned(p, alignment);
+}
+
+auto operator delete[]
+    (void* const p, std::size_t, std::align_val_t const alignment) noexcept -> void
+{
+    rog::details::deallocate_aligned(p, alignment);
+}
+
+auto operator delete
+    (void* const p, std::align_val_t const alignment, std::nothrow_t const&) noexcept -> void
+{
+    rog::details::deallocate_aligned(p, alignment);
+}
+
+auto operator delete[]
+    (void* const p, std::align_val_t const alignment, std::nothrow_t const&) noexcept -> void
+{
+    rog::details::deallocate_aligned(p, alignment);
+}
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef ROG_DETAILS_ALLOCATION_HPP
+#define ROG_DETAILS_ALLOCATION_HPP
+
+#include <cstdint>
+
+namespace rog
+{
+    struct AllocationStats;
+}
+
+namespace rog::details
+{
+    /**
+     *  \brief True if the library replaces global \c operator \c new
+     *  and \c operator \c delete to count allocations, see the CMake
+     *  option \c ROG_TRACK_ALLOCATIONS .
+     */
+    #ifdef ROG_TRACK_ALLOCATIONS
+    inline constexpr auto TrackAllocations = true;
+    #else
+    inline constexpr auto TrackAllocations = false;
+    #endif
+
+    /**
+     *  \brief Counts allocations of the calling thread from construction
+     *  until \c stop . Scopes nest, allocations of an inner scope count
+     *  towards the outer ones too. Allocations of other threads are not
+     *  counted. Without \c TrackAllocations all counts are zero.
+     */
+    class AllocationScope
+    {
+    public:
+        AllocationScope ();
+        AllocationScope (AllocationScope const&) = delete;
+        AllocationScope (AllocationScope&&) = delete;
+
+        /**
+         *  \brief Stops the scope if it was not stopped.
+         */
+        ~AllocationScope ();
+
+        /**
+         *  \brief Stops counting.
+         *  \return Allocations made since construction.
+         */
+        auto stop () -> AllocationStats;
+
+    private:
+        std::uint64_t allocations_;
+        std::uint64_t deallocations_;
+        std::uint64_t bytes_;
+        std::int64_t live_;
+        std::int64_t outerPeak_;
+        bool stopped_;
+    };
+
+    /**
+     *  \brief Excludes allocations and deallocations of the calling thread
+     *  from counting while it exists. Used for bookkeeping of the library,
+     *  e.g. messages of assertions.
+     */
+    class AllocationPause
+    {
+    public:
+        AllocationPause ();
+        AllocationPause (AllocationPause const&) = delete;
+        ~AllocationPause ();
+
+    private:
+        bool paused_;
+    };
+}
+
+#endif
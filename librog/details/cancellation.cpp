@@ -0,0 +1,40 @@
+#include <librog/details/cancellation.hpp>
+
+namespace rog::details
+{
+    CancellationToken::CancellationToken
+        (std::size_t const maxFailures) :
+        maxFailures_ (maxFailures),
+        failures_    (0),
+        cancelled_   (false)
+    {
+    }
+
+    auto CancellationToken::add_failure
+        () -> void
+    {
+        auto const failures = failures_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (maxFailures_ > 0 && failures >= maxFailures_)
+        {
+            this->cancel();
+        }
+    }
+
+    auto CancellationToken::cancel
+        () -> void
+    {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    auto CancellationToken::is_cancelled
+        () const -> bool
+    {
+        return cancelled_.load(std::memory_order_relaxed);
+    }
+
+    auto CancellationToken::flag
+        () const -> std::atomic<bool> const&
+    {
+        return cancelled_;
+    }
+}
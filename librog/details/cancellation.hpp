@@ -0,0 +1,48 @@
+#ifndef ROG_DETAILS_CANCELLATION_HPP
+#define ROG_DETAILS_CANCELLATION_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace rog::details
+{
+    /**
+     *  \brief Cancels a run after a number of leaves failed.
+     *
+     *  Composites check the token before they start a subtest, running
+     *  leaves check it at each assertion. Tests that are not started
+     *  are left not evaluated.
+     */
+    class CancellationToken
+    {
+    public:
+        /**
+         *  \param maxFailures number of failed leaves that cancel the run.
+         *  Zero means that the run is never cancelled by failures.
+         */
+        explicit CancellationToken (std::size_t maxFailures);
+
+        CancellationToken (CancellationToken const&) = delete;
+
+        /**
+         *  \brief Counts a failed leaf.
+         */
+        auto add_failure () -> void;
+
+        auto cancel () -> void;
+        auto is_cancelled () const -> bool;
+
+        /**
+         *  \brief Returns the flag that is set once the run is cancelled.
+         *  Leaves keep a pointer to it.
+         */
+        auto flag () const -> std::atomic<bool> const&;
+
+    private:
+        std::size_t maxFailures_;
+        std::atomic<std::size_t> failures_;
+        std::atomic<bool> cancelled_;
+    };
+}
+
+#endif
@@ -0,0 +1,511 @@
+#include <librog/details/compare.hpp>
+#include <librog/rog.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define ROG_SSE2 1
+#endif
+
+namespace rog::details
+{
+    namespace
+    {
+        auto element_differs
+            ( std::byte const* const e
+            , std::byte const* const a
+            , std::size_t const      index
+            , std::size_t const      size ) -> bool
+        {
+            return std::memcmp(e + index * size, a + index * size, size) != 0;
+        }
+
+#ifdef ROG_SSE2
+        /**
+         *  \brief Returns mask of bytes of the 16 byte blocks that differ.
+         */
+        auto differing_bytes
+            (std::byte const* const e, std::byte const* const a) -> unsigned int
+        {
+            auto const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(e));
+            auto const y = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a));
+            auto const equal = static_cast<unsigned int>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(x, y))
+            );
+            return ~equal & 0xFFFFu;
+        }
+
+        /**
+         *  \brief Returns offset of the first differing byte of a block
+         *  that differs.
+         */
+        auto first_difference_in
+            ( std::byte const* const e
+            , std::byte const* const a
+            , std::size_t const      size ) -> std::size_t
+        {
+            auto i = std::size_t {0};
+            for (; i + 16 <= size; i += 16)
+            {
+                auto const mask = differing_bytes(e + i, a + i);
+                if (mask != 0)
+                {
+                    return i + static_cast<std::size_t>(std::countr_zero(mask));
+                }
+            }
+
+            for (; i < size; ++i)
+            {
+                if (e[i] != a[i])
+                {
+                    return i;
+                }
+            }
+            return size;
+        }
+#else
+        auto first_difference_in
+            ( std::byte const* const e
+            , std::byte const* const a
+            , std::size_t const      size ) -> std::size_t
+        {
+            auto i = std::size_t {0};
+            while (i < size && e[i] == a[i])
+            {
+                ++i;
+            }
+            return i;
+        }
+#endif
+
+        /**
+         *  \brief Returns offset of the first differing byte. Equal blocks
+         *  are skipped by \c memcmp , which the C library implements with
+         *  the widest vectors of the machine.
+         */
+        auto first_difference
+            ( std::byte const* const e
+            , std::byte const* const a
+            , std::size_t const      size ) -> std::size_t
+        {
+            constexpr auto BlockSize = std::size_t {4096};
+            for (auto i = std::size_t {0}; i < size; i += BlockSize)
+            {
+                auto const n = std::min(BlockSize, size - i);
+                if (std::memcmp(e + i, a + i, n) != 0)
+                {
+                    return i + first_difference_in(e + i, a + i, n);
+                }
+            }
+            return size;
+        }
+
+#ifdef ROG_SSE2
+        /**
+         *  \brief Counts differing elements from \p begin , whose size
+         *  is a power of two that divides 16.
+         */
+        auto count_differences
+            ( std::byte const* const e
+            , std::byte const* const a
+            , std::size_t const      begin
+            , std::size_t const      count
+            , std::size_t const      size ) -> std::size_t
+        {
+            // Bits of the bytes that start an element.
+            auto const starts =
+                size == 1 ? 0xFFFFu :
+                size == 2 ? 0x5555u :
+                size == 4 ? 0x1111u :
+                size == 8 ? 0x0101u :
+                            0x0001u;
+
+            constexpr auto BlockSize = std::size_t {4096};
+            auto differing = std::size_t {0};
+            auto const bytes = count * size;
+            auto i = begin * size;
+            for (; i + 16 <= bytes; i += 16)
+            {
+                if (i % BlockSize == 0 && i + BlockSize <= bytes
+                 && std::memcmp(e + i, a + i, BlockSize) == 0)
+                {
+                    i += BlockSize - 16;
+                    continue;
+                }
+
+                // Moves differences of the bytes of an element to its start.
+                auto mask = differing_bytes(e + i, a + i);
+                for (auto shift = 1u; shift < size; shift *= 2)
+                {
+                    mask |= mask >> shift;
+                }
+                differing += static_cast<std::size_t>(std::popcount(mask & starts));
+            }
+
+            for (auto index = i / size; index < count; ++index)
+            {
+                differing += element_differs(e, a, index, size);
+            }
+            return differing;
+        }
+#endif
+    }
+
+    auto compare_bytes
+        ( void const* const expected
+        , void const* const actual
+        , std::size_t const count
+        , std::size_t const elementSize ) -> std::optional<RangeDifference>
+    {
+        auto const* const e = static_cast<std::byte const*>(expected);
+        auto const* const a = static_cast<std::byte const*>(actual);
+        auto const bytes = count * elementSize;
+        auto const firstByte = first_difference(e, a, bytes);
+        if (firstByte == bytes)
+        {
+            return std::nullopt;
+        }
+
+        auto const first = firstByte / elementSize;
+        auto difference = RangeDifference {first, 0};
+
+        #ifdef ROG_SSE2
+        if (std::has_single_bit(elementSize) && elementSize <= 16)
+        {
+            difference.count_ = count_differences(e, a, first, count, elementSize);
+            return difference;
+        }
+        #endif
+
+        for (auto i = first; i < count; ++i)
+        {
+            difference.count_ += element_differs(e, a, i, elementSize);
+        }
+        return difference;
+    }
+
+// Floating-point ranges:
+
+    namespace
+    {
+        template<class T>
+        struct FloatBits;
+
+        template<>
+        struct FloatBits<float>
+        {
+            using int_t = std::int32_t;
+            using uint_t = std::uint32_t;
+            static constexpr auto Mantissa = 23;
+        };
+
+        template<>
+        struct FloatBits<double>
+        {
+            using int_t = std::int64_t;
+            using uint_t = std::uint64_t;
+            static constexpr auto Mantissa = 52;
+        };
+
+        /**
+         *  \brief Returns number of representable values between finite
+         *  \p e and \p a .
+         */
+        template<std::floating_point T>
+        auto ulp_distance (T const e, T const a) -> std::uint64_t
+        {
+            using I = typename FloatBits<T>::int_t;
+            using U = typename FloatBits<T>::uint_t;
+
+            // Maps sign-magnitude bits to integers ordered as the values.
+            auto const ordered = [](T const x)
+            {
+                auto const bits = std::bit_cast<I>(x);
+                return bits < 0
+                    ? static_cast<I>(std::numeric_limits<I>::min() - bits)
+                    : bits;
+            };
+            auto const x = ordered(e);
+            auto const y = ordered(a);
+            return x >= y
+                ? std::uint64_t {static_cast<U>(static_cast<U>(x) - static_cast<U>(y))}
+                : std::uint64_t {static_cast<U>(static_cast<U>(y) - static_cast<U>(x))};
+        }
+
+        template<std::floating_point T>
+        auto is_within (T const e, T const a, FloatTolerance const& t) -> bool
+        {
+            if (e == a)
+            {
+                return true;
+            }
+
+            if (std::isnan(e) || std::isnan(a))
+            {
+                return t.nanEqual_ && std::isnan(e) && std::isnan(a);
+            }
+
+            if (std::isinf(e) || std::isinf(a))
+            {
+                return false;
+            }
+
+            auto const d = std::abs(e - a);
+            return d <= static_cast<T>(t.absolute_)
+                || d <= static_cast<T>(t.relative_) * std::max(std::abs(e), std::abs(a))
+                || (t.ulps_ > 0 && ulp_distance(e, a) <= t.ulps_);
+        }
+
+        /**
+         *  \brief Checks elements of [begin, end) one by one.
+         */
+        template<std::floating_point T>
+        auto check_each
+            ( T const* const         e
+            , T const* const         a
+            , std::size_t const      begin
+            , std::size_t const      end
+            , FloatTolerance const&  t
+            , FloatDifference&       difference ) -> void
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                if (not is_within(e[i], a[i], t) && difference.count_++ == 0)
+                {
+                    difference.first_ = i;
+                }
+
+                auto const error = static_cast<double>(std::abs(e[i] - a[i]));
+                if (error > difference.maxError_)
+                {
+                    difference.maxError_ = error;
+                    difference.maxErrorIndex_ = i;
+                }
+            }
+        }
+
+#ifdef ROG_SSE2
+        struct SseFloats
+        {
+            using value_t = float;
+            using vec_t = __m128;
+            static constexpr auto Lanes = std::size_t {4};
+            static constexpr auto AllLanes = 0xF;
+
+            static auto load (float const* p) { return _mm_loadu_ps(p); }
+            static auto store (float* p, vec_t x) { _mm_storeu_ps(p, x); }
+            static auto set1 (float x) { return _mm_set1_ps(x); }
+            static auto sub (vec_t x, vec_t y) { return _mm_sub_ps(x, y); }
+            static auto mul (vec_t x, vec_t y) { return _mm_mul_ps(x, y); }
+            static auto max (vec_t x, vec_t y) { return _mm_max_ps(x, y); }
+            static auto min (vec_t x, vec_t y) { return _mm_min_ps(x, y); }
+            static auto and_ (vec_t x, vec_t y) { return _mm_and_ps(x, y); }
+            static auto or_ (vec_t x, vec_t y) { return _mm_or_ps(x, y); }
+            static auto eq (vec_t x, vec_t y) { return _mm_cmpeq_ps(x, y); }
+            static auto le (vec_t x, vec_t y) { return _mm_cmple_ps(x, y); }
+            static auto lt (vec_t x, vec_t y) { return _mm_cmplt_ps(x, y); }
+            static auto mask (vec_t x) { return _mm_movemask_ps(x); }
+            static auto abs (vec_t x) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+            static auto exponent (vec_t x)
+            {
+                return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7F800000)));
+            }
+        };
+
+        struct SseDoubles
+        {
+            using value_t = double;
+            using vec_t = __m128d;
+            static constexpr auto Lanes = std::size_t {2};
+            static constexpr auto AllLanes = 0x3;
+
+            static auto load (double const* p) { return _mm_loadu_pd(p); }
+            static auto store (double* p, vec_t x) { _mm_storeu_pd(p, x); }
+            static auto set1 (double x) { return _mm_set1_pd(x); }
+            static auto sub (vec_t x, vec_t y) { return _mm_sub_pd(x, y); }
+            static auto mul (vec_t x, vec_t y) { return _mm_mul_pd(x, y); }
+            static auto max (vec_t x, vec_t y) { return _mm_max_pd(x, y); }
+            static auto min (vec_t x, vec_t y) { return _mm_min_pd(x, y); }
+            static auto and_ (vec_t x, vec_t y) { return _mm_and_pd(x, y); }
+            static auto or_ (vec_t x, vec_t y) { return _mm_or_pd(x, y); }
+            static auto eq (vec_t x, vec_t y) { return _mm_cmpeq_pd(x, y); }
+            static auto le (vec_t x, vec_t y) { return _mm_cmple_pd(x, y); }
+            static auto lt (vec_t x, vec_t y) { return _mm_cmplt_pd(x, y); }
+            static auto mask (vec_t x) { return _mm_movemask_pd(x); }
+            static auto abs (vec_t x) { return _mm_andnot_pd(_mm_set1_pd(-0.0), x); }
+            static auto exponent (vec_t x)
+            {
+                return _mm_and_pd(
+                    x,
+                    _mm_castsi128_pd(_mm_set1_epi64x(0x7FF0000000000000))
+                );
+            }
+        };
+
+        /**
+         *  \brief Checks blocks of elements with SIMD. A lane passes
+         *  if a condition that implies \c is_within holds, blocks with
+         *  a lane that does not pass or with NaNs are checked again
+         *  by \c check_each .
+         *
+         *  The ULP tolerance is checked as a difference of at most ulps
+         *  spacings of the smaller magnitude. Spacing of the values between
+         *  the two is not smaller, so they are at most ulps apart. Tolerances
+         *  of 2^mantissa ULPs and more are left to \c check_each , they
+         *  would let values of opposite signs pass.
+         */
+        template<class S>
+        auto compare_blocks
+            ( typename S::value_t const* const e
+            , typename S::value_t const* const a
+            , std::size_t const                count
+            , FloatTolerance const&            t ) -> FloatDifference
+        {
+            using T = typename S::value_t;
+            constexpr auto BlockSize = std::size_t {256};
+            constexpr auto UlpLimit = std::uint64_t {1} << FloatBits<T>::Mantissa;
+
+            auto const absolute = S::set1(static_cast<T>(t.absolute_));
+            auto const relative = S::set1(static_cast<T>(t.relative_));
+            auto const ulps = S::set1(t.ulps_ < UlpLimit ? static_cast<T>(t.ulps_) : T {0});
+            auto const epsilon = S::set1(std::numeric_limits<T>::epsilon());
+            auto const infinity = S::set1(std::numeric_limits<T>::infinity());
+
+            auto difference = FloatDifference();
+            for (auto begin = std::size_t {0}; begin < count; begin += BlockSize)
+            {
+                auto const end = std::min(begin + BlockSize, count);
+                if (end - begin < BlockSize)
+                {
+                    check_each(e, a, begin, end, t, difference);
+                    continue;
+                }
+
+                auto passed = S::eq(S::set1(T {0}), S::set1(T {0}));
+                auto maxError = S::set1(T {0});
+                for (auto i = begin; i < end; i += S::Lanes)
+                {
+                    auto const x = S::load(e + i);
+                    auto const y = S::load(a + i);
+                    auto const ax = S::abs(x);
+                    auto const ay = S::abs(y);
+                    auto const error = S::abs(S::sub(x, y));
+                    auto const spacing = S::mul(S::exponent(S::min(ax, ay)), epsilon);
+                    auto const bound = S::max(
+                        S::max(absolute, S::mul(relative, S::max(ax, ay))),
+                        S::mul(ulps, spacing)
+                    );
+                    auto const within = S::or_(
+                        S::eq(x, y),
+                        S::and_(S::le(error, bound), S::lt(error, infinity))
+                    );
+                    passed = S::and_(passed, within);
+
+                    // Operands in this order skip NaNs.
+                    maxError = S::max(error, maxError);
+                }
+
+                if (S::mask(passed) != S::AllLanes)
+                {
+                    check_each(e, a, begin, end, t, difference);
+                    continue;
+                }
+
+                T lanes[S::Lanes];
+                S::store(lanes, maxError);
+                auto const blockMax = static_cast<double>(*std::max_element(lanes, lanes + S::Lanes));
+                if (blockMax > difference.maxError_)
+                {
+                    auto i = begin;
+                    while (static_cast<double>(std::abs(e[i] - a[i])) != blockMax)
+                    {
+                        ++i;
+                    }
+                    difference.maxError_ = blockMax;
+                    difference.maxErrorIndex_ = i;
+                }
+            }
+            return difference;
+        }
+#endif
+    }
+
+    auto compare_floats
+        ( float const* const    expected
+        , float const* const    actual
+        , std::size_t const     count
+        , FloatTolerance const& tolerance ) -> FloatDifference
+    {
+        #ifdef ROG_SSE2
+        return compare_blocks<SseFloats>(expected, actual, count, tolerance);
+        #else
+        auto difference = FloatDifference();
+        check_each(expected, actual, 0, count, tolerance, difference);
+        return difference;
+        #endif
+    }
+
+    auto compare_floats
+        ( double const* const   expected
+        , double const* const   actual
+        , std::size_t const     count
+        , FloatTolerance const& tolerance ) -> FloatDifference
+    {
+        #ifdef ROG_SSE2
+        return compare_blocks<SseDoubles>(expected, actual, count, tolerance);
+        #else
+        auto difference = FloatDifference();
+        check_each(expected, actual, 0, count, tolerance, difference);
+        return difference;
+        #endif
+    }
+
+    auto range_difference_message
+        ( RangeDifference const&          difference
+        , std::size_t const               expectedSize
+        , std::size_t const               actualSize
+        , std::string const&              unit
+        , std::size_t const               windowBegin
+        , std::vector<std::string> const& expected
+        , std::vector<std::string> const& actual ) -> std::string
+    {
+        auto const print_window = [&]
+            (std::vector<std::string> const& values, std::size_t const size)
+        {
+            auto out = std::string(windowBegin > 0 ? "... " : "");
+            for (auto i = std::size_t {0}; i < values.size(); ++i)
+            {
+                auto const differs = windowBegin + i == difference.first_;
+                out += i > 0 ? " " : "";
+                out += differs ? "[" + values[i] + "]" : values[i];
+            }
+            if (windowBegin + values.size() < size)
+            {
+                out += " ...";
+            }
+            else if (windowBegin + values.size() <= difference.first_)
+            {
+                out += values.empty() ? "[end]" : " [end]";
+            }
+            return out;
+        };
+
+        auto message = "First difference at index " + std::to_string(difference.first_)
+                     + ", " + std::to_string(difference.count_) + " " + unit
+                     + " differ";
+        if (expectedSize != actualSize)
+        {
+            message += ", expected size " + std::to_string(expectedSize)
+                     + " got " + std::to_string(actualSize);
+        }
+        message += ". Expected " + print_window(expected, expectedSize)
+                 + " got " + print_window(actual, actualSize);
+        return message;
+    }
+}
@@ -0,0 +1,141 @@
+#ifndef ROG_DETAILS_COMPARE_HPP
+#define ROG_DETAILS_COMPARE_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rog
+{
+    struct FloatTolerance;
+}
+
+namespace rog::details
+{
+    /**
+     *  \brief Where two ranges differ.
+     */
+    struct RangeDifference
+    {
+        /**
+         *  \brief Index of the first differing element.
+         */
+        std::size_t first_;
+
+        /**
+         *  \brief Number of differing elements, elements of the longer
+         *  range that the shorter one does not have are counted too.
+         */
+        std::size_t count_;
+    };
+
+    /**
+     *  \brief Number of elements printed on each side of the first
+     *  difference.
+     */
+    inline constexpr auto DifferenceContext = std::size_t {8};
+
+    /**
+     *  \brief Compares \p count elements of \p elementSize bytes
+     *  by their bytes. Uses SSE2 where it is available.
+     *  \return Difference, or nothing if the elements are equal.
+     */
+    auto compare_bytes (
+        void const* expected,
+        void const* actual,
+        std::size_t count,
+        std::size_t elementSize
+    ) -> std::optional<RangeDifference>;
+
+    /**
+     *  \brief Compares \p count elements using \c == .
+     *  \return Difference, or nothing if the elements are equal.
+     */
+    template<class T, class U>
+    auto compare_elements (T const* expected, U const* actual, std::size_t count)
+        -> std::optional<RangeDifference>
+    {
+        auto i = std::size_t {0};
+        while (i < count && expected[i] == actual[i])
+        {
+            ++i;
+        }
+
+        if (i == count)
+        {
+            return std::nullopt;
+        }
+
+        auto difference = RangeDifference {i, 0};
+        for (; i < count; ++i)
+        {
+            difference.count_ += not (expected[i] == actual[i]);
+        }
+        return difference;
+    }
+
+    /**
+     *  \brief Summary of a comparison of floating-point ranges.
+     */
+    struct FloatDifference
+    {
+        /**
+         *  \brief Number of elements out of tolerance.
+         */
+        std::size_t count_ {0};
+
+        /**
+         *  \brief Index of the first element out of tolerance.
+         */
+        std::size_t first_ {0};
+
+        /**
+         *  \brief Largest absolute error, NaNs are not counted.
+         */
+        double maxError_ {0};
+        std::size_t maxErrorIndex_ {0};
+    };
+
+    /**
+     *  \brief Compares \p count elements with \p tolerance .
+     *  Uses SSE2 where it is available.
+     */
+    auto compare_floats (
+        float const* expected,
+        float const* actual,
+        std::size_t count,
+        FloatTolerance const& tolerance
+    ) -> FloatDifference;
+
+    auto compare_floats (
+        double const* expected,
+        double const* actual,
+        std::size_t count,
+        FloatTolerance const& tolerance
+    ) -> FloatDifference;
+
+    /**
+     *  \brief Returns message of two ranges that differ.
+     *  \param difference where the ranges differ.
+     *  \param expectedSize size of the expected range.
+     *  \param actualSize size of the actual range.
+     *  \param unit name of the elements, e.g. "elements".
+     *  \param windowBegin index of the first printed element.
+     *  \param expected printed elements of the expected range from
+     *  \p windowBegin .
+     *  \param actual printed elements of the actual range from
+     *  \p windowBegin .
+     */
+    auto range_difference_message (
+        RangeDifference const& difference,
+        std::size_t expectedSize,
+        std::size_t actualSize,
+        std::string const& unit,
+        std::size_t windowBegin,
+        std::vector<std::string> const& expected,
+        std::vector<std::string> const& actual
+    ) -> std::string;
+}
+
+#endif
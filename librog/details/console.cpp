@@ -1,17 +1,76 @@
 #include <librog/details/console.hpp>
 
+#include <cstdio>
 #include <iostream>
-#include <iomanip>
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
+#include <io.h>
+#endif
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <cerrno>
+#include <unistd.h>
 #endif
 
 namespace rog
 {
+    namespace
+    {
+        // Buffer is written out once it grows past this size.
+        constexpr auto FlushThreshold = std::size_t {1 << 16};
+
+        auto stdout_is_terminal () -> bool
+        {
+#if defined(_WIN32) || defined(_WIN64)
+            return _isatty(_fileno(stdout));
+#elif defined(__APPLE__) || defined(__linux__)
+            return ::isatty(STDOUT_FILENO);
+#else
+            return false;
+#endif
+        }
+
+        auto write_stdout (std::string_view const str) -> void
+        {
+#if defined(__APPLE__) || defined(__linux__)
+            auto done = std::size_t {0};
+            while (done < str.size())
+            {
+                auto const n = ::write(
+                    STDOUT_FILENO,
+                    str.data() + done,
+                    str.size() - done
+                );
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return;
+                }
+                done += static_cast<std::size_t>(n);
+            }
+#else
+            std::fwrite(str.data(), 1, str.size(), stdout);
+            std::fflush(stdout);
+#endif
+        }
+    }
+
+    Console::~Console ()
+    {
+        this->flush();
+    }
+
     auto Console::print (std::string_view const str) -> void
     {
-        std::cout << str;
+        buffer_ += str;
+        if (buffer_.size() >= FlushThreshold)
+        {
+            this->flush();
+        }
     }
 
     auto Console::print ( std::string_view const str
@@ -36,20 +95,19 @@ namespace rog
         if (color != Color::Default)
         {
             this->set_color(color);
-            this->set_next_token_width(width);
-            this->print(str);
+            this->print_padded(str, width);
             this->reset_color();
         }
         else
         {
-            this->set_next_token_width(width);
-            this->print(str);
+            this->print_padded(str, width);
         }
     }
 
     auto Console::println (std::string_view const str) -> void
     {
-        std::cout << str << '\n';
+        buffer_ += str;
+        this->print("\n");
     }
 
     auto Console::println ( std::string_view const str
@@ -74,20 +132,39 @@ namespace rog
         if (color != Color::Default)
         {
             this->set_color(color);
-            this->set_next_token_width(width);
-            this->println(str);
+            this->print_padded(str, width);
+            this->println("");
             this->reset_color();
         }
         else
         {
-            this->set_next_token_width(width);
-            this->println(str);
+            this->print_padded(str, width);
+            this->println("");
+        }
+    }
+
+    auto Console::flush () -> void
+    {
+        if (buffer_.empty())
+        {
+            return;
         }
+
+        // Keeps the order with anything written through std::cout.
+        std::cout.flush();
+        write_stdout(buffer_);
+        buffer_.clear();
     }
 
-    auto Console::set_next_token_width (int const w) -> void
+    auto Console::print_padded ( std::string_view const str
+                               , int const              width ) -> void
     {
-        std::cout << std::left << std::setw(w);
+        buffer_ += str;
+        if (width > 0 && str.size() < static_cast<std::size_t>(width))
+        {
+            buffer_.append(static_cast<std::size_t>(width) - str.size(), ' ');
+        }
+        this->print("");
     }
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -122,7 +199,9 @@ namespace rog
         }
     }
 
-    Console::Console ()
+    Console::Console (ColorMode const mode) :
+        colors_ (mode == ColorMode::Always
+             || (mode == ColorMode::Auto && stdout_is_terminal()))
     {
         HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
         CONSOLE_SCREEN_BUFFER_INFO csbiInfo;
@@ -130,14 +209,31 @@ namespace rog
         defaultColor_ = csbiInfo.wAttributes;
     }
 
+    // Console attributes apply to what is written after they are set.
     auto Console::set_color (Color const color) -> void
     {
-        windows_set_color(convert(color));
+        if (colors_)
+        {
+            this->flush();
+            windows_set_color(convert(color));
+        }
     }
 
     auto Console::reset_color () -> void
     {
-        windows_set_color(defaultColor_);
+        if (colors_)
+        {
+            this->flush();
+            windows_set_color(defaultColor_);
+        }
+    }
+
+#else
+
+    Console::Console (ColorMode const mode) :
+        colors_ (mode == ColorMode::Always
+             || (mode == ColorMode::Auto && stdout_is_terminal()))
+    {
     }
 
 #endif
@@ -170,12 +266,18 @@ namespace rog
 
     auto Console::set_color (Color const color) -> void
     {
-        std::cout << convert(color);
+        if (colors_)
+        {
+            buffer_ += convert(color);
+        }
     }
 
     auto Console::reset_color () -> void
     {
-        std::cout << "\x1B[0m";
+        if (colors_)
+        {
+            buffer_ += "\x1B[0m";
+        }
     }
 
 #endif
@@ -1,6 +1,7 @@
 #ifndef ROG_DETAILS_CONSOLE_HPP
 #define ROG_DETAILS_CONSOLE_HPP
 
+#include <string>
 #include <string_view>
 
 namespace rog
@@ -14,27 +15,46 @@ namespace rog
         Default
     };
 
+    /**
+     *  \brief Specifies whether the console uses colors.
+     *  \c Auto uses colors only if the standard output is a terminal.
+     */
+    enum class ColorMode
+    {
+        Auto,
+        Always,
+        Never
+    };
+
+    /**
+     *  \brief Buffered writer to the standard output.
+     *  Text is collected in a buffer that is written out in large chunks
+     *  when it fills up, on \c flush , and on destruction.
+     */
     class Console
     {
     public:
+        explicit Console (ColorMode = ColorMode::Auto);
+        Console (Console const&) = delete;
+        Console (Console&&) = default;
+        ~Console ();
+
         auto print (std::string_view) -> void;
         auto print (std::string_view, Color) -> void;
         auto print (std::string_view, Color, int) -> void;
         auto println (std::string_view) -> void;
         auto println (std::string_view, Color) -> void;
         auto println (std::string_view, Color, int) -> void;
+        auto flush () -> void;
 
     private:
-        auto set_next_token_width (int) -> void;
+        auto print_padded (std::string_view, int) -> void;
         auto set_color (Color) -> void;
         auto reset_color () -> void;
 
-    public:
-#if defined(_WIN32) || defined(_WIN64)
-        Console();
-#endif
-
     private:
+        std::string buffer_;
+        bool colors_;
 #if defined(_WIN32) || defined(_WIN64)
         unsigned short defaultColor_;
 #endif
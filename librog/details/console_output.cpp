@@ -1,13 +1,15 @@
 #include <librog/details/console_output.hpp>
 
 #include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <string_view>
+#include <librog/benchmark.hpp>
 #include <librog/rog.hpp>
 
 namespace rog
 {
-    namespace
+    namespace details
     {
         auto test_result_to_color (TestResult const result) -> Color
         {
@@ -26,12 +28,224 @@ namespace rog
                 return Color::Default;
             }
         }
+
+        auto test_result_to_string (TestResult const result) -> std::string_view
+        {
+            switch (result)
+            {
+            case TestResult::Pass:
+                return "pass";
+
+            case TestResult::Fail:
+                return "fail";
+
+            case TestResult::Partial:
+                return "partial";
+
+            default:
+                return "skipped";
+            }
+        }
+
+        auto print_message
+            (Console& console, std::string_view prefix, TestMessage const& m)
+            -> void
+        {
+            console.print(prefix);
+            switch (m.type_)
+            {
+            case TestMessageType::Pass:
+                console.print("pass", Color::Green);
+                break;
+
+            case TestMessageType::Fail:
+                console.print("fail", Color::Red);
+                break;
+
+            case TestMessageType::Info:
+                console.print("info", Color::Blue);
+                break;
+
+            default:
+                break;
+            }
+            console.print(" ");
+            console.println(m.text_);
+        }
+    }
+
+    namespace
+    {
+        /**
+         *  \brief Prints allocations of \p t if they are tracked.
+         */
+        auto print_allocations
+            (Console& console, std::string_view prefix, LeafTest const& t)
+            -> void
+        {
+            if constexpr (details::TrackAllocations)
+            {
+                auto const& a = t.allocations();
+                console.print(prefix);
+                console.print("alloc", a.leakedBytes_ > 0 ? Color::Yellow : Color::Blue);
+                console.println(
+                    " " + std::to_string(a.count_) + " allocations of " +
+                    std::to_string(a.bytes_) + " B, peak " +
+                    std::to_string(a.peakBytes_) + " B, leaked " +
+                    std::to_string(a.leakedBytes_) + " B in " +
+                    std::to_string(a.leakedCount_) + " allocations"
+                );
+            }
+        }
+
+        /**
+         *  \brief Prints available hardware counters of \p t divided
+         *  by \p iterations .
+         */
+        auto print_counters
+            ( Console&          console
+            , std::string_view  prefix
+            , Test const&       t
+            , double const      iterations ) -> void
+        {
+            auto const& counters = t.hardware_counters();
+            auto line = std::string();
+            for (auto const& [name, value] : details::counter_fields(counters))
+            {
+                if (value)
+                {
+                    char buffer[32];
+                    std::snprintf(
+                        buffer,
+                        sizeof(buffer),
+                        iterations > 1 ? "%.1f" : "%.0f",
+                        static_cast<double>(*value) / iterations
+                    );
+                    auto label = std::string(name);
+                    std::ranges::replace(label, '_', ' ');
+                    line += line.empty() ? " " : ", ";
+                    line += buffer;
+                    line += ' ';
+                    line += label;
+                }
+            }
+
+            if (line.empty())
+            {
+                return;
+            }
+
+            if (counters.cycles_ && counters.instructions_ && *counters.cycles_ > 0)
+            {
+                char buffer[32];
+                std::snprintf(
+                    buffer,
+                    sizeof(buffer),
+                    ", %.2f IPC",
+                    static_cast<double>(*counters.instructions_)
+                        / static_cast<double>(*counters.cycles_)
+                );
+                line += buffer;
+            }
+
+            if (iterations > 1)
+            {
+                line += " per iteration";
+            }
+
+            console.print(prefix);
+            console.print("perf", Color::Blue);
+            console.println(line);
+        }
+
+        auto print_benchmark
+            (Console& console, std::string_view prefix, BenchmarkTest const& t)
+            -> void
+        {
+            if (not t.error().empty())
+            {
+                details::print_message(
+                    console,
+                    prefix,
+                    TestMessage {TestMessageType::Fail, t.error()}
+                );
+                return;
+            }
+
+            if (t.result() == TestResult::NotEvaluated)
+            {
+                return;
+            }
+
+            if (not t.regression().empty())
+            {
+                details::print_message(
+                    console,
+                    prefix,
+                    TestMessage {TestMessageType::Fail, t.regression()}
+                );
+            }
+
+            auto const& s = t.stats();
+            console.print(prefix);
+            console.print("time", Color::Blue);
+            console.println(
+                " mean " + details::format_duration(s.mean_) +
+                ", median " + details::format_duration(s.median_) +
+                ", stddev " + details::format_duration(s.stddev_) +
+                ", min " + details::format_duration(s.min_) +
+                " (" + std::to_string(s.samples_) + " samples of " +
+                std::to_string(s.iterations_) + " iterations)"
+            );
+
+            auto const& settings = t.settings();
+            if (settings.itemsPerIteration_ > 0 || settings.bytesPerIteration_ > 0)
+            {
+                auto rates = std::string();
+                if (settings.itemsPerIteration_ > 0)
+                {
+                    rates += " " + details::format_rate(s.itemsPerSecond_, "items");
+                }
+                if (settings.bytesPerIteration_ > 0)
+                {
+                    rates += " " + details::format_rate(s.bytesPerSecond_, "B");
+                }
+                console.print(prefix);
+                console.print("rate", Color::Blue);
+                console.println(rates);
+            }
+
+            print_counters(
+                console,
+                prefix,
+                t,
+                static_cast<double>(s.iterations_ * s.samples_)
+            );
+        }
     }
 
     TestOutputterVisitor::TestOutputterVisitor
-        (ConsoleOutputType o) :
-        otype_ (o)
+        (ConsoleOutputType o, ColorMode c, TimeColumn times) :
+        console_ (c),
+        otype_ (o),
+        times_ (times)
+    {
+    }
+
+    auto TestOutputterVisitor::print_name
+        (Test const& t) -> void
     {
+        if (times_ == TimeColumn::Hide)
+        {
+            console_.println(t.name(), details::test_result_to_color(t.result()));
+            return;
+        }
+
+        console_.print(t.name(), details::test_result_to_color(t.result()));
+        console_.println(
+            "  [" + details::format_duration(t.wall_time()) +
+            ", cpu " + details::format_duration(t.cpu_time()) + "]"
+        );
     }
 
     auto TestOutputterVisitor::visit
@@ -39,35 +253,35 @@ namespace rog
     {
         if (prefix_.empty())
         {
-            console_.println(t.name(), test_result_to_color(t.result()));
+            this->print_name(t);
         }
 
         prefix_ += "    ";
         if (otype_ != ConsoleOutputType::NoLeaf)
         {
+            auto recordedPasses = std::size_t {0};
             for (auto const& r : t.output())
             {
-                console_.print(prefix_);
-                switch (r.type_)
+                details::print_message(console_, prefix_, r);
+                if (r.type_ == TestMessageType::Pass)
                 {
-                case TestMessageType::Pass:
-                    console_.print("pass", Color::Green);
-                    break;
-
-                case TestMessageType::Fail:
-                    console_.print("fail", Color::Red);
-                    break;
-
-                case TestMessageType::Info:
-                    console_.print("info", Color::Blue);
-                    break;
-
-                default:
-                    break;
+                    ++recordedPasses;
                 }
+            }
+
+            // Passes that were only counted, see RecordPolicy.
+            if (t.pass_count() > recordedPasses)
+            {
+                console_.print(prefix_);
+                console_.print("pass", Color::Green);
                 console_.print(" ");
-                console_.println(r.text_);
+                console_.println(
+                    std::to_string(t.pass_count() - recordedPasses) +
+                    " passed assertions"
+                );
             }
+            print_allocations(console_, prefix_, t);
+            print_counters(console_, prefix_, t, 1);
         }
 
         if (prefix_.size() >= 4)
@@ -81,19 +295,50 @@ namespace rog
         }
     }
 
+    auto TestOutputterVisitor::visit
+        (BenchmarkTest& t) -> void
+    {
+        if (prefix_.empty())
+        {
+            this->print_name(t);
+        }
+
+        prefix_ += "    ";
+        if (otype_ != ConsoleOutputType::NoLeaf)
+        {
+            print_benchmark(console_, prefix_, t);
+        }
+
+        if (prefix_.size() >= 4)
+        {
+            prefix_.resize(std::max(0ul, prefix_.size() - 4));
+        }
+
+        if (prefix_.size() >= 4)
+        {
+            prefix_.resize(std::max(0ul, prefix_.size() - 4));
+        }
+    }
+
+    auto TestOutputterVisitor::visit
+        (LazyTest& t) -> void
+    {
+        this->visit(t.snapshot());
+    }
+
     auto TestOutputterVisitor::visit
         (CompositeTest& t) -> void
     {
         if (prefix_.empty())
         {
-            console_.println(t.name(), test_result_to_color(t.result()));
+            this->print_name(t);
         }
 
         for (auto const& st : t.subtests())
         {
             console_.print(prefix_);
             console_.print("+>  ");
-            console_.println(st->name(), test_result_to_color(st->result()));
+            this->print_name(*st);
 
             prefix_ += &st == &t.subtests().back() ? "    " :  "|   ";
             st->accept(*this);
@@ -104,4 +349,101 @@ namespace rog
             prefix_.resize(std::max(0ul, prefix_.size() - 4));
         }
     }
+
+    StreamingConsoleReporter::StreamingConsoleReporter
+        (ConsoleOutputType o, ColorMode c, std::size_t slowest) :
+        console_ (c),
+        otype_ (o),
+        lastFlush_ (clock_t::now()),
+        slowest_ (slowest)
+    {
+    }
+
+    auto StreamingConsoleReporter::on_run_finished
+        (Test const& t) -> void
+    {
+        auto const s = t.summary();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        console_.println(
+            std::to_string(s.pass_) + " passed, " +
+            std::to_string(s.fail_) + " failed, " +
+            std::to_string(s.partial_) + " partial, " +
+            std::to_string(s.notEvaluated_) + " skipped"
+        );
+
+        auto const slowest = slowest_.sorted();
+        if (not slowest.empty())
+        {
+            console_.println("Slowest tests:");
+            for (auto const& e : slowest)
+            {
+                console_.print("    ");
+                console_.print(details::format_duration(e.time_), Color::Default, 14);
+                console_.println(e.path_);
+            }
+        }
+        console_.flush();
+    }
+
+    auto StreamingConsoleReporter::on_test_started
+        (LeafTest const&, std::string_view) -> void
+    {
+        // Nothing stays unprinted while a long test is running.
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        console_.flush();
+        lastFlush_ = clock_t::now();
+    }
+
+    auto StreamingConsoleReporter::on_test_finished
+        (LeafTest const& t, std::string_view const path) -> void
+    {
+        auto const result = t.result();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        slowest_.add(t.wall_time(), path);
+        console_.print(
+            details::test_result_to_string(result),
+            details::test_result_to_color(result),
+            8
+        );
+        console_.println(path);
+
+        if (otype_ != ConsoleOutputType::NoLeaf)
+        {
+            for (auto const& m : t.output())
+            {
+                details::print_message(console_, "        ", m);
+            }
+            print_allocations(console_, "        ", t);
+            print_counters(console_, "        ", t, 1);
+        }
+
+        this->flush_if_due();
+    }
+
+    auto StreamingConsoleReporter::on_benchmark_finished
+        (BenchmarkTest const& t, std::string_view const path) -> void
+    {
+        auto const result = t.result();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        slowest_.add(t.wall_time(), path);
+        console_.print(
+            details::test_result_to_string(result),
+            details::test_result_to_color(result),
+            8
+        );
+        console_.println(path);
+        print_benchmark(console_, "        ", t);
+        this->flush_if_due();
+    }
+
+    auto StreamingConsoleReporter::flush_if_due
+        () -> void
+    {
+        auto const now = clock_t::now();
+        if (now - lastFlush_ >= std::chrono::milliseconds(100))
+        {
+            console_.flush();
+            lastFlush_ = now;
+        }
+    }
 }
\ No newline at end of file
@@ -2,7 +2,12 @@
 #define ROG_DETAILS_CONSOLE_OUTPUT_HPP
 
 #include <librog/details/console.hpp>
+#include <librog/details/timing.hpp>
+#include <librog/listeners.hpp>
 #include <librog/visitors.hpp>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
 #include <string>
 
 namespace rog
@@ -16,8 +21,35 @@ namespace rog
         NoLeaf
     };
 
+    /**
+     *  \brief Specifies whether run times of tests are printed.
+     */
+    enum class TimeColumn
+    {
+        Hide,
+        Show
+    };
+
+    class Test;
     class LeafTest;
     class CompositeTest;
+    class BenchmarkTest;
+    class LazyTest;
+    struct TestMessage;
+    enum class TestResult;
+
+    namespace details
+    {
+        auto test_result_to_color (TestResult) -> Color;
+        auto test_result_to_string (TestResult) -> std::string_view;
+
+        /**
+         *  \brief Prints \p m as a single line starting with \p prefix .
+         */
+        auto print_message
+            (Console& console, std::string_view prefix, TestMessage const& m)
+            -> void;
+    }
 
     /**
      *  \brief Prints results of all tests in the hierarchy.
@@ -25,14 +57,60 @@ namespace rog
     class TestOutputterVisitor : public IVisitor
     {
     public:
-        TestOutputterVisitor(ConsoleOutputType);
+        TestOutputterVisitor(
+            ConsoleOutputType,
+            ColorMode = ColorMode::Auto,
+            TimeColumn = TimeColumn::Hide
+        );
         auto visit (LeafTest&) -> void override;
         auto visit (CompositeTest&) -> void override;
+        auto visit (BenchmarkTest&) -> void override;
+        auto visit (LazyTest&) -> void override;
+
+    private:
+        auto print_name (Test const&) -> void;
 
     private:
         Console console_;
         std::string prefix_;
         ConsoleOutputType otype_;
+        TimeColumn times_;
+    };
+
+    /**
+     *  \brief Prints result of each leaf as soon as it finishes
+     *  and a summary at the end of the run.
+     *  Can be used in parallel runs.
+     */
+    class StreamingConsoleReporter : public ITestListener
+    {
+    public:
+        /**
+         *  \param slowest number of slowest leaves listed after the summary.
+         */
+        StreamingConsoleReporter (
+            ConsoleOutputType = ConsoleOutputType::NoLeaf,
+            ColorMode = ColorMode::Auto,
+            std::size_t slowest = 0
+        );
+        auto on_run_finished (Test const&) -> void override;
+        auto on_test_started (LeafTest const&, std::string_view) -> void override;
+        auto on_test_finished (LeafTest const&, std::string_view) -> void override;
+        auto on_benchmark_finished
+            (BenchmarkTest const&, std::string_view) -> void override;
+
+    private:
+        using clock_t = std::chrono::steady_clock;
+
+    private:
+        auto flush_if_due () -> void;
+
+    private:
+        std::mutex mutex_;
+        Console console_;
+        ConsoleOutputType otype_;
+        clock_t::time_point lastFlush_;
+        details::SlowestLeaves slowest_;
     };
 }
 
@@ -0,0 +1,844 @@
+#include <librog/details/coordinator.hpp>
+
+#include <librog/rog.hpp>
+#include <librog/details/remote_units.hpp>
+#include <librog/details/run_context.hpp>
+#include <librog/details/serialization.hpp>
+#include <librog/details/watchdog.hpp>
+#include <librog/details/worker_protocol.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace rog::details
+{
+#if defined(__APPLE__) || defined(__linux__)
+
+    namespace
+    {
+        // Leaf that was running in this many workers that died fails.
+        constexpr auto MaxAttempts = 3u;
+
+        // Local worker that closed its connection and does not exit
+        // within this time is killed.
+        constexpr auto ExitTimeout = std::chrono::milliseconds(500);
+
+        struct Connection
+        {
+            int fd_;
+            pid_t pid_;
+            std::string buffer_;
+            group_t batch_;
+            std::vector<bool> finished_;
+            std::optional<std::size_t> current_;
+            std::chrono::steady_clock::time_point started_;
+            bool waiting_;
+            bool timedOut_;
+        };
+
+        auto make_address
+            (std::string const& path, sockaddr_un& address) -> bool
+        {
+            address = sockaddr_un();
+            address.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof(address.sun_path))
+            {
+                return false;
+            }
+            std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+            return true;
+        }
+
+        auto ignore_sigpipe ([[maybe_unused]] int const fd) -> void
+        {
+#if defined(SO_NOSIGPIPE)
+            auto const on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        }
+
+        /**
+         *  \brief Returns pid of the process connected to socket \p fd
+         *  as reported by the kernel, 0 if it is not known.
+         */
+        auto peer_pid ([[maybe_unused]] int const fd) -> pid_t
+        {
+#if defined(SO_PEERCRED)
+            auto credentials = ucred();
+            auto size = static_cast<socklen_t>(sizeof(credentials));
+            if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0)
+            {
+                return credentials.pid;
+            }
+#elif defined(LOCAL_PEERPID)
+            auto pid = pid_t {0};
+            auto size = static_cast<socklen_t>(sizeof(pid));
+            if (::getsockopt(fd, SOL_LOCAL, LOCAL_PEERPID, &pid, &size) == 0)
+            {
+                return pid;
+            }
+#endif
+            return 0;
+        }
+
+        auto read_some (int const fd, std::string& buffer) -> bool
+        {
+            char chunk[1 << 16];
+            for (;;)
+            {
+                auto const n = ::read(fd, chunk, sizeof(chunk));
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return false;
+                }
+                buffer.append(chunk, static_cast<std::size_t>(n));
+                return true;
+            }
+        }
+
+        /**
+         *  \brief Returns true if the coordinator sent something while
+         *  the worker runs a batch, which means that it should stop.
+         */
+        auto stop_requested (int const fd) -> bool
+        {
+            auto pfd = pollfd {fd, POLLIN, 0};
+            return ::poll(&pfd, 1, 0) > 0;
+        }
+
+        auto connect_to (std::string const& path) -> int
+        {
+            auto address = sockaddr_un();
+            if (not make_address(path, address))
+            {
+                return -1;
+            }
+
+            auto const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0)
+            {
+                return -1;
+            }
+
+            auto const* a = reinterpret_cast<sockaddr const*>(&address);
+            if (::connect(fd, a, sizeof(address)) != 0)
+            {
+                ::close(fd);
+                return -1;
+            }
+
+            ignore_sigpipe(fd);
+            return fd;
+        }
+
+        /**
+         *  \brief Serves the coordinator until it tells the worker to stop.
+         *  A leaf that crashes takes the worker down with it. Leaves are
+         *  run with \p base settings without their listeners and filter.
+         */
+        auto serve_coordinator
+            ( Test&               root
+            , std::string const&  socketPath
+            , RunSettings const&  base ) -> bool
+        {
+            auto const fd = connect_to(socketPath);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            // All leaves are known to the worker, the coordinator decides
+            // which of them are run. Events are reported by the coordinator.
+            auto settings = base;
+            settings.listeners_.clear();
+            settings.filter_ = TestFilter();
+            auto const context = RunContext {
+                &settings,
+                nullptr,
+                std::string(root.name())
+            };
+            auto units = RemoteUnits(root, context);
+
+            // The coordinator learns the pid from the socket.
+            auto const request = make_frame(FrameType::Request, 0, {});
+            auto buffer = std::string();
+            auto payload = ByteWriter();
+            auto stop = not send_all(fd, request);
+            while (not stop && read_some(fd, buffer))
+            {
+                auto consumed = std::size_t {0};
+                while (auto const frame = next_frame(buffer, consumed))
+                {
+                    if (frame->type_ != FrameType::Batch)
+                    {
+                        stop = true;
+                        break;
+                    }
+
+                    auto in = ByteReader(frame->payload_);
+                    auto const count = in.u32();
+                    for (auto i = 0u; i < count && not in.failed(); ++i)
+                    {
+                        if (stop_requested(fd))
+                        {
+                            stop = true;
+                            break;
+                        }
+
+                        auto const unit = std::size_t {in.u32()};
+                        auto const path = in.string();
+                        auto const local = units.find(path);
+                        if (not local)
+                        {
+                            send_all(fd, make_frame(FrameType::Unknown, unit, {}));
+                            continue;
+                        }
+
+                        send_all(fd, make_frame(FrameType::Started, unit, {}));
+                        units.run(*local, context);
+                        payload.clear();
+                        units.write_state(*local, payload);
+                        send_all(fd, make_frame(FrameType::Finished, unit, payload.bytes()));
+                    }
+
+                    if (stop || not send_all(fd, request))
+                    {
+                        stop = true;
+                        break;
+                    }
+                }
+                buffer.erase(0, consumed);
+            }
+
+            ::close(fd);
+            return true;
+        }
+
+        class Coordinator
+        {
+        public:
+            Coordinator (Test& root, RunContext& context) :
+                root_ (&root),
+                context_ (&context),
+                units_ (root, context),
+                queue_ (units_.groups()),
+                attempts_ (units_.size(), 0),
+                remaining_ (units_.size()),
+                listenFd_ (-1),
+                stopSent_ (false)
+            {
+            }
+
+            auto run () -> void
+            {
+                if (not this->listen())
+                {
+                    for (auto const& g : queue_)
+                    {
+                        for (auto const u : g)
+                        {
+                            units_.run(u, *context_);
+                        }
+                    }
+                }
+                else
+                {
+                    this->serve();
+                    this->shut_down();
+                }
+
+                units_.run_benchmarks();
+            }
+
+            auto finish () -> void
+            {
+                units_.finish(*root_);
+            }
+
+        private:
+            auto listen () -> bool
+            {
+                auto const& path = context_->settings_->coordinatorSocket_;
+                auto address = sockaddr_un();
+                if (not make_address(path, address))
+                {
+                    return false;
+                }
+
+                listenFd_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                if (listenFd_ < 0)
+                {
+                    return false;
+                }
+
+                // Socket left behind by a previous run.
+                ::unlink(path.c_str());
+                auto const* a = reinterpret_cast<sockaddr const*>(&address);
+                if (::bind(listenFd_, a, sizeof(address)) != 0
+                 || ::listen(listenFd_, SOMAXCONN) != 0)
+                {
+                    ::close(listenFd_);
+                    listenFd_ = -1;
+                    return false;
+                }
+                return true;
+            }
+
+            auto serve () -> void
+            {
+                while (not this->finished())
+                {
+                    if (units_.is_cancelled())
+                    {
+                        this->cancel();
+                    }
+                    this->spawn_local_workers();
+                    this->dispatch();
+                    this->poll_connections();
+                }
+            }
+
+            /**
+             *  \brief Returns true if all leaves finished, or if the run
+             *  was cancelled and no leaf is running.
+             */
+            auto finished () const -> bool
+            {
+                if (remaining_ == 0)
+                {
+                    return true;
+                }
+
+                return units_.is_cancelled()
+                    && std::ranges::none_of(connections_, [](Connection const& c)
+                       {
+                           return c.current_.has_value();
+                       });
+            }
+
+            /**
+             *  \brief Tells the workers to stop after their current leaf.
+             */
+            auto cancel () -> void
+            {
+                if (stopSent_)
+                {
+                    return;
+                }
+
+                stopSent_ = true;
+                queue_.clear();
+                for (auto const& c : connections_)
+                {
+                    send_all(c.fd_, make_frame(FrameType::Stop, 0, {}));
+                }
+            }
+
+            auto shut_down () -> void
+            {
+                for (auto const& c : connections_)
+                {
+                    send_all(c.fd_, make_frame(FrameType::Stop, 0, {}));
+                    ::close(c.fd_);
+                }
+                connections_.clear();
+
+                ::close(listenFd_);
+                ::unlink(context_->settings_->coordinatorSocket_.c_str());
+
+                for (auto const pid : localWorkers_)
+                {
+                    auto status = 0;
+                    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR)
+                    {
+                    }
+                }
+                localWorkers_.clear();
+            }
+
+            auto spawn_local_workers () -> void
+            {
+                this->reap_local_workers();
+                auto const count = context_->settings_->processCount_;
+                while (localWorkers_.size() < count && not queue_.empty())
+                {
+                    std::cout.flush();
+                    std::fflush(nullptr);
+
+                    auto const pid = ::fork();
+                    if (pid < 0)
+                    {
+                        return;
+                    }
+
+                    if (pid == 0)
+                    {
+                        ::close(listenFd_);
+                        for (auto const& c : connections_)
+                        {
+                            ::close(c.fd_);
+                        }
+                        serve_coordinator(
+                            *root_,
+                            context_->settings_->coordinatorSocket_,
+                            *context_->settings_
+                        );
+                        std::cout.flush();
+                        std::fflush(nullptr);
+                        ::_exit(0);
+                    }
+                    localWorkers_.emplace_back(pid);
+                }
+            }
+
+            /**
+             *  \brief Reaps local workers that exited without connecting
+             *  or before their connection was closed.
+             */
+            auto reap_local_workers () -> void
+            {
+                std::erase_if(localWorkers_, [this](pid_t const pid)
+                {
+                    auto status = 0;
+                    if (::waitpid(pid, &status, WNOHANG) == pid)
+                    {
+                        exited_[pid] = status;
+                        return true;
+                    }
+                    return false;
+                });
+            }
+
+            auto dispatch () -> void
+            {
+                for (auto& c : connections_)
+                {
+                    if (queue_.empty())
+                    {
+                        return;
+                    }
+
+                    if (not c.waiting_)
+                    {
+                        continue;
+                    }
+
+                    auto const batch = this->next_batch();
+                    auto payload = ByteWriter();
+                    payload.u32(static_cast<std::uint32_t>(batch.size()));
+                    for (auto const u : batch)
+                    {
+                        payload.u32(static_cast<std::uint32_t>(u));
+                        payload.string(units_.path(u));
+                    }
+
+                    c.batch_ = batch;
+                    c.finished_.assign(batch.size(), false);
+                    c.waiting_ = false;
+
+                    // Failed write closes the connection, which queues
+                    // the batch again.
+                    send_all(c.fd_, make_frame(FrameType::Batch, 0, payload.bytes()));
+                }
+            }
+
+            auto next_batch () -> group_t
+            {
+                auto const workers = std::max(std::size_t {1}, connections_.size());
+                auto const target = std::max(
+                    std::size_t {1},
+                    remaining_ / (std::size_t {4} * workers)
+                );
+                auto batch = group_t();
+                while (not queue_.empty() && batch.size() < target)
+                {
+                    auto& g = queue_.front();
+                    batch.insert(batch.end(), g.begin(), g.end());
+                    queue_.pop_front();
+                }
+                return batch;
+            }
+
+            auto poll_connections () -> void
+            {
+                auto pfds = std::vector<pollfd>();
+                pfds.emplace_back(pollfd {listenFd_, POLLIN, 0});
+                for (auto const& c : connections_)
+                {
+                    pfds.emplace_back(pollfd {c.fd_, POLLIN, 0});
+                }
+
+                // Wakes up now and then to notice local workers that died
+                // before they connected.
+                auto timeout = this->poll_timeout();
+                if (not localWorkers_.empty())
+                {
+                    timeout = timeout < 0 ? 1000 : std::min(timeout, 1000);
+                }
+                auto const ready = ::poll(pfds.data(), pfds.size(), timeout);
+                this->kill_timed_out();
+                if (ready <= 0)
+                {
+                    return;
+                }
+
+                auto closed = std::vector<std::size_t>();
+                for (auto i = std::size_t {1}; i < pfds.size(); ++i)
+                {
+                    if (pfds[i].revents == 0)
+                    {
+                        continue;
+                    }
+
+                    auto& c = connections_[i - 1];
+                    if (not read_some(c.fd_, c.buffer_))
+                    {
+                        closed.emplace_back(i - 1);
+                        continue;
+                    }
+                    this->process_frames(c);
+                }
+
+                for (auto const i : closed | std::views::reverse)
+                {
+                    this->drop(connections_[i]);
+                    connections_.erase(connections_.begin() + static_cast<long>(i));
+                }
+
+                if (pfds[0].revents != 0)
+                {
+                    this->accept();
+                }
+            }
+
+            auto accept () -> void
+            {
+                auto const fd = ::accept(listenFd_, nullptr, nullptr);
+                if (fd < 0)
+                {
+                    return;
+                }
+
+                ignore_sigpipe(fd);
+                connections_.emplace_back(Connection {
+                    fd, peer_pid(fd), {}, {}, {}, std::nullopt, {}, false, false
+                });
+            }
+
+            auto process_frames (Connection& c) -> void
+            {
+                auto consumed = std::size_t {0};
+                while (auto const frame = next_frame(c.buffer_, consumed))
+                {
+                    if (frame->type_ == FrameType::Request)
+                    {
+                        c.batch_.clear();
+                        c.finished_.clear();
+                        c.waiting_ = true;
+                        continue;
+                    }
+
+                    auto const unit = frame->unit_;
+                    if (std::ranges::find(c.batch_, unit) == c.batch_.end())
+                    {
+                        continue;
+                    }
+
+                    if (frame->type_ == FrameType::Started)
+                    {
+                        c.current_ = unit;
+                        c.started_ = std::chrono::steady_clock::now();
+                        units_.notify_started(unit);
+                    }
+                    else if (frame->type_ == FrameType::Finished)
+                    {
+                        auto in = ByteReader(frame->payload_);
+                        units_.read_state(unit, in);
+                        this->mark_finished(c, unit);
+                        units_.notify_finished(unit);
+                    }
+                    else if (frame->type_ == FrameType::Unknown)
+                    {
+                        units_.fail(unit, "Worker does not have the test");
+                        this->mark_finished(c, unit);
+                        units_.notify_finished(unit);
+                    }
+                }
+                c.buffer_.erase(0, consumed);
+            }
+
+            /**
+             *  \brief Queues unfinished leaves of a closed connection again.
+             */
+            auto drop (Connection& c) -> void
+            {
+                ::close(c.fd_);
+
+                if (c.current_)
+                {
+                    auto const unit = *c.current_;
+                    auto const elapsed =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - c.started_
+                        );
+                    auto const reason = this->exit_reason(c.pid_);
+                    if (c.timedOut_ || ++attempts_[unit] >= MaxAttempts)
+                    {
+                        units_.fail(
+                            unit,
+                            c.timedOut_
+                                ? timeout_message(elapsed, units_.timeout(unit))
+                                : reason
+                        );
+                        units_.set_wall_time(unit, elapsed);
+                        this->mark_finished(c, unit);
+                        units_.notify_finished(unit);
+                    }
+                }
+
+                auto retry = group_t();
+                for (auto i = std::size_t {0}; i < c.batch_.size(); ++i)
+                {
+                    if (not c.finished_[i])
+                    {
+                        retry.emplace_back(c.batch_[i]);
+                    }
+                }
+
+                if (not retry.empty() && not units_.is_cancelled())
+                {
+                    queue_.emplace_front(std::move(retry));
+                }
+            }
+
+            auto exit_reason (pid_t const pid) -> std::string
+            {
+                auto status = std::optional<int>();
+                auto const local = std::ranges::find(localWorkers_, pid);
+                if (pid > 0 && local != localWorkers_.end())
+                {
+                    localWorkers_.erase(local);
+                    status = reap(pid);
+                }
+                else if (auto const it = exited_.find(pid); it != exited_.end())
+                {
+                    status = it->second;
+                }
+
+                if (not status)
+                {
+                    return "Worker disconnected during the test";
+                }
+                return WIFEXITED(*status) && WEXITSTATUS(*status) == 0
+                    ? "Worker exited during the test"
+                    : describe_exit(*status);
+            }
+
+            /**
+             *  \brief Waits for local worker \p pid whose connection closed.
+             *  A worker that does not exit in time is killed, so that it
+             *  can not stop the run.
+             *  \return Exit status, or nothing if \p pid is not a child.
+             */
+            static auto reap (pid_t const pid) -> std::optional<int>
+            {
+                auto status = 0;
+                auto const deadline = std::chrono::steady_clock::now() + ExitTimeout;
+                while (std::chrono::steady_clock::now() < deadline)
+                {
+                    auto const reaped = ::waitpid(pid, &status, WNOHANG);
+                    if (reaped == pid)
+                    {
+                        return status;
+                    }
+                    if (reaped < 0 && errno != EINTR)
+                    {
+                        return std::nullopt;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                ::kill(pid, SIGKILL);
+                while (::waitpid(pid, &status, 0) < 0)
+                {
+                    if (errno != EINTR)
+                    {
+                        return std::nullopt;
+                    }
+                }
+                return status;
+            }
+
+            /**
+             *  \brief Returns milliseconds until the nearest time limit
+             *  of a running leaf, -1 if there is none.
+             */
+            auto poll_timeout () const -> int
+            {
+                auto const now = std::chrono::steady_clock::now();
+                auto timeout = -1;
+                for (auto const& c : connections_)
+                {
+                    auto const limit = c.current_
+                        ? units_.timeout(*c.current_)
+                        : std::chrono::nanoseconds::zero();
+                    if (limit <= std::chrono::nanoseconds::zero() || c.timedOut_)
+                    {
+                        continue;
+                    }
+
+                    auto const left = std::chrono::ceil<std::chrono::milliseconds>(
+                        c.started_ + limit - now
+                    );
+                    auto const ms = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+                    timeout = timeout < 0 ? ms : std::min(timeout, ms);
+                }
+                return timeout;
+            }
+
+            /**
+             *  \brief Disconnects workers whose leaf exceeded its time limit
+             *  and kills them. The pid is the one the kernel reports for
+             *  the socket, a worker whose pid is not known is only
+             *  disconnected.
+             */
+            auto kill_timed_out () -> void
+            {
+                auto const now = std::chrono::steady_clock::now();
+                for (auto& c : connections_)
+                {
+                    auto const limit = c.current_
+                        ? units_.timeout(*c.current_)
+                        : std::chrono::nanoseconds::zero();
+                    if (limit > std::chrono::nanoseconds::zero()
+                     && not c.timedOut_
+                     && now - c.started_ >= limit)
+                    {
+                        // Closed connection queues the rest of its batch.
+                        ::shutdown(c.fd_, SHUT_RDWR);
+                        if (c.pid_ > 0)
+                        {
+                            ::kill(c.pid_, SIGKILL);
+                        }
+                        c.timedOut_ = true;
+                    }
+                }
+            }
+
+            auto mark_finished (Connection& c, std::size_t const unit) -> void
+            {
+                auto const it = std::ranges::find(c.batch_, unit);
+                if (it != c.batch_.end())
+                {
+                    auto const i = static_cast<std::size_t>(it - c.batch_.begin());
+                    if (not c.finished_[i])
+                    {
+                        c.finished_[i] = true;
+                        --remaining_;
+                    }
+                }
+                c.current_.reset();
+            }
+
+        private:
+            Test* root_;
+            RunContext* context_;
+            RemoteUnits units_;
+            std::deque<group_t> queue_;
+            std::vector<unsigned int> attempts_;
+            std::size_t remaining_;
+            int listenFd_;
+            bool stopSent_;
+            std::vector<Connection> connections_;
+            std::vector<pid_t> localWorkers_;
+            std::unordered_map<pid_t, int> exited_;
+        };
+    }
+
+    auto run_coordinator
+        (Test& root, RunContext& context) -> void
+    {
+        auto coordinator = Coordinator(root, context);
+        coordinator.run();
+        coordinator.finish();
+    }
+
+    auto run_remote_worker
+        ( Test&               root
+        , std::string const&  socketPath
+        , RunSettings const&  settings ) -> bool
+    {
+        // The worker is restarted after a leaf crashes it, the coordinator
+        // queues the unfinished leaves again.
+        for (;;)
+        {
+            std::cout.flush();
+            std::fflush(nullptr);
+
+            auto const pid = ::fork();
+            if (pid < 0)
+            {
+                return serve_coordinator(root, socketPath, settings);
+            }
+
+            if (pid == 0)
+            {
+                auto const served = serve_coordinator(root, socketPath, settings);
+                std::cout.flush();
+                std::fflush(nullptr);
+                ::_exit(served ? 0 : 1);
+            }
+
+            auto status = 0;
+            while (::waitpid(pid, &status, 0) < 0 && errno == EINTR)
+            {
+            }
+
+            if (WIFEXITED(status))
+            {
+                return WEXITSTATUS(status) == 0;
+            }
+        }
+    }
+
+#else
+
+    auto run_coordinator
+        (Test& root, RunContext& context) -> void
+    {
+        root.run(context);
+    }
+
+    auto run_remote_worker
+        (Test&, std::string const&, RunSettings const&) -> bool
+    {
+        return false;
+    }
+
+#endif
+}
@@ -0,0 +1,45 @@
+#ifndef ROG_DETAILS_COORDINATOR_HPP
+#define ROG_DETAILS_COORDINATOR_HPP
+
+#include <string>
+
+namespace rog
+{
+    class Test;
+    struct RunSettings;
+}
+
+namespace rog::details
+{
+    struct RunContext;
+
+    /**
+     *  \brief Hands out leaves of \p root on demand to worker processes
+     *  that connect to the Unix domain socket given in the settings.
+     *
+     *  Workers request batches that shrink as the queue empties, so that
+     *  no worker is left with a long tail. Leaves of a serial composite
+     *  are always handed out together. Unfinished leaves of a worker that
+     *  disconnects are queued again, a leaf that was running in it fails
+     *  only after it brought down several workers. Falls back to
+     *  in-process run where the socket can not be created.
+     *
+     *  \param root root of the test hierarchy.
+     *  \param context state shared by all tests of the run.
+     */
+    auto run_coordinator (Test& root, RunContext& context) -> void;
+
+    /**
+     *  \brief Runs leaves of \p root handed out by the coordinator
+     *  listening at \p socketPath until it tells the worker to stop.
+     *  Leaves are found by their paths and run with \p settings .
+     *  \return false if the coordinator could not be reached.
+     */
+    auto run_remote_worker (
+        Test& root,
+        std::string const& socketPath,
+        RunSettings const& settings
+    ) -> bool;
+}
+
+#endif
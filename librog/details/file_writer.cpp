@@ -0,0 +1,167 @@
+#include <librog/details/file_writer.hpp>
+
+#include <cstdio>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#elif defined(__APPLE__) || defined(__linux__)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace rog::details
+{
+    namespace
+    {
+        // Buffer is written out once it grows past this size.
+        constexpr auto FlushThreshold = std::size_t {1 << 16};
+
+        auto write_fd (int const fd, std::string_view const str) -> void
+        {
+#if defined(_WIN32) || defined(_WIN64)
+            auto done = std::size_t {0};
+            while (done < str.size())
+            {
+                auto const n = ::_write(
+                    fd,
+                    str.data() + done,
+                    static_cast<unsigned int>(str.size() - done)
+                );
+                if (n <= 0)
+                {
+                    return;
+                }
+                done += static_cast<std::size_t>(n);
+            }
+#elif defined(__APPLE__) || defined(__linux__)
+            auto done = std::size_t {0};
+            while (done < str.size())
+            {
+                auto const n = ::write(fd, str.data() + done, str.size() - done);
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    return;
+                }
+                done += static_cast<std::size_t>(n);
+            }
+#else
+            static_cast<void>(fd);
+            std::fwrite(str.data(), 1, str.size(), stdout);
+#endif
+        }
+    }
+
+    FileWriter::FileWriter
+        (int const fd) :
+        fd_ (fd)
+    {
+    }
+
+    FileWriter::~FileWriter
+        ()
+    {
+        this->flush();
+    }
+
+    auto FileWriter::write
+        (std::string_view const str) -> void
+    {
+        buffer_ += str;
+        if (buffer_.size() >= FlushThreshold)
+        {
+            this->flush();
+        }
+    }
+
+    auto FileWriter::write
+        (char const c) -> void
+    {
+        buffer_ += c;
+        if (buffer_.size() >= FlushThreshold)
+        {
+            this->flush();
+        }
+    }
+
+    auto FileWriter::write_xml_escaped
+        (std::string_view const str) -> void
+    {
+        // Runs of characters that need no escaping are copied at once.
+        auto runStart = std::size_t {0};
+        for (auto i = std::size_t {0}; i < str.size(); ++i)
+        {
+            auto const c = static_cast<unsigned char>(str[i]);
+            auto replacement = std::string_view();
+            switch (c)
+            {
+            case '&':  replacement = "&amp;";  break;
+            case '<':  replacement = "&lt;";   break;
+            case '>':  replacement = "&gt;";   break;
+            case '"':  replacement = "&quot;"; break;
+            case '\'': replacement = "&apos;"; break;
+            case '\t':
+            case '\n':
+            case '\r':
+                break;
+            default:
+                if (c < 0x20)
+                {
+                    replacement = "?";
+                }
+                break;
+            }
+
+            if (not replacement.empty())
+            {
+                this->write(str.substr(runStart, i - runStart));
+                this->write(replacement);
+                runStart = i + 1;
+            }
+        }
+        this->write(str.substr(runStart));
+    }
+
+    auto FileWriter::write_json_escaped
+        (std::string_view const str) -> void
+    {
+        auto runStart = std::size_t {0};
+        for (auto i = std::size_t {0}; i < str.size(); ++i)
+        {
+            auto const c = static_cast<unsigned char>(str[i]);
+            if (c != '"' && c != '\\' && c >= 0x20)
+            {
+                continue;
+            }
+
+            this->write(str.substr(runStart, i - runStart));
+            runStart = i + 1;
+            switch (c)
+            {
+            case '"':  this->write("\\\""); break;
+            case '\\': this->write("\\\\"); break;
+            case '\n': this->write("\\n");  break;
+            case '\r': this->write("\\r");  break;
+            case '\t': this->write("\\t");  break;
+            default:
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    this->write(buffer);
+                }
+                break;
+            }
+        }
+        this->write(str.substr(runStart));
+    }
+
+    auto FileWriter::flush
+        () -> void
+    {
+        write_fd(fd_, buffer_);
+        buffer_.clear();
+    }
+}
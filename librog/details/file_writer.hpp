@@ -0,0 +1,45 @@
+#ifndef ROG_DETAILS_FILE_WRITER_HPP
+#define ROG_DETAILS_FILE_WRITER_HPP
+
+#include <string>
+#include <string_view>
+
+namespace rog::details
+{
+    /**
+     *  \brief Buffered writer to a file descriptor.
+     *  Does not own the descriptor. Text is written out when the buffer
+     *  fills up, on \c flush , and on destruction.
+     */
+    class FileWriter
+    {
+    public:
+        explicit FileWriter (int fd);
+        FileWriter (FileWriter const&) = delete;
+        ~FileWriter ();
+
+        auto write (std::string_view) -> void;
+        auto write (char) -> void;
+
+        /**
+         *  \brief Writes \p str with XML special characters replaced
+         *  by entities. Control characters not allowed in XML are
+         *  replaced by '?'.
+         */
+        auto write_xml_escaped (std::string_view str) -> void;
+
+        /**
+         *  \brief Writes \p str with JSON special and control characters
+         *  escaped. Does not write the surrounding quotes.
+         */
+        auto write_json_escaped (std::string_view str) -> void;
+
+        auto flush () -> void;
+
+    private:
+        std::string buffer_;
+        int fd_;
+    };
+}
+
+#endif
@@ -0,0 +1,282 @@
+#include <librog/details/hardware_counters.hpp>
+#include <librog/rog.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rog::details
+{
+    namespace
+    {
+        inline constexpr auto CounterCount = std::size_t {4};
+
+        using counts_t = std::array<std::optional<std::uint64_t>, CounterCount>;
+
+        auto to_counters (counts_t const& counts) -> HardwareCounters
+        {
+            return HardwareCounters {counts[0], counts[1], counts[2], counts[3]};
+        }
+
+#if defined(__linux__)
+        struct Event
+        {
+            std::uint32_t type_;
+            std::uint64_t config_;
+        };
+
+        /**
+         *  \brief Counted events in the order of \c HardwareCounters .
+         */
+        constexpr auto Events = std::array<Event, CounterCount> {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}
+        }};
+
+        /**
+         *  \brief Opens counter of \p event for the calling thread in user
+         *  space. Opens a disabled leader of a new group if \p group is -1,
+         *  or a member of \p group otherwise.
+         *  \return File descriptor, or -1 if the counter is not available.
+         */
+        auto open_event (Event const& event, int const group) -> int
+        {
+            auto attr = perf_event_attr {};
+            attr.size = sizeof(attr);
+            attr.type = event.type_;
+            attr.config = event.config_;
+            attr.disabled = group < 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP
+                             | PERF_FORMAT_ID
+                             | PERF_FORMAT_TOTAL_TIME_ENABLED
+                             | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            return static_cast<int>(::syscall(
+                SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC
+            ));
+        }
+#endif
+    }
+
+// CounterGroup:
+
+    /**
+     *  \brief Counters of a thread, they are opened at the first start.
+     */
+    class CounterGroup
+    {
+    public:
+        CounterGroup ()
+        {
+            fds_.fill(-1);
+            ids_.fill(0);
+        }
+
+        CounterGroup (CounterGroup const&) = delete;
+
+        ~CounterGroup ()
+        {
+            this->close();
+        }
+
+        /**
+         *  \brief Resets and starts the counters.
+         *  \return false if no counter is available or they are running.
+         */
+        auto start () -> bool
+        {
+#if defined(__linux__)
+            if (running_)
+            {
+                return false;
+            }
+
+            // Counters inherited through fork count the parent thread.
+            if (pid_ != ::getpid())
+            {
+                this->close();
+                this->open();
+            }
+
+            if (leader_ < 0)
+            {
+                return false;
+            }
+
+            ::ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ::ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            running_ = true;
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        /**
+         *  \brief Stops the counters and reads them.
+         */
+        auto stop () -> HardwareCounters
+        {
+            auto counts = counts_t();
+#if defined(__linux__)
+            ::ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            running_ = false;
+
+            // Layout given by read_format: nr, time_enabled, time_running,
+            // and nr pairs of value and id.
+            auto buffer = std::array<std::uint64_t, 3 + 2 * CounterCount>();
+            auto const size = ::read(leader_, buffer.data(), sizeof(buffer));
+            if (size < static_cast<::ssize_t>(3 * sizeof(std::uint64_t)))
+            {
+                return to_counters(counts);
+            }
+
+            auto const enabled = buffer[1];
+            auto const running = buffer[2];
+            if (running == 0)
+            {
+                // The group was never scheduled on the PMU.
+                return to_counters(counts);
+            }
+
+            auto const nr = std::min<std::uint64_t>(buffer[0], CounterCount);
+            auto const scale = static_cast<double>(enabled) / static_cast<double>(running);
+            for (auto j = std::size_t {0}; j < nr; ++j)
+            {
+                auto const value = buffer[3 + 2 * j];
+                auto const id = buffer[4 + 2 * j];
+                for (auto i = std::size_t {0}; i < CounterCount; ++i)
+                {
+                    if (fds_[i] >= 0 && ids_[i] == id)
+                    {
+                        counts[i] = running < enabled
+                            ? static_cast<std::uint64_t>(
+                                  std::llround(static_cast<double>(value) * scale)
+                              )
+                            : value;
+                    }
+                }
+            }
+#endif
+            return to_counters(counts);
+        }
+
+    private:
+        auto open () -> void
+        {
+#if defined(__linux__)
+            pid_ = ::getpid();
+            for (auto i = std::size_t {0}; i < CounterCount; ++i)
+            {
+                auto const fd = open_event(Events[i], leader_);
+                if (fd < 0)
+                {
+                    continue;
+                }
+
+                if (::ioctl(fd, PERF_EVENT_IOC_ID, &ids_[i]) != 0)
+                {
+                    ::close(fd);
+                    continue;
+                }
+
+                fds_[i] = fd;
+                if (leader_ < 0)
+                {
+                    leader_ = fd;
+                }
+            }
+#endif
+        }
+
+        auto close () -> void
+        {
+#if defined(__linux__)
+            for (auto& fd : fds_)
+            {
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                    fd = -1;
+                }
+            }
+#endif
+            leader_ = -1;
+            running_ = false;
+        }
+
+    private:
+        std::array<int, CounterCount> fds_;
+        std::array<std::uint64_t, CounterCount> ids_;
+        int leader_ {-1};
+        long pid_ {0};
+        bool running_ {false};
+    };
+
+    namespace
+    {
+        auto thread_group () -> CounterGroup&
+        {
+            thread_local auto group = CounterGroup();
+            return group;
+        }
+    }
+
+// HardwareCounterScope:
+
+    HardwareCounterScope::HardwareCounterScope
+        (bool const enabled) :
+        group_ (nullptr)
+    {
+        if (enabled && thread_group().start())
+        {
+            group_ = &thread_group();
+        }
+    }
+
+    HardwareCounterScope::~HardwareCounterScope
+        ()
+    {
+        if (group_)
+        {
+            this->stop();
+        }
+    }
+
+    auto HardwareCounterScope::stop
+        () -> HardwareCounters
+    {
+        if (not group_)
+        {
+            return HardwareCounters();
+        }
+
+        auto const counters = group_->stop();
+        group_ = nullptr;
+        return counters;
+    }
+
+// Free functions:
+
+    auto counter_fields
+        (HardwareCounters const& counters)
+        -> std::array<std::pair<std::string_view, std::optional<std::uint64_t>>, 4>
+    {
+        return {{
+            {"cycles", counters.cycles_},
+            {"instructions", counters.instructions_},
+            {"cache_misses", counters.cacheMisses_},
+            {"branch_misses", counters.branchMisses_}
+        }};
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef ROG_DETAILS_HARDWARE_COUNTERS_HPP
+#define ROG_DETAILS_HARDWARE_COUNTERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace rog
+{
+    struct HardwareCounters;
+}
+
+namespace rog::details
+{
+    class CounterGroup;
+
+    /**
+     *  \brief Counts hardware events of the calling thread from
+     *  construction until \c stop . Counters are opened as a single group
+     *  at the first use on a thread and kept until the thread exits,
+     *  counters that can not be opened stay empty. Where no counter is
+     *  available, e.g. outside Linux, in a container, or with a restrictive
+     *  \c perf_event_paranoid , all counts are empty. Scopes do not nest,
+     *  an inner scope counts nothing.
+     */
+    class HardwareCounterScope
+    {
+    public:
+        /**
+         *  \brief Starts counting if \p enabled .
+         */
+        explicit HardwareCounterScope (bool enabled);
+        HardwareCounterScope (HardwareCounterScope const&) = delete;
+        HardwareCounterScope (HardwareCounterScope&&) = delete;
+
+        /**
+         *  \brief Stops the scope if it was not stopped.
+         */
+        ~HardwareCounterScope ();
+
+        /**
+         *  \brief Stops counting.
+         *  \return Events counted since construction. Counts are scaled
+         *  if the kernel multiplexed the counters.
+         */
+        auto stop () -> HardwareCounters;
+
+    private:
+        CounterGroup* group_;
+    };
+
+    /**
+     *  \brief Returns the counters with their names used by reporters,
+     *  e.g. "cache_misses".
+     */
+    auto counter_fields (HardwareCounters const& counters)
+        -> std::array<std::pair<std::string_view, std::optional<std::uint64_t>>, 4>;
+}
+
+#endif
@@ -0,0 +1,418 @@
+#include <librog/details/isolated_runner.hpp>
+
+#include <librog/rog.hpp>
+#include <librog/details/remote_units.hpp>
+#include <librog/details/run_context.hpp>
+#include <librog/details/serialization.hpp>
+#include <librog/details/watchdog.hpp>
+#include <librog/details/worker_protocol.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace rog::details
+{
+#if defined(__APPLE__) || defined(__linux__)
+
+    namespace
+    {
+        // Worker that crashes outside of a test is given up after this.
+        constexpr auto MaxAttempts = 3u;
+
+        struct Worker
+        {
+            pid_t pid_;
+            int fd_;
+            std::string buffer_;
+            group_t batch_;
+            std::vector<bool> finished_;
+            std::optional<std::size_t> current_;
+            std::chrono::steady_clock::time_point started_;
+            bool timedOut_;
+            bool stopped_;
+        };
+
+        [[noreturn]] auto run_worker
+            ( int const           fd
+            , RemoteUnits&        units
+            , group_t const&      batch
+            , RunContext const&   parent ) -> void
+        {
+            // Events are reported and the run is cancelled
+            // by the parent process.
+            auto settings = *parent.settings_;
+            settings.listeners_.clear();
+            auto context = parent;
+            context.settings_ = &settings;
+            context.cancel_ = nullptr;
+
+            auto payload = ByteWriter();
+            for (auto const u : batch)
+            {
+                write_all(fd, make_frame(FrameType::Started, u, {}));
+                units.run(u, context);
+                payload.clear();
+                units.write_state(u, payload);
+                write_all(fd, make_frame(FrameType::Finished, u, payload.bytes()));
+            }
+
+            std::cout.flush();
+            std::fflush(nullptr);
+            ::_exit(0);
+        }
+
+        class IsolatedRunner
+        {
+        public:
+            IsolatedRunner (Test& root, RunContext& context) :
+                context_ (&context),
+                workerCount_ (context.settings_->processCount_),
+                units_ (root, context)
+            {
+                queue_ = units_.groups();
+                attempts_.resize(units_.size(), 0);
+                for (auto const& g : queue_)
+                {
+                    remaining_ += g.size();
+                }
+            }
+
+            auto run () -> void
+            {
+                while (not queue_.empty() || not workers_.empty())
+                {
+                    if (units_.is_cancelled())
+                    {
+                        queue_.clear();
+                    }
+
+                    while (workers_.size() < workerCount_ && not queue_.empty())
+                    {
+                        this->spawn(this->next_batch());
+                    }
+
+                    if (not workers_.empty())
+                    {
+                        this->poll_workers();
+                    }
+                }
+
+                units_.run_benchmarks();
+            }
+
+            auto finish (Test& root) -> void
+            {
+                units_.finish(root);
+            }
+
+        private:
+            auto next_batch () -> group_t
+            {
+                auto const target = std::max(
+                    std::size_t {1},
+                    remaining_ / (std::size_t {4} * workerCount_)
+                );
+                auto batch = group_t();
+                while (not queue_.empty() && batch.size() < target)
+                {
+                    auto& g = queue_.front();
+                    batch.insert(batch.end(), g.begin(), g.end());
+                    queue_.pop_front();
+                }
+                return batch;
+            }
+
+            auto spawn (group_t batch) -> void
+            {
+                int fds[2];
+                if (::pipe(fds) != 0)
+                {
+                    this->run_in_process(batch);
+                    return;
+                }
+
+                std::cout.flush();
+                std::fflush(nullptr);
+
+                auto const pid = ::fork();
+                if (pid < 0)
+                {
+                    ::close(fds[0]);
+                    ::close(fds[1]);
+                    this->run_in_process(batch);
+                    return;
+                }
+
+                if (pid == 0)
+                {
+                    ::close(fds[0]);
+                    for (auto const& w : workers_)
+                    {
+                        ::close(w.fd_);
+                    }
+                    run_worker(fds[1], units_, batch, *context_);
+                }
+
+                ::close(fds[1]);
+                auto const size = batch.size();
+                workers_.emplace_back(Worker {
+                    pid,
+                    fds[0],
+                    {},
+                    std::move(batch),
+                    std::vector<bool>(size, false),
+                    std::nullopt,
+                    {},
+                    false,
+                    false
+                });
+            }
+
+            auto run_in_process (group_t const& batch) -> void
+            {
+                for (auto const u : batch)
+                {
+                    units_.run(u, *context_);
+                    --remaining_;
+                }
+            }
+
+            auto poll_workers () -> void
+            {
+                auto pfds = std::vector<pollfd>();
+                for (auto const& w : workers_)
+                {
+                    pfds.emplace_back(pollfd {w.fd_, POLLIN, 0});
+                }
+
+                auto const ready = ::poll(pfds.data(), pfds.size(), this->poll_timeout());
+                this->kill_timed_out();
+                if (ready <= 0)
+                {
+                    return;
+                }
+
+                char chunk[1 << 16];
+                auto closed = std::vector<std::size_t>();
+                for (auto i = std::size_t {0}; i < pfds.size(); ++i)
+                {
+                    if (pfds[i].revents == 0)
+                    {
+                        continue;
+                    }
+
+                    auto& w = workers_[i];
+                    auto const n = ::read(w.fd_, chunk, sizeof(chunk));
+                    if (n < 0 && errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    if (n <= 0)
+                    {
+                        closed.emplace_back(i);
+                        continue;
+                    }
+
+                    w.buffer_.append(chunk, static_cast<std::size_t>(n));
+                    this->process_frames(w);
+                }
+
+                for (auto const i : closed | std::views::reverse)
+                {
+                    this->reap(workers_[i]);
+                    workers_.erase(workers_.begin() + static_cast<long>(i));
+                }
+            }
+
+            auto process_frames (Worker& w) -> void
+            {
+                auto consumed = std::size_t {0};
+                while (auto const frame = next_frame(w.buffer_, consumed))
+                {
+                    auto const unit = frame->unit_;
+                    if (unit >= units_.size() || w.stopped_)
+                    {
+                        continue;
+                    }
+
+                    if (frame->type_ == FrameType::Started)
+                    {
+                        w.current_ = unit;
+                        w.started_ = std::chrono::steady_clock::now();
+                        units_.notify_started(unit);
+                    }
+                    else if (frame->type_ == FrameType::Finished)
+                    {
+                        auto in = ByteReader(frame->payload_);
+                        units_.read_state(unit, in);
+                        this->mark_finished(w, unit);
+                        units_.notify_finished(unit);
+                        if (units_.is_cancelled())
+                        {
+                            // The rest of the batch is not evaluated.
+                            ::kill(w.pid_, SIGKILL);
+                            w.stopped_ = true;
+                        }
+                    }
+                }
+                w.buffer_.erase(0, consumed);
+            }
+
+            auto reap (Worker& w) -> void
+            {
+                ::close(w.fd_);
+                auto status = 0;
+                while (::waitpid(w.pid_, &status, 0) < 0 && errno == EINTR)
+                {
+                }
+
+                auto const crashed =
+                    not WIFEXITED(status) || WEXITSTATUS(status) != 0;
+                if (w.current_)
+                {
+                    auto const unit = *w.current_;
+                    auto const elapsed =
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - w.started_
+                        );
+                    units_.fail(
+                        unit,
+                        w.timedOut_ ? timeout_message(elapsed, units_.timeout(unit)) :
+                        crashed     ? describe_exit(status) :
+                                      "Worker exited during the test"
+                    );
+                    units_.set_wall_time(unit, elapsed);
+                    this->mark_finished(w, unit);
+                    units_.notify_finished(unit);
+                }
+
+                auto retry = group_t();
+                for (auto i = std::size_t {0}; i < w.batch_.size(); ++i)
+                {
+                    auto const u = w.batch_[i];
+                    if (w.finished_[i] || units_.is_cancelled())
+                    {
+                        continue;
+                    }
+
+                    if (++attempts_[u] >= MaxAttempts)
+                    {
+                        units_.fail(u, describe_exit(status));
+                        --remaining_;
+                        units_.notify_finished(u);
+                    }
+                    else
+                    {
+                        retry.emplace_back(u);
+                    }
+                }
+
+                if (not retry.empty())
+                {
+                    queue_.emplace_front(std::move(retry));
+                }
+            }
+
+            /**
+             *  \brief Returns milliseconds until the nearest time limit
+             *  of a running leaf, -1 if there is none.
+             */
+            auto poll_timeout () const -> int
+            {
+                auto const now = std::chrono::steady_clock::now();
+                auto timeout = -1;
+                for (auto const& w : workers_)
+                {
+                    auto const limit = w.current_
+                        ? units_.timeout(*w.current_)
+                        : std::chrono::nanoseconds::zero();
+                    if (limit <= std::chrono::nanoseconds::zero() || w.timedOut_)
+                    {
+                        continue;
+                    }
+
+                    auto const left = std::chrono::ceil<std::chrono::milliseconds>(
+                        w.started_ + limit - now
+                    );
+                    auto const ms = left.count() > 0 ? static_cast<int>(left.count()) : 0;
+                    timeout = timeout < 0 ? ms : std::min(timeout, ms);
+                }
+                return timeout;
+            }
+
+            auto kill_timed_out () -> void
+            {
+                auto const now = std::chrono::steady_clock::now();
+                for (auto& w : workers_)
+                {
+                    auto const limit = w.current_
+                        ? units_.timeout(*w.current_)
+                        : std::chrono::nanoseconds::zero();
+                    if (limit > std::chrono::nanoseconds::zero()
+                     && not w.timedOut_
+                     && now - w.started_ >= limit)
+                    {
+                        // Closed pipe makes the worker reaped.
+                        ::kill(w.pid_, SIGKILL);
+                        w.timedOut_ = true;
+                    }
+                }
+            }
+
+            auto mark_finished (Worker& w, std::size_t const unit) -> void
+            {
+                auto const it = std::ranges::find(w.batch_, unit);
+                if (it != w.batch_.end())
+                {
+                    w.finished_[static_cast<std::size_t>(it - w.batch_.begin())] = true;
+                    --remaining_;
+                }
+                w.current_.reset();
+            }
+
+        private:
+            RunContext* context_;
+            std::size_t workerCount_;
+            RemoteUnits units_;
+            std::deque<group_t> queue_;
+            std::vector<unsigned int> attempts_;
+            std::vector<Worker> workers_;
+            std::size_t remaining_ {0};
+        };
+    }
+
+    auto run_isolated
+        (Test& root, RunContext& context) -> void
+    {
+        auto runner = IsolatedRunner(root, context);
+        runner.run();
+        runner.finish(root);
+    }
+
+#else
+
+    auto run_isolated
+        (Test& root, RunContext& context) -> void
+    {
+        root.run(context);
+    }
+
+#endif
+}
@@ -0,0 +1,27 @@
+#ifndef ROG_DETAILS_ISOLATED_RUNNER_HPP
+#define ROG_DETAILS_ISOLATED_RUNNER_HPP
+
+namespace rog
+{
+    class Test;
+}
+
+namespace rog::details
+{
+    struct RunContext;
+
+    /**
+     *  \brief Runs leaves of \p root in forked worker processes.
+     *
+     *  Each worker runs a batch of leaves and sends their output back
+     *  through a pipe. A leaf that crashes its worker fails with the name
+     *  of the signal, the rest of its batch is scheduled again.
+     *  Falls back to in-process run where fork is not available.
+     *
+     *  \param root root of the test hierarchy.
+     *  \param context state shared by all tests of the run.
+     */
+    auto run_isolated (Test& root, RunContext& context) -> void;
+}
+
+#endif
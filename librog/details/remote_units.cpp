@@ -0,0 +1,435 @@
+#include <librog/details/remote_units.hpp>
+
+#include <librog/benchmark.hpp>
+#include <librog/rog.hpp>
+#include <librog/details/cancellation.hpp>
+#include <librog/details/run_context.hpp>
+#include <librog/details/serialization.hpp>
+#include <librog/details/test_access.hpp>
+
+#include <utility>
+
+namespace rog::details
+{
+    namespace
+    {
+        /**
+         *  \brief Collects leaves of the hierarchy. Leaves of a serial
+         *  composite form a single group that is run by one worker.
+         */
+        class UnitCollector : public IVisitor
+        {
+        public:
+            UnitCollector (RunContext const& context) :
+                context_ (&context),
+                limits_ {context.timeout_}
+            {
+            }
+
+            auto visit (LeafTest& t) -> void override
+            {
+                // Leaves that do not get results from the run, e.g. after
+                // cancellation, are not evaluated.
+                TestAccess::clear_results(t);
+                auto path = this->path_of(t);
+                if (not this->filter().selects_leaf(path))
+                {
+                    return;
+                }
+
+                this->add_unit(t, t, std::move(path));
+            }
+
+            auto visit (LazyTest& t) -> void override
+            {
+                TestAccess::clear_results(t);
+                auto path = this->path_of(t);
+                if (not this->filter().selects_leaf(path))
+                {
+                    return;
+                }
+
+                // The leaf is built in the worker, the parent only
+                // receives its results.
+                this->add_unit(t, t.snapshot(), std::move(path));
+                timeouts_.back() = t.timeout().value_or(limits_.back());
+            }
+
+            auto visit (BenchmarkTest& t) -> void override
+            {
+                TestAccess::clear_results(t);
+                auto path = this->path_of(t);
+                if (not this->filter().selects_leaf(path))
+                {
+                    return;
+                }
+
+                benchmarks_.emplace_back(&t);
+                benchmarkPaths_.emplace_back(std::move(path));
+            }
+
+            auto visit (CompositeTest& t) -> void override
+            {
+                auto const path = this->path_of(t);
+                if (not this->filter().selects_composite(path))
+                {
+                    TestAccess::clear_results(t);
+                    return;
+                }
+
+                auto const serial =
+                    t.execution_policy() == ExecutionPolicy::Serial;
+                if (serial && serialDepth_++ == 0)
+                {
+                    groups_.emplace_back();
+                }
+
+                for (auto* l : context_->settings_->listeners_)
+                {
+                    l->on_composite_started(t, path);
+                }
+
+                prefix_.emplace_back(path);
+                limits_.emplace_back(t.timeout().value_or(limits_.back()));
+                for (auto const& st : t.subtests())
+                {
+                    st->accept(*this);
+                }
+                limits_.pop_back();
+                prefix_.pop_back();
+
+                if (serial)
+                {
+                    --serialDepth_;
+                }
+            }
+
+            auto units () -> std::vector<LeafTest*>&
+            {
+                return units_;
+            }
+
+            auto runners () -> std::vector<Test*>&
+            {
+                return runners_;
+            }
+
+            auto paths () -> std::vector<std::string>&
+            {
+                return paths_;
+            }
+
+            auto timeouts () -> std::vector<std::chrono::nanoseconds>&
+            {
+                return timeouts_;
+            }
+
+            auto benchmarks () -> std::vector<BenchmarkTest*>&
+            {
+                return benchmarks_;
+            }
+
+            auto benchmark_paths () -> std::vector<std::string>&
+            {
+                return benchmarkPaths_;
+            }
+
+            auto groups () -> std::deque<group_t>
+            {
+                auto gs = std::deque<group_t>();
+                for (auto& g : groups_)
+                {
+                    if (not g.empty())
+                    {
+                        gs.emplace_back(std::move(g));
+                    }
+                }
+                return gs;
+            }
+
+        private:
+            auto path_of (Test const& t) const -> std::string
+            {
+                if (prefix_.empty())
+                {
+                    return context_->path_;
+                }
+                auto path = prefix_.back();
+                append_path(path, t.name());
+                return path;
+            }
+
+            auto filter () const -> TestFilter const&
+            {
+                return context_->settings_->filter_;
+            }
+
+            auto add_unit
+                (Test& runner, LeafTest& leaf, std::string path) -> void
+            {
+                runners_.emplace_back(&runner);
+                units_.emplace_back(&leaf);
+                paths_.emplace_back(std::move(path));
+                timeouts_.emplace_back(leaf.timeout().value_or(limits_.back()));
+                if (serialDepth_ == 0)
+                {
+                    groups_.emplace_back();
+                }
+                groups_.back().emplace_back(units_.size() - 1);
+            }
+
+        private:
+            RunContext const* context_;
+            std::vector<Test*> runners_;
+            std::vector<LeafTest*> units_;
+            std::vector<std::string> paths_;
+            std::vector<std::chrono::nanoseconds> timeouts_;
+            std::vector<BenchmarkTest*> benchmarks_;
+            std::vector<std::string> benchmarkPaths_;
+            std::vector<group_t> groups_;
+            std::vector<std::string> prefix_;
+            std::vector<std::chrono::nanoseconds> limits_;
+            std::size_t serialDepth_ {0};
+        };
+
+        /**
+         *  \brief Updates summaries of composites bottom-up after their
+         *  leaves were given results from the workers.
+         */
+        class SummaryUpdater : public IVisitor
+        {
+        public:
+            SummaryUpdater (RunContext const& context) :
+                context_ (&context),
+                path_ (context.path_)
+            {
+            }
+
+            auto visit (LeafTest&) -> void override
+            {
+            }
+
+            auto visit (BenchmarkTest&) -> void override
+            {
+            }
+
+            auto visit (LazyTest&) -> void override
+            {
+            }
+
+            auto visit (CompositeTest& t) -> void override
+            {
+                if (not context_->settings_->filter_.selects_composite(path_))
+                {
+                    return;
+                }
+
+                for (auto const& st : t.subtests())
+                {
+                    auto const size = path_.size();
+                    append_path(path_, st->name());
+                    st->accept(*this);
+                    path_.resize(size);
+                }
+                t.update_summary();
+
+                for (auto* l : context_->settings_->listeners_)
+                {
+                    l->on_composite_finished(t, path_);
+                }
+            }
+
+        private:
+            RunContext const* context_;
+            std::string path_;
+        };
+    }
+
+// RemoteUnits:
+
+    RemoteUnits::RemoteUnits
+        (Test& root, RunContext const& context) :
+        context_ (&context)
+    {
+        auto collector = UnitCollector(context);
+        root.accept(collector);
+        runners_ = std::move(collector.runners());
+        units_ = std::move(collector.units());
+        paths_ = std::move(collector.paths());
+        timeouts_ = std::move(collector.timeouts());
+        benchmarks_ = std::move(collector.benchmarks());
+        benchmarkPaths_ = std::move(collector.benchmark_paths());
+        groups_ = collector.groups();
+    }
+
+    auto RemoteUnits::size
+        () const -> std::size_t
+    {
+        return units_.size();
+    }
+
+    auto RemoteUnits::path
+        (std::size_t const unit) const -> std::string const&
+    {
+        return paths_[unit];
+    }
+
+    auto RemoteUnits::timeout
+        (std::size_t const unit) const -> std::chrono::nanoseconds
+    {
+        return timeouts_[unit];
+    }
+
+    auto RemoteUnits::leaf
+        (std::size_t const unit) -> LeafTest&
+    {
+        return *units_[unit];
+    }
+
+    auto RemoteUnits::groups
+        () const -> std::deque<group_t>
+    {
+        return groups_;
+    }
+
+    auto RemoteUnits::find
+        (std::string_view const path) -> std::optional<std::size_t>
+    {
+        if (index_.empty())
+        {
+            for (auto u = std::size_t {0}; u < paths_.size(); ++u)
+            {
+                index_.emplace(paths_[u], u);
+            }
+        }
+
+        auto const it = index_.find(path);
+        return it != index_.end()
+            ? std::optional<std::size_t>(it->second)
+            : std::nullopt;
+    }
+
+    auto RemoteUnits::run
+        (std::size_t const unit, RunContext const& context) -> void
+    {
+        auto c = context;
+        c.path_ = paths_[unit];
+        runners_[unit]->run(c);
+    }
+
+    auto RemoteUnits::write_state
+        (std::size_t const unit, ByteWriter& out) const -> void
+    {
+        write_leaf_state(out, *units_[unit]);
+    }
+
+    auto RemoteUnits::read_state
+        (std::size_t const unit, ByteReader& in) -> void
+    {
+        if (not read_leaf_state(in, *units_[unit]))
+        {
+            this->fail(unit, "Malformed result from worker");
+        }
+    }
+
+    auto RemoteUnits::fail
+        (std::size_t const unit, std::string message) -> void
+    {
+        // Measurements of the failed attempt are partial.
+        auto& messages = TestAccess::messages(*units_[unit]);
+        TestAccess::pass_count(*units_[unit]) = 0;
+        TestAccess::fail_count(*units_[unit]) = 1;
+        TestAccess::keep_result(*units_[unit], TestResult::Fail);
+        TestAccess::allocations(*units_[unit]) = AllocationStats();
+        TestAccess::hardware_counters(*units_[unit]) = HardwareCounters();
+        TestAccess::set_times(*units_[unit], {}, {});
+        messages.clear();
+        messages.emplace_back(
+            TestMessage {TestMessageType::Fail, std::move(message)}
+        );
+    }
+
+    auto RemoteUnits::set_wall_time
+        (std::size_t const unit, std::chrono::nanoseconds const time) -> void
+    {
+        TestAccess::set_times(*units_[unit], time, std::chrono::nanoseconds(0));
+    }
+
+    auto RemoteUnits::notify_started
+        (std::size_t const unit) -> void
+    {
+        for (auto* l : context_->settings_->listeners_)
+        {
+            l->on_test_started(*units_[unit], paths_[unit]);
+        }
+    }
+
+    auto RemoteUnits::notify_finished
+        (std::size_t const unit) -> void
+    {
+        // Lazy tests report times of their snapshots.
+        TestAccess::set_times(
+            *runners_[unit],
+            units_[unit]->wall_time(),
+            units_[unit]->cpu_time()
+        );
+
+        if (context_->cancel_ && units_[unit]->fail_count() > 0)
+        {
+            context_->cancel_->add_failure();
+        }
+
+        auto const& listeners = context_->settings_->listeners_;
+        if (listeners.empty())
+        {
+            return;
+        }
+
+        auto const& test = *units_[unit];
+        for (auto const& m : test.output())
+        {
+            if (m.type_ != TestMessageType::Fail)
+            {
+                continue;
+            }
+            for (auto* l : listeners)
+            {
+                l->on_assertion_failed(test, paths_[unit], m);
+            }
+        }
+
+        for (auto* l : listeners)
+        {
+            l->on_test_finished(test, paths_[unit]);
+        }
+    }
+
+    auto RemoteUnits::is_cancelled
+        () const -> bool
+    {
+        return context_->cancel_ && context_->cancel_->is_cancelled();
+    }
+
+    auto RemoteUnits::run_benchmarks
+        () -> void
+    {
+        if (this->is_cancelled())
+        {
+            return;
+        }
+
+        for (auto i = std::size_t {0}; i < benchmarks_.size(); ++i)
+        {
+            auto context = *context_;
+            context.path_ = benchmarkPaths_[i];
+            benchmarks_[i]->run(context);
+        }
+    }
+
+    auto RemoteUnits::finish
+        (Test& root) -> void
+    {
+        auto updater = SummaryUpdater(*context_);
+        root.accept(updater);
+    }
+}
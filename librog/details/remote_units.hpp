@@ -0,0 +1,134 @@
+#ifndef ROG_DETAILS_REMOTE_UNITS_HPP
+#define ROG_DETAILS_REMOTE_UNITS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace rog
+{
+    class Test;
+    class LeafTest;
+    class BenchmarkTest;
+}
+
+namespace rog::details
+{
+    struct RunContext;
+    class ByteReader;
+    class ByteWriter;
+
+    using group_t = std::vector<std::size_t>;
+
+    /**
+     *  \brief Leaves of a hierarchy that are run by worker processes.
+     *
+     *  Leaves are addressed by their indices, called units. A worker runs
+     *  a unit and serializes its output, the process that owns the run
+     *  restores the output into its copy of the leaf and notifies
+     *  the listeners.
+     */
+    class RemoteUnits
+    {
+    public:
+        /**
+         *  \brief Collects leaves of \p root selected by the filter
+         *  of \p context and notifies the listeners that the selected
+         *  composites started.
+         */
+        RemoteUnits (Test& root, RunContext const& context);
+
+        auto size () const -> std::size_t;
+        auto path (std::size_t unit) const -> std::string const&;
+        auto leaf (std::size_t unit) -> LeafTest&;
+
+        /**
+         *  \brief Returns time limit of \p unit , zero if it has none.
+         */
+        auto timeout (std::size_t unit) const -> std::chrono::nanoseconds;
+
+        /**
+         *  \brief Returns units grouped so that leaves of a serial
+         *  composite form a single group, which must be run by one worker.
+         */
+        auto groups () const -> std::deque<group_t>;
+
+        /**
+         *  \brief Returns the unit at \p path , if there is one.
+         */
+        auto find (std::string_view path) -> std::optional<std::size_t>;
+
+        /**
+         *  \brief Runs \p unit in the calling process.
+         */
+        auto run (std::size_t unit, RunContext const& context) -> void;
+
+        /**
+         *  \brief Serializes output of \p unit after it was run.
+         */
+        auto write_state (std::size_t unit, ByteWriter& out) const -> void;
+
+        /**
+         *  \brief Restores output of \p unit received from a worker.
+         *  If the input is malformed, the unit fails.
+         */
+        auto read_state (std::size_t unit, ByteReader& in) -> void;
+
+        /**
+         *  \brief Replaces output of \p unit by a single failure and clears
+         *  its times, allocations, and hardware counters.
+         */
+        auto fail (std::size_t unit, std::string message) -> void;
+
+        /**
+         *  \brief Sets wall time of \p unit that did not report its output.
+         */
+        auto set_wall_time (std::size_t unit, std::chrono::nanoseconds time)
+            -> void;
+
+        auto notify_started (std::size_t unit) -> void;
+
+        /**
+         *  \brief Notifies the listeners that \p unit finished
+         *  and counts its failure towards cancellation of the run.
+         */
+        auto notify_finished (std::size_t unit) -> void;
+
+        /**
+         *  \brief Returns true if the run was cancelled, the remaining
+         *  units must not be started.
+         */
+        auto is_cancelled () const -> bool;
+
+        /**
+         *  \brief Runs the benchmarks in the calling process unless
+         *  the run was cancelled. They are run after the leaves, which
+         *  would disturb them.
+         */
+        auto run_benchmarks () -> void;
+
+        /**
+         *  \brief Updates summaries of composites of \p root bottom-up
+         *  and notifies the listeners that they finished.
+         */
+        auto finish (Test& root) -> void;
+
+    private:
+        RunContext const* context_;
+        std::vector<Test*> runners_;
+        std::vector<LeafTest*> units_;
+        std::vector<std::string> paths_;
+        std::vector<std::chrono::nanoseconds> timeouts_;
+        std::vector<BenchmarkTest*> benchmarks_;
+        std::vector<std::string> benchmarkPaths_;
+        std::deque<group_t> groups_;
+        std::unordered_map<std::string_view, std::size_t> index_;
+    };
+}
+
+#endif
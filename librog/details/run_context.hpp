@@ -0,0 +1,82 @@
+#ifndef ROG_DETAILS_RUN_CONTEXT_HPP
+#define ROG_DETAILS_RUN_CONTEXT_HPP
+
+#include <chrono>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+
+namespace rog
+{
+    struct RunSettings;
+}
+
+namespace rog::details
+{
+    class CancellationToken;
+    class ThreadPool;
+    class Watchdog;
+
+    /**
+     *  \brief State of a single run passed down the hierarchy.
+     *  Everything except the path and the time limit is shared by all
+     *  tests of the run.
+     */
+    struct RunContext
+    {
+        RunSettings const* settings_;
+        ThreadPool* pool_;
+        std::string path_;
+
+        /**
+         *  \brief Time limit of leaves that do not have their own.
+         *  Zero means no limit.
+         */
+        std::chrono::nanoseconds timeout_ {0};
+
+        /**
+         *  \brief Enforces the time limits of in-process runs.
+         */
+        Watchdog* watchdog_ {nullptr};
+
+        /**
+         *  \brief Stops the run after too many failures.
+         */
+        CancellationToken* cancel_ {nullptr};
+    };
+
+    /**
+     *  \brief Appends \p name of a subtest to \p path of its parent.
+     *  Paths of subtests of a test with an empty name do not start
+     *  with '/'.
+     */
+    inline auto append_path (std::string& path, std::string_view name) -> void
+    {
+        path.reserve(path.size() + 1 + name.size());
+        if (not path.empty())
+        {
+            path += '/';
+        }
+        path += name;
+    }
+
+    /**
+     *  \brief Creates context for a subtest named \p name .
+     */
+    inline auto subtest_context
+        (RunContext const& parent, std::string_view name) -> RunContext
+    {
+        auto context = parent;
+        append_path(context.path_, name);
+        return context;
+    }
+
+    /**
+     *  \brief Locks listener events of the run of \p context against
+     *  an abort by its watchdog. Does not lock anything if the run has
+     *  no watchdog. The lock must not be held when taking it again.
+     */
+    auto lock_events (RunContext const& context) -> std::shared_lock<std::shared_mutex>;
+}
+
+#endif
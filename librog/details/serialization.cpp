@@ -0,0 +1,209 @@
+#include <librog/details/serialization.hpp>
+
+#include <librog/rog.hpp>
+#include <librog/details/test_access.hpp>
+
+#include <initializer_list>
+
+namespace rog::details
+{
+// ByteWriter:
+
+    auto ByteWriter::u8
+        (std::uint8_t const x) -> void
+    {
+        buffer_.push_back(static_cast<char>(x));
+    }
+
+    auto ByteWriter::u32
+        (std::uint32_t const x) -> void
+    {
+        for (auto i = 0u; i < 4; ++i)
+        {
+            this->u8(static_cast<std::uint8_t>(x >> (8 * i)));
+        }
+    }
+
+    auto ByteWriter::u64
+        (std::uint64_t const x) -> void
+    {
+        for (auto i = 0u; i < 8; ++i)
+        {
+            this->u8(static_cast<std::uint8_t>(x >> (8 * i)));
+        }
+    }
+
+    auto ByteWriter::string
+        (std::string_view const s) -> void
+    {
+        this->u32(static_cast<std::uint32_t>(s.size()));
+        buffer_.append(s);
+    }
+
+    auto ByteWriter::bytes
+        () const -> std::string const&
+    {
+        return buffer_;
+    }
+
+    auto ByteWriter::clear
+        () -> void
+    {
+        buffer_.clear();
+    }
+
+// ByteReader:
+
+    ByteReader::ByteReader
+        (std::string_view const data) :
+        data_ (data),
+        pos_ (0),
+        failed_ (false)
+    {
+    }
+
+    auto ByteReader::u8
+        () -> std::uint8_t
+    {
+        auto const s = this->take(1);
+        return s.empty() ? 0 : static_cast<std::uint8_t>(s[0]);
+    }
+
+    auto ByteReader::u32
+        () -> std::uint32_t
+    {
+        auto x = std::uint32_t {0};
+        for (auto i = 0u; i < 4; ++i)
+        {
+            x |= static_cast<std::uint32_t>(this->u8()) << (8 * i);
+        }
+        return x;
+    }
+
+    auto ByteReader::u64
+        () -> std::uint64_t
+    {
+        auto x = std::uint64_t {0};
+        for (auto i = 0u; i < 8; ++i)
+        {
+            x |= static_cast<std::uint64_t>(this->u8()) << (8 * i);
+        }
+        return x;
+    }
+
+    auto ByteReader::string
+        () -> std::string
+    {
+        auto const size = this->u32();
+        return std::string(this->take(size));
+    }
+
+    auto ByteReader::failed
+        () const -> bool
+    {
+        return failed_;
+    }
+
+    auto ByteReader::consumed
+        () const -> std::size_t
+    {
+        return pos_;
+    }
+
+    auto ByteReader::take
+        (std::size_t const n) -> std::string_view
+    {
+        if (failed_ || data_.size() - pos_ < n)
+        {
+            failed_ = true;
+            return {};
+        }
+        auto const s = data_.substr(pos_, n);
+        pos_ += n;
+        return s;
+    }
+
+// Free functions:
+
+    auto write_leaf_state
+        (ByteWriter& out, LeafTest const& test) -> void
+    {
+        out.u64(static_cast<std::uint64_t>(test.wall_time().count()));
+        out.u64(static_cast<std::uint64_t>(test.cpu_time().count()));
+        out.u8(static_cast<std::uint8_t>(test.result()));
+        out.u64(test.pass_count());
+        out.u64(test.fail_count());
+        auto const& allocations = test.allocations();
+        out.u64(allocations.count_);
+        out.u64(allocations.bytes_);
+        out.u64(allocations.peakBytes_);
+        out.u64(static_cast<std::uint64_t>(allocations.leakedCount_));
+        out.u64(static_cast<std::uint64_t>(allocations.leakedBytes_));
+        for (auto const& [name, value] : counter_fields(test.hardware_counters()))
+        {
+            out.u8(value.has_value());
+            out.u64(value.value_or(0));
+        }
+        auto const& messages = test.output();
+        out.u32(static_cast<std::uint32_t>(messages.size()));
+        for (auto const& m : messages)
+        {
+            out.u8(static_cast<std::uint8_t>(m.type_));
+            out.string(m.text_);
+        }
+    }
+
+    auto read_leaf_state
+        (ByteReader& in, LeafTest& test) -> bool
+    {
+        auto const wall = std::chrono::nanoseconds(
+            static_cast<std::chrono::nanoseconds::rep>(in.u64())
+        );
+        auto const cpu = std::chrono::nanoseconds(
+            static_cast<std::chrono::nanoseconds::rep>(in.u64())
+        );
+        auto const result = in.u8();
+        auto const passCount = in.u64();
+        auto const failCount = in.u64();
+        auto allocations = AllocationStats();
+        allocations.count_ = in.u64();
+        allocations.bytes_ = in.u64();
+        allocations.peakBytes_ = in.u64();
+        allocations.leakedCount_ = static_cast<std::int64_t>(in.u64());
+        allocations.leakedBytes_ = static_cast<std::int64_t>(in.u64());
+        auto counters = HardwareCounters();
+        for (auto* const counter : { &counters.cycles_
+                                   , &counters.instructions_
+                                   , &counters.cacheMisses_
+                                   , &counters.branchMisses_ })
+        {
+            auto const has = in.u8() != 0;
+            auto const value = in.u64();
+            if (has)
+            {
+                *counter = value;
+            }
+        }
+        auto messages = std::vector<TestMessage>();
+        auto const count = in.u32();
+        for (auto i = 0u; i < count && not in.failed(); ++i)
+        {
+            auto const type = static_cast<TestMessageType>(in.u8());
+            messages.emplace_back(TestMessage {type, in.string()});
+        }
+
+        if (in.failed() || result > static_cast<std::uint8_t>(TestResult::NotEvaluated))
+        {
+            return false;
+        }
+
+        TestAccess::messages(test) = std::move(messages);
+        TestAccess::pass_count(test) = passCount;
+        TestAccess::fail_count(test) = failCount;
+        TestAccess::keep_result(test, static_cast<TestResult>(result));
+        TestAccess::allocations(test) = allocations;
+        TestAccess::hardware_counters(test) = counters;
+        TestAccess::set_times(test, wall, cpu);
+        return true;
+    }
+}
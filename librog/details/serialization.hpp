@@ -0,0 +1,71 @@
+#ifndef ROG_DETAILS_SERIALIZATION_HPP
+#define ROG_DETAILS_SERIALIZATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace rog
+{
+    class LeafTest;
+}
+
+namespace rog::details
+{
+    /**
+     *  \brief Appends primitive values to a byte buffer.
+     *  Integers are stored in little-endian order.
+     */
+    class ByteWriter
+    {
+    public:
+        auto u8 (std::uint8_t) -> void;
+        auto u32 (std::uint32_t) -> void;
+        auto u64 (std::uint64_t) -> void;
+        auto string (std::string_view) -> void;
+        auto bytes () const -> std::string const&;
+        auto clear () -> void;
+
+    private:
+        std::string buffer_;
+    };
+
+    /**
+     *  \brief Reads values written by \c ByteWriter .
+     *  Reading past the end sets the fail flag and yields zeros.
+     */
+    class ByteReader
+    {
+    public:
+        explicit ByteReader (std::string_view);
+        auto u8 () -> std::uint8_t;
+        auto u32 () -> std::uint32_t;
+        auto u64 () -> std::uint64_t;
+        auto string () -> std::string;
+        auto failed () const -> bool;
+        auto consumed () const -> std::size_t;
+
+    private:
+        auto take (std::size_t) -> std::string_view;
+
+    private:
+        std::string_view data_;
+        std::size_t pos_;
+        bool failed_;
+    };
+
+    /**
+     *  \brief Serializes output of \p test .
+     */
+    auto write_leaf_state (ByteWriter& out, LeafTest const& test) -> void;
+
+    /**
+     *  \brief Restores output of \p test previously written by
+     *  \c write_leaf_state .
+     *  \return false if the input is malformed.
+     */
+    auto read_leaf_state (ByteReader& in, LeafTest& test) -> bool;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef ROG_DETAILS_TEST_ACCESS_HPP
+#define ROG_DETAILS_TEST_ACCESS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace rog
+{
+    class Test;
+    class LeafTest;
+    class CompositeTest;
+    class BenchmarkTest;
+    enum class TestResult;
+    struct TestMessage;
+    struct AllocationStats;
+    struct HardwareCounters;
+}
+
+namespace rog::details
+{
+    /**
+     *  \brief Gives runners access to the state of tests
+     *  that were run elsewhere, e.g. in a worker process.
+     */
+    struct TestAccess
+    {
+        static auto set_times (
+            Test& t,
+            std::chrono::nanoseconds wall,
+            std::chrono::nanoseconds cpu
+        ) -> void;
+        static auto messages (LeafTest& t) -> std::vector<TestMessage>&;
+        static auto pass_count (LeafTest& t) -> std::size_t&;
+        static auto fail_count (LeafTest& t) -> std::size_t&;
+        static auto allocations (LeafTest& t) -> AllocationStats&;
+        static auto hardware_counters (Test& t) -> HardwareCounters&;
+        static auto evaluated (BenchmarkTest& t) -> bool&;
+
+        /**
+         *  \brief Sets \p result of \p t if it is the snapshot of a leaf
+         *  that ran elsewhere, whose messages may be incomplete. Nothing
+         *  derives the result from the messages again. Other leaves
+         *  are not changed.
+         */
+        static auto keep_result (LeafTest& t, std::optional<TestResult> result) -> void;
+        static auto subtest_finished (CompositeTest& t, Test const& subtest) -> void;
+
+        /**
+         *  \brief Clears results of \p t and of all its subtests,
+         *  so that they are not evaluated.
+         */
+        static auto clear_results (Test& t) -> void;
+    };
+}
+
+#endif
@@ -0,0 +1,261 @@
+#include <librog/details/thread_pool.hpp>
+
+#include <utility>
+
+namespace rog::details
+{
+    namespace
+    {
+        struct WorkerIdentity
+        {
+            ThreadPool const* pool_ {nullptr};
+            std::size_t index_ {0};
+        };
+
+        thread_local auto currentWorker = WorkerIdentity();
+    }
+
+// ThreadPool:
+
+    ThreadPool::ThreadPool
+        (unsigned int const threadCount) :
+        queued_ (0),
+        stop_ (false)
+    {
+        for (auto i = 0u; i <= threadCount; ++i)
+        {
+            queues_.emplace_back(std::make_unique<Queue>());
+        }
+
+        for (auto i = std::size_t {0}; i < threadCount; ++i)
+        {
+            threads_.emplace_back([this, i]()
+            {
+                this->worker_loop(i);
+            });
+        }
+    }
+
+    ThreadPool::~ThreadPool
+        ()
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>(sleepMutex_);
+            stop_ = true;
+        }
+        wakeup_.notify_all();
+
+        for (auto& t : threads_)
+        {
+            t.join();
+        }
+    }
+
+    auto ThreadPool::submit
+        (task_t task) -> void
+    {
+        auto const index = currentWorker.pool_ == this
+            ? currentWorker.index_
+            : queues_.size() - 1;
+
+        {
+            auto& queue = *queues_[index];
+            auto lock = std::lock_guard<std::mutex>(queue.mutex_);
+            queue.tasks_.emplace_back(std::move(task));
+            queued_.fetch_add(1, std::memory_order_release);
+        }
+
+        {
+            auto lock = std::lock_guard<std::mutex>(sleepMutex_);
+        }
+        wakeup_.notify_one();
+    }
+
+    auto ThreadPool::run_pending_task
+        () -> bool
+    {
+        auto task = task_t();
+        if (not this->try_pop(task))
+        {
+            return false;
+        }
+        task();
+        return true;
+    }
+
+    auto ThreadPool::wait_for_work
+        (std::function<bool()> const& done) -> void
+    {
+        auto lock = std::unique_lock<std::mutex>(sleepMutex_);
+        wakeup_.wait(lock, [this, &done]()
+        {
+            return done() or queued_.load(std::memory_order_acquire) > 0;
+        });
+    }
+
+    auto ThreadPool::notify_all
+        () -> void
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>(sleepMutex_);
+        }
+        wakeup_.notify_all();
+    }
+
+    auto ThreadPool::worker_loop
+        (std::size_t const index) -> void
+    {
+        currentWorker = WorkerIdentity {this, index};
+        for (;;)
+        {
+            if (this->run_pending_task())
+            {
+                continue;
+            }
+
+            auto lock = std::unique_lock<std::mutex>(sleepMutex_);
+            wakeup_.wait(lock, [this]()
+            {
+                return stop_ or queued_.load(std::memory_order_acquire) > 0;
+            });
+
+            if (stop_ and queued_.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+        }
+    }
+
+    auto ThreadPool::try_pop
+        (task_t& task) -> bool
+    {
+        if (queued_.load(std::memory_order_acquire) == 0)
+        {
+            return false;
+        }
+
+        auto const queueCount = queues_.size();
+        auto const isWorker = currentWorker.pool_ == this;
+        auto const self = isWorker ? currentWorker.index_ : queueCount - 1;
+
+        if (isWorker and this->pop_back(*queues_[self], task))
+        {
+            return true;
+        }
+
+        if (this->pop_front(*queues_[queueCount - 1], task))
+        {
+            return true;
+        }
+
+        for (auto i = std::size_t {1}; i < queueCount; ++i)
+        {
+            auto const victim = (self + i) % queueCount;
+            if (this->pop_front(*queues_[victim], task))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    auto ThreadPool::pop_back
+        (Queue& queue, task_t& task) -> bool
+    {
+        auto lock = std::lock_guard<std::mutex>(queue.mutex_);
+        if (queue.tasks_.empty())
+        {
+            return false;
+        }
+        task = std::move(queue.tasks_.back());
+        queue.tasks_.pop_back();
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    auto ThreadPool::pop_front
+        (Queue& queue, task_t& task) -> bool
+    {
+        auto lock = std::lock_guard<std::mutex>(queue.mutex_);
+        if (queue.tasks_.empty())
+        {
+            return false;
+        }
+        task = std::move(queue.tasks_.front());
+        queue.tasks_.pop_front();
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+// TaskGroup:
+
+    TaskGroup::TaskGroup
+        (ThreadPool& pool) :
+        pool_ (&pool),
+        pending_ (0)
+    {
+    }
+
+    TaskGroup::~TaskGroup
+        ()
+    {
+        try
+        {
+            this->wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    auto TaskGroup::run
+        (ThreadPool::task_t task) -> void
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        pool_->submit([this, pool = pool_, t = std::move(task)]()
+        {
+            try
+            {
+                t();
+            }
+            catch (...)
+            {
+                auto lock = std::lock_guard<std::mutex>(errorMutex_);
+                if (not error_)
+                {
+                    error_ = std::current_exception();
+                }
+            }
+
+            // The group may be destroyed as soon as pending_ drops to zero.
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                pool->notify_all();
+            }
+        });
+    }
+
+    auto TaskGroup::wait
+        () -> void
+    {
+        auto const done = [this]()
+        {
+            return pending_.load(std::memory_order_acquire) == 0;
+        };
+
+        while (not done())
+        {
+            if (not pool_->run_pending_task())
+            {
+                pool_->wait_for_work(done);
+            }
+        }
+
+        auto lock = std::lock_guard<std::mutex>(errorMutex_);
+        if (error_)
+        {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+}
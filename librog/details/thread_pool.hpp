@@ -0,0 +1,136 @@
+#ifndef ROG_DETAILS_THREAD_POOL_HPP
+#define ROG_DETAILS_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rog::details
+{
+    /**
+     *  \brief Work-stealing thread pool.
+     *
+     *  Each worker owns a queue. Tasks submitted from a worker go to its own
+     *  queue and are taken from the back (LIFO), idle workers steal from the
+     *  front of other queues. Tasks submitted from other threads go to
+     *  a shared injection queue.
+     */
+    class ThreadPool
+    {
+    public:
+        using task_t = std::function<void()>;
+
+    public:
+        /**
+         *  \brief Starts \p threadCount worker threads.
+         *  \param threadCount number of workers.
+         */
+        explicit ThreadPool (unsigned int threadCount);
+
+        ThreadPool (ThreadPool const&) = delete;
+        ThreadPool (ThreadPool&&) = delete;
+
+        /**
+         *  \brief Waits for all workers to finish.
+         */
+        ~ThreadPool ();
+
+        /**
+         *  \brief Schedules \p task for execution.
+         *  \param task task to be executed.
+         */
+        auto submit (task_t task) -> void;
+
+        /**
+         *  \brief Executes one queued task on the calling thread if there
+         *  is any.
+         *  \return true if a task was executed, false otherwise.
+         */
+        auto run_pending_task () -> bool;
+
+        /**
+         *  \brief Blocks until \p done returns true or there is a queued
+         *  task that the calling thread can help with.
+         *  \param done predicate checked under the internal lock.
+         */
+        auto wait_for_work (std::function<bool()> const& done) -> void;
+
+        /**
+         *  \brief Wakes up all threads blocked in \c wait_for_work .
+         */
+        auto notify_all () -> void;
+
+    private:
+        struct Queue
+        {
+            std::mutex mutex_;
+            std::deque<task_t> tasks_;
+        };
+
+    private:
+        auto worker_loop (std::size_t index) -> void;
+        auto try_pop (task_t& task) -> bool;
+        auto pop_back (Queue& queue, task_t& task) -> bool;
+        auto pop_front (Queue& queue, task_t& task) -> bool;
+
+    private:
+        // Last queue is the injection queue for non-worker threads.
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+        std::atomic<std::size_t> queued_;
+        std::mutex sleepMutex_;
+        std::condition_variable wakeup_;
+        bool stop_;
+    };
+
+    /**
+     *  \brief Group of tasks that can be waited for.
+     *
+     *  Thread that waits for the group executes queued tasks of the pool
+     *  in the meantime so that nested groups can not starve the workers.
+     */
+    class TaskGroup
+    {
+    public:
+        /**
+         *  \brief Initializes empty group that uses \p pool .
+         *  \param pool pool that executes the tasks.
+         */
+        explicit TaskGroup (ThreadPool& pool);
+
+        TaskGroup (TaskGroup const&) = delete;
+        TaskGroup (TaskGroup&&) = delete;
+
+        /**
+         *  \brief Waits for unfinished tasks.
+         */
+        ~TaskGroup ();
+
+        /**
+         *  \brief Schedules \p task as part of this group.
+         *  \param task task to be executed.
+         */
+        auto run (ThreadPool::task_t task) -> void;
+
+        /**
+         *  \brief Waits until all tasks of the group are finished.
+         *  Rethrows the first exception thrown by a task.
+         */
+        auto wait () -> void;
+
+    private:
+        ThreadPool* pool_;
+        std::atomic<std::size_t> pending_;
+        std::mutex errorMutex_;
+        std::exception_ptr error_;
+    };
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include <librog/details/timing.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#elif defined(__APPLE__) || defined(__linux__)
+#include <time.h>
+#endif
+
+namespace rog::details
+{
+    namespace
+    {
+        auto slower (SlowestLeaves::Entry const& l, SlowestLeaves::Entry const& r)
+            -> bool
+        {
+            // Min-heap, the fastest of the kept entries is on the top.
+            return l.time_ > r.time_;
+        }
+    }
+
+    auto thread_cpu_time
+        () -> std::chrono::nanoseconds
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        FILETIME creation, exit, kernel, user;
+        if (not GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+        {
+            return std::chrono::nanoseconds(0);
+        }
+        auto const ticks = [](FILETIME const& t)
+        {
+            return (static_cast<long long>(t.dwHighDateTime) << 32)
+                 | static_cast<long long>(t.dwLowDateTime);
+        };
+        // FILETIME counts 100 ns intervals.
+        return std::chrono::nanoseconds(100 * (ticks(kernel) + ticks(user)));
+#elif defined(__APPLE__) || defined(__linux__)
+        auto ts = timespec();
+        if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+        {
+            return std::chrono::nanoseconds(0);
+        }
+        return std::chrono::seconds(ts.tv_sec)
+             + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+        return std::chrono::nanoseconds(0);
+#endif
+    }
+
+    auto format_duration
+        (std::chrono::nanoseconds const d) -> std::string
+    {
+        return format_duration(
+            std::chrono::duration<double, std::nano>(d)
+        );
+    }
+
+    auto format_duration
+        (std::chrono::duration<double, std::nano> const d) -> std::string
+    {
+        auto const ns = d.count();
+        char buffer[32];
+        if (ns < 1e3)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%.0f ns", ns);
+        }
+        else if (ns < 1e6)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%.3f us", ns / 1e3);
+        }
+        else if (ns < 1e9)
+        {
+            std::snprintf(buffer, sizeof(buffer), "%.3f ms", ns / 1e6);
+        }
+        else
+        {
+            std::snprintf(buffer, sizeof(buffer), "%.3f s", ns / 1e9);
+        }
+        return buffer;
+    }
+
+    auto format_rate
+        (double const perSecond, std::string_view const unit) -> std::string
+    {
+        constexpr char const* prefixes[] {"", " k", " M", " G", " T"};
+        auto value = perSecond;
+        auto i = std::size_t {0};
+        while (value >= 1000.0 && i + 1 < std::size(prefixes))
+        {
+            value /= 1000.0;
+            ++i;
+        }
+
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.3f%s", value, prefixes[i]);
+        auto str = std::string(buffer);
+        str += ' ';
+        str += unit;
+        str += "/s";
+        return str;
+    }
+
+// SlowestLeaves:
+
+    SlowestLeaves::SlowestLeaves
+        (std::size_t const n) :
+        n_ (n)
+    {
+    }
+
+    auto SlowestLeaves::add
+        (std::chrono::nanoseconds const time, std::string_view const path) -> void
+    {
+        if (n_ == 0)
+        {
+            return;
+        }
+
+        if (heap_.size() < n_)
+        {
+            heap_.emplace_back(Entry {time, std::string(path)});
+            std::ranges::push_heap(heap_, slower);
+        }
+        else if (time > heap_.front().time_)
+        {
+            std::ranges::pop_heap(heap_, slower);
+            heap_.back() = Entry {time, std::string(path)};
+            std::ranges::push_heap(heap_, slower);
+        }
+    }
+
+    auto SlowestLeaves::sorted
+        () const -> std::vector<Entry>
+    {
+        auto entries = heap_;
+        std::ranges::sort(entries, slower);
+        return entries;
+    }
+}
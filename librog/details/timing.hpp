@@ -0,0 +1,63 @@
+#ifndef ROG_DETAILS_TIMING_HPP
+#define ROG_DETAILS_TIMING_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rog::details
+{
+    /**
+     *  \brief Returns CPU time consumed by the calling thread.
+     *  Returns zero where it is not supported.
+     */
+    auto thread_cpu_time () -> std::chrono::nanoseconds;
+
+    /**
+     *  \brief Formats \p d using the largest unit that keeps it above one,
+     *  e.g. 12.345 ms.
+     */
+    auto format_duration (std::chrono::nanoseconds d) -> std::string;
+
+    /**
+     *  \brief Formats \p d using the largest unit that keeps it above one.
+     */
+    auto format_duration (std::chrono::duration<double, std::nano> d)
+        -> std::string;
+
+    /**
+     *  \brief Formats rate \p perSecond of \p unit with a decimal prefix,
+     *  e.g. 1.234 M items/s.
+     */
+    auto format_rate (double perSecond, std::string_view unit) -> std::string;
+
+    /**
+     *  \brief Keeps paths of the \c n slowest leaves seen so far.
+     */
+    class SlowestLeaves
+    {
+    public:
+        struct Entry
+        {
+            std::chrono::nanoseconds time_;
+            std::string path_;
+        };
+
+    public:
+        explicit SlowestLeaves (std::size_t n);
+        auto add (std::chrono::nanoseconds time, std::string_view path) -> void;
+
+        /**
+         *  \brief Returns the kept entries, slowest first.
+         */
+        auto sorted () const -> std::vector<Entry>;
+
+    private:
+        std::size_t n_;
+        std::vector<Entry> heap_;
+    };
+}
+
+#endif
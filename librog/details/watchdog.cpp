@@ -0,0 +1,149 @@
+#include <librog/details/watchdog.hpp>
+
+#include <librog/details/run_context.hpp>
+#include <librog/details/timing.hpp>
+
+namespace rog::details
+{
+    Watchdog::Watchdog
+        (Test const& root) :
+        root_   (&root),
+        nextId_ (0),
+        stop_   (false)
+    {
+    }
+
+    Watchdog::~Watchdog
+        ()
+    {
+        {
+            auto lock = std::lock_guard<std::mutex>(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+
+        if (thread_.joinable())
+        {
+            thread_.join();
+        }
+    }
+
+    auto Watchdog::root
+        () const -> Test const&
+    {
+        return *root_;
+    }
+
+    auto Watchdog::arm
+        (clock_t::time_point const deadline, callback_t onExpired) -> Ticket
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        auto const ticket = Ticket {deadline, nextId_++};
+        auto const key = std::make_pair(deadline, ticket.id_);
+        auto const earliest = deadlines_.empty() || key < deadlines_.begin()->first;
+        deadlines_.emplace(key, std::move(onExpired));
+
+        if (not thread_.joinable())
+        {
+            thread_ = std::thread([this]()
+            {
+                this->loop();
+            });
+        }
+        else if (earliest)
+        {
+            cv_.notify_one();
+        }
+        return ticket;
+    }
+
+    auto Watchdog::disarm
+        (Ticket const ticket) -> void
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex_);
+        deadlines_.erase(std::make_pair(ticket.deadline_, ticket.id_));
+        cv_.wait(lock, [this, ticket]()
+        {
+            return expiring_ != ticket.id_;
+        });
+    }
+
+    auto Watchdog::events
+        () -> std::shared_mutex&
+    {
+        return events_;
+    }
+
+    auto Watchdog::composite_started
+        (CompositeTest& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(openMutex_);
+        open_.emplace(std::make_pair(std::string(path), &t), clock_t::now());
+    }
+
+    auto Watchdog::composite_finished
+        (CompositeTest& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(openMutex_);
+        open_.erase(std::make_pair(std::string(path), &t));
+    }
+
+    auto Watchdog::open_composites
+        () -> std::vector<open_t>
+    {
+        auto lock = std::lock_guard<std::mutex>(openMutex_);
+        auto open = std::vector<open_t>();
+        open.reserve(open_.size());
+        for (auto const& [key, start] : open_)
+        {
+            open.emplace_back(key.first, key.second, start);
+        }
+        return open;
+    }
+
+    auto Watchdog::loop
+        () -> void
+    {
+        auto lock = std::unique_lock<std::mutex>(mutex_);
+        while (not stop_)
+        {
+            if (deadlines_.empty())
+            {
+                cv_.wait(lock);
+                continue;
+            }
+
+            auto const first = deadlines_.begin();
+            if (clock_t::now() < first->first.first)
+            {
+                cv_.wait_until(lock, first->first.first);
+                continue;
+            }
+
+            auto onExpired = std::move(first->second);
+            expiring_ = first->first.second;
+            deadlines_.erase(first);
+            lock.unlock();
+            onExpired();
+            lock.lock();
+            expiring_.reset();
+            cv_.notify_all();
+        }
+    }
+
+    auto lock_events
+        (RunContext const& context) -> std::shared_lock<std::shared_mutex>
+    {
+        return context.watchdog_
+            ? std::shared_lock<std::shared_mutex>(context.watchdog_->events())
+            : std::shared_lock<std::shared_mutex>();
+    }
+
+    auto timeout_message
+        (std::chrono::nanoseconds const elapsed, std::chrono::nanoseconds const limit)
+        -> std::string
+    {
+        return "Timed out after " + format_duration(elapsed)
+             + " (limit " + format_duration(limit) + ")";
+    }
+}
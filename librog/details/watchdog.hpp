@@ -0,0 +1,141 @@
+#ifndef ROG_DETAILS_WATCHDOG_HPP
+#define ROG_DETAILS_WATCHDOG_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rog
+{
+    class Test;
+    class CompositeTest;
+}
+
+namespace rog::details
+{
+    /**
+     *  \brief Calls a callback when a test overruns its time limit.
+     *
+     *  Watches the tests of a single run. The thread is started
+     *  when the first deadline is armed, so runs without time limits
+     *  do not pay for it. Arming and disarming only lock a mutex.
+     *
+     *  Tests notify listeners and update composites under a shared lock
+     *  of the events, see \c lock_events . A callback that aborts the run
+     *  locks them exclusively, so no other thread reports past it, and
+     *  closes the composites that are still running.
+     */
+    class Watchdog
+    {
+    public:
+        using callback_t = std::function<void()>;
+        using clock_t = std::chrono::steady_clock;
+
+        /**
+         *  \brief Path, test, and start of a running composite.
+         */
+        using open_t = std::tuple<std::string, CompositeTest*, clock_t::time_point>;
+
+        /**
+         *  \brief Identifies an armed deadline.
+         */
+        struct Ticket
+        {
+            clock_t::time_point deadline_;
+            std::uint64_t id_;
+        };
+
+    public:
+        /**
+         *  \param root root of the watched run.
+         */
+        explicit Watchdog (Test const& root);
+
+        Watchdog (Watchdog const&) = delete;
+        Watchdog (Watchdog&&) = delete;
+
+        /**
+         *  \brief Stops the thread. Deadlines that are still armed
+         *  are dropped.
+         */
+        ~Watchdog ();
+
+        auto root () const -> Test const&;
+
+        /**
+         *  \brief Calls \p onExpired on the watchdog thread at \p deadline
+         *  unless the deadline is disarmed first.
+         */
+        auto arm (clock_t::time_point deadline, callback_t onExpired) -> Ticket;
+
+        /**
+         *  \brief Removes the deadline. If its callback is running,
+         *  waits until it returns.
+         */
+        auto disarm (Ticket ticket) -> void;
+
+        /**
+         *  \brief Returns lock of the listener events of the run.
+         */
+        auto events () -> std::shared_mutex&;
+
+        /**
+         *  \brief Records that composite \p t at \p path started.
+         *  Call while holding a lock of the events.
+         */
+        auto composite_started (CompositeTest& t, std::string_view path) -> void;
+
+        /**
+         *  \brief Records that composite \p t at \p path finished.
+         *  Call while holding a lock of the events.
+         */
+        auto composite_finished (CompositeTest& t, std::string_view path) -> void;
+
+        /**
+         *  \brief Returns composites that are running, descendants precede
+         *  their ancestors.
+         */
+        auto open_composites () -> std::vector<open_t>;
+
+    private:
+        auto loop () -> void;
+
+    private:
+        Test const* root_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::map<std::pair<clock_t::time_point, std::uint64_t>, callback_t> deadlines_;
+        std::uint64_t nextId_;
+        std::optional<std::uint64_t> expiring_;
+        bool stop_;
+        std::thread thread_;
+        std::shared_mutex events_;
+        std::mutex openMutex_;
+        std::map<
+            std::pair<std::string, CompositeTest*>,
+            clock_t::time_point,
+            std::greater<>
+        > open_;
+    };
+
+    /**
+     *  \brief Returns message of a test that ran for \p elapsed
+     *  and was stopped because it exceeded its time \p limit .
+     */
+    auto timeout_message
+        (std::chrono::nanoseconds elapsed, std::chrono::nanoseconds limit)
+        -> std::string;
+}
+
+#endif
@@ -0,0 +1,162 @@
+#include <librog/details/worker_protocol.hpp>
+
+#include <librog/details/serialization.hpp>
+
+#if defined(__APPLE__) || defined(__linux__)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace rog::details
+{
+    namespace
+    {
+        // type (1B) + unit (4B) + payload size (4B)
+        constexpr auto FrameHeaderSize = std::size_t {9};
+    }
+
+    auto make_frame
+        (FrameType const type, std::size_t const unit, std::string_view const payload)
+        -> std::string
+    {
+        auto frame = ByteWriter();
+        frame.u8(static_cast<std::uint8_t>(type));
+        frame.u32(static_cast<std::uint32_t>(unit));
+        frame.string(payload);
+        return frame.bytes();
+    }
+
+    auto next_frame
+        (std::string_view const buffer, std::size_t& offset)
+        -> std::optional<Frame>
+    {
+        auto const rest = buffer.substr(offset);
+        if (rest.size() < FrameHeaderSize)
+        {
+            return std::nullopt;
+        }
+
+        auto header = ByteReader(rest);
+        auto const type = static_cast<FrameType>(header.u8());
+        auto const unit = std::size_t {header.u32()};
+        auto const size = std::size_t {header.u32()};
+        if (rest.size() < FrameHeaderSize + size)
+        {
+            return std::nullopt;
+        }
+
+        offset += FrameHeaderSize + size;
+        return Frame {type, unit, rest.substr(FrameHeaderSize, size)};
+    }
+
+#if defined(__APPLE__) || defined(__linux__)
+
+    namespace
+    {
+        auto signal_name (int const sig) -> std::string
+        {
+            switch (sig)
+            {
+            case SIGSEGV: return "SIGSEGV";
+            case SIGABRT: return "SIGABRT";
+            case SIGFPE:  return "SIGFPE";
+            case SIGILL:  return "SIGILL";
+            case SIGBUS:  return "SIGBUS";
+            case SIGKILL: return "SIGKILL";
+            case SIGTERM: return "SIGTERM";
+            case SIGPIPE: return "SIGPIPE";
+            case SIGTRAP: return "SIGTRAP";
+            default:      return "signal " + std::to_string(sig);
+            }
+        }
+    }
+
+    auto write_all
+        (int const fd, std::string_view const data) -> bool
+    {
+        auto done = std::size_t {0};
+        while (done < data.size())
+        {
+            auto const n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+    }
+
+    auto send_all
+        (int const fd, std::string_view const data) -> bool
+    {
+#if defined(MSG_NOSIGNAL)
+        auto done = std::size_t {0};
+        while (done < data.size())
+        {
+            auto const n = ::send(
+                fd,
+                data.data() + done,
+                data.size() - done,
+                MSG_NOSIGNAL
+            );
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return false;
+            }
+            done += static_cast<std::size_t>(n);
+        }
+        return true;
+#else
+        // The socket is created with SO_NOSIGPIPE instead.
+        return write_all(fd, data);
+#endif
+    }
+
+    auto describe_exit
+        (int const status) -> std::string
+    {
+        if (WIFSIGNALED(status))
+        {
+            auto const sig = WTERMSIG(status);
+            return "Crashed with " + signal_name(sig)
+                 + " (" + ::strsignal(sig) + ")";
+        }
+        return "Worker exited with status "
+             + std::to_string(WEXITSTATUS(status));
+    }
+
+#else
+
+    auto write_all
+        (int const, std::string_view const) -> bool
+    {
+        return false;
+    }
+
+    auto send_all
+        (int const, std::string_view const) -> bool
+    {
+        return false;
+    }
+
+    auto describe_exit
+        (int const status) -> std::string
+    {
+        return "Worker exited with status " + std::to_string(status);
+    }
+
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef ROG_DETAILS_WORKER_PROTOCOL_HPP
+#define ROG_DETAILS_WORKER_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace rog::details
+{
+    /**
+     *  \brief Type of a frame exchanged between a worker process
+     *  and its parent or coordinator.
+     */
+    enum class FrameType : std::uint8_t
+    {
+        Started,
+        Finished,
+        Request,
+        Batch,
+        Stop,
+        Unknown
+    };
+
+    /**
+     *  \brief Frame read from a stream. Payload points into the buffer.
+     */
+    struct Frame
+    {
+        FrameType type_;
+        std::size_t unit_;
+        std::string_view payload_;
+    };
+
+    /**
+     *  \brief Encodes a frame: type (1B), unit (4B), payload size (4B)
+     *  and the payload.
+     */
+    auto make_frame (FrameType type, std::size_t unit, std::string_view payload)
+        -> std::string;
+
+    /**
+     *  \brief Decodes the frame at \p offset of \p buffer . On success,
+     *  moves \p offset behind the frame.
+     *  \return The frame, or nothing if the frame is not complete yet.
+     */
+    auto next_frame (std::string_view buffer, std::size_t& offset)
+        -> std::optional<Frame>;
+
+    /**
+     *  \brief Writes all of \p data into \p fd .
+     *  \return false if the write failed.
+     */
+    auto write_all (int fd, std::string_view data) -> bool;
+
+    /**
+     *  \brief Writes all of \p data into socket \p fd . Writing into
+     *  a closed socket fails instead of raising SIGPIPE.
+     *  \return false if the write failed.
+     */
+    auto send_all (int fd, std::string_view data) -> bool;
+
+    /**
+     *  \brief Describes exit \p status of a worker returned by waitpid,
+     *  e.g. "Crashed with SIGSEGV (Segmentation fault)".
+     */
+    auto describe_exit (int status) -> std::string;
+}
+
+#endif
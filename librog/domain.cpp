@@ -0,0 +1,97 @@
+#include <librog/domain.hpp>
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace rog::details
+{
+    auto check_chunks
+        (
+            std::uint64_t const size,
+            DomainSettings const& settings,
+            std::function<auto (std::uint64_t, std::uint64_t, BulkResult&) -> void> const& check
+        ) -> BulkResult
+    {
+        auto const chunkSize = std::max(settings.chunkSize_, std::uint64_t {1});
+        auto const chunkCount = size / chunkSize + (size % chunkSize != 0);
+        auto const hardware = std::max(std::thread::hardware_concurrency(), 1u);
+        auto const threadCount = static_cast<unsigned int>(std::min<std::uint64_t>(
+            settings.threadCount_ > 0 ? settings.threadCount_ : hardware,
+            chunkCount
+        ));
+
+        // Each thread takes chunks in increasing order, so the mismatches
+        // it keeps are its first ones and the first mismatches overall
+        // are among the kept ones.
+        auto results = std::vector<BulkResult>(std::max(threadCount, 1u));
+        auto nextChunk = std::atomic<std::uint64_t>(0);
+        auto errorMutex = std::mutex();
+        auto error = std::exception_ptr();
+        auto const work = [&](BulkResult& result)
+        {
+            try
+            {
+                for (;;)
+                {
+                    auto const chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+                    if (chunk >= chunkCount)
+                    {
+                        return;
+                    }
+
+                    auto const begin = chunk * chunkSize;
+                    check(begin, std::min(begin + chunkSize, size), result);
+                }
+            }
+            catch (...)
+            {
+                nextChunk.store(chunkCount);
+                auto lock = std::lock_guard<std::mutex>(errorMutex);
+                if (not error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        };
+
+        if (threadCount < 2)
+        {
+            work(results.front());
+        }
+        else
+        {
+            auto threads = std::vector<std::thread>();
+            threads.reserve(threadCount - 1);
+            for (auto i = 1u; i < threadCount; ++i)
+            {
+                threads.emplace_back(work, std::ref(results[i]));
+            }
+            work(results.front());
+            for (auto& t : threads)
+            {
+                t.join();
+            }
+        }
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+
+        auto merged = BulkResult();
+        for (auto& r : results)
+        {
+            merged.checked_ += r.checked_;
+            merged.mismatchCount_ += r.mismatchCount_;
+            std::ranges::move(r.mismatches_, std::back_inserter(merged.mismatches_));
+        }
+        std::ranges::sort(merged.mismatches_, {}, &BulkMismatch::index_);
+        if (merged.mismatches_.size() > settings.keptMismatches_)
+        {
+            merged.mismatches_.resize(settings.keptMismatches_);
+        }
+        return merged;
+    }
+}
@@ -0,0 +1,246 @@
+#ifndef ROG_DOMAIN_HPP
+#define ROG_DOMAIN_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <librog/rog.hpp>
+
+namespace rog
+{
+    /**
+     *  \brief Finite set of values addressed by indices from [0, size()) .
+     *  Values are made from their index, so a domain can be split into
+     *  chunks without enumerating it.
+     */
+    template<class D>
+    concept Domain = requires (D const& d, std::uint64_t i)
+    {
+        typename D::value_t;
+        { d.size() } -> std::same_as<std::uint64_t>;
+        { d.at(i) } -> std::convertible_to<typename D::value_t>;
+    };
+
+    /**
+     *  \brief Integers from [first, last] . The domain can not contain all
+     *  2^64 values of a 64-bit type.
+     */
+    template<std::integral T>
+    class IntegerRange
+    {
+    public:
+        using value_t = T;
+
+    public:
+        IntegerRange (T const first, T const last) :
+            first_ (first),
+            size_  (static_cast<std::uint64_t>(last) - static_cast<std::uint64_t>(first) + 1)
+        {
+        }
+
+        auto size () const -> std::uint64_t
+        {
+            return size_;
+        }
+
+        auto at (std::uint64_t const index) const -> T
+        {
+            return static_cast<T>(static_cast<std::uint64_t>(first_) + index);
+        }
+
+    private:
+        T first_;
+        std::uint64_t size_;
+    };
+
+    /**
+     *  \brief All bit patterns of \p T , e.g. all floats including NaNs
+     *  and infinities, or all inputs of a function of 8 boolean variables
+     *  packed into \c std::uint8_t .
+     */
+    template<class T>
+    requires (std::is_trivially_copyable_v<T> && not std::same_as<T, bool>
+           && sizeof(T) <= 4)
+    class BitPatterns
+    {
+    public:
+        using value_t = T;
+
+    private:
+        using bits_t =
+            std::conditional_t<sizeof(T) == 1, std::uint8_t,
+            std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                                               std::uint32_t>>;
+
+    public:
+        auto size () const -> std::uint64_t
+        {
+            return std::uint64_t {1} << (8 * sizeof(T));
+        }
+
+        auto at (std::uint64_t const index) const -> T
+        {
+            return std::bit_cast<T>(static_cast<bits_t>(index));
+        }
+    };
+
+    /**
+     *  \brief Cartesian product of domains. Values are tuples, the last
+     *  element changes fastest. The product can have at most 2^64 - 1
+     *  values.
+     */
+    template<Domain... Ds>
+    class Product
+    {
+    public:
+        using value_t = std::tuple<typename Ds::value_t...>;
+
+    public:
+        explicit Product (Ds... domains) :
+            domains_ (std::move(domains)...)
+        {
+        }
+
+        auto size () const -> std::uint64_t
+        {
+            return std::apply([](auto const&... d)
+            {
+                return (std::uint64_t {1} * ... * d.size());
+            }, domains_);
+        }
+
+        auto at (std::uint64_t index) const -> value_t
+        {
+            auto value = value_t();
+            auto const set = [&]<std::size_t I>()
+            {
+                auto const& d = std::get<I>(domains_);
+                std::get<I>(value) = d.at(index % d.size());
+                index /= d.size();
+            };
+            [&]<std::size_t... Is>(std::index_sequence<Is...>)
+            {
+                (set.template operator()<sizeof...(Ds) - 1 - Is>(), ...);
+            }(std::index_sequence_for<Ds...>());
+            return value;
+        }
+
+    private:
+        std::tuple<Ds...> domains_;
+    };
+
+    /**
+     *  \brief Settings of \c check_domain .
+     */
+    struct DomainSettings
+    {
+        /**
+         *  \brief Number of mismatches whose values are kept.
+         */
+        std::size_t keptMismatches_ {16};
+
+        /**
+         *  \brief Number of values checked by one task.
+         */
+        std::uint64_t chunkSize_ {std::uint64_t {1} << 16};
+
+        /**
+         *  \brief Number of threads. Zero uses all hardware threads.
+         */
+        unsigned int threadCount_ {0};
+    };
+
+    namespace details
+    {
+        /**
+         *  \brief Calls \p check with chunks of [0, size) on several threads
+         *  and merges their results. \p check must count the values it
+         *  checked and keep its first mismatches.
+         */
+        auto check_chunks (
+            std::uint64_t size,
+            DomainSettings const& settings,
+            std::function<auto (std::uint64_t, std::uint64_t, BulkResult&) -> void> const& check
+        ) -> BulkResult;
+
+        template<class F, class T>
+        auto call_with (F& f, T const& value) -> decltype(auto)
+        {
+            if constexpr (std::invocable<F&, T const&>)
+            {
+                return std::invoke(f, value);
+            }
+            else
+            {
+                return std::apply(f, value);
+            }
+        }
+    }
+
+    /**
+     *  \brief Compares \p f with \p reference on every value of \p domain .
+     *
+     *  The domain is split into chunks checked in parallel, so both
+     *  functions must be safe to call from several threads. Mismatches
+     *  are counted, only the first \c DomainSettings::keptMismatches_
+     *  of them are printed and kept. Tuple values are unpacked into
+     *  arguments if the functions do not take the tuple.
+     *  \param domain checked values.
+     *  \param f checked function.
+     *  \param reference function that gives the expected results.
+     *  \param settings settings of the check.
+     *  \param equal compares the expected and the actual result.
+     *  \return Totals of the check, pass it to \c LeafTest::assert_bulk .
+     */
+    template<Domain D, class F, class R, class Eq = std::equal_to<>>
+    auto check_domain (
+        D const& domain,
+        F f,
+        R reference,
+        DomainSettings const& settings = DomainSettings(),
+        Eq equal = Eq()
+    ) -> BulkResult
+    {
+        auto const kept = settings.keptMismatches_;
+        return details::check_chunks(
+            domain.size(),
+            settings,
+            [&](std::uint64_t const begin, std::uint64_t const end, BulkResult& result)
+            {
+                // Copies avoid sharing state of the functions between threads.
+                auto fc = f;
+                auto rc = reference;
+                auto eq = equal;
+                for (auto i = begin; i < end; ++i)
+                {
+                    auto const value = domain.at(i);
+                    auto const expected = details::call_with(rc, value);
+                    auto const actual = details::call_with(fc, value);
+                    if (not std::invoke(eq, expected, actual))
+                    {
+                        if (result.mismatches_.size() < kept)
+                        {
+                            result.mismatches_.push_back(BulkMismatch {
+                                i,
+                                details::print_value(value),
+                                details::print_value(expected),
+                                details::print_value(actual)
+                            });
+                        }
+                        ++result.mismatchCount_;
+                    }
+                }
+                result.checked_ += end - begin;
+            }
+        );
+    }
+}
+
+#endif
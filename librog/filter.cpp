@@ -0,0 +1,187 @@
+#include <librog/filter.hpp>
+
+#include <utility>
+
+namespace rog
+{
+    namespace
+    {
+        /**
+         *  \brief Matches \p text against \p pattern . If \p prefix is true,
+         *  it is enough that some extension of \p text matches.
+         */
+        auto glob_match
+            (std::string_view p, std::string_view t, bool const prefix) -> bool
+        {
+            while (not p.empty())
+            {
+                if (t.empty() && prefix)
+                {
+                    return true;
+                }
+
+                if (p.starts_with("**"))
+                {
+                    p.remove_prefix(2);
+                    for (auto i = std::size_t {0}; i <= t.size(); ++i)
+                    {
+                        if (glob_match(p, t.substr(i), prefix))
+                        {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                if (p.front() == '*')
+                {
+                    p.remove_prefix(1);
+                    for (auto i = std::size_t {0}; i <= t.size(); ++i)
+                    {
+                        if (glob_match(p, t.substr(i), prefix))
+                        {
+                            return true;
+                        }
+                        if (i < t.size() && t[i] == '/')
+                        {
+                            return false;
+                        }
+                    }
+                    return false;
+                }
+
+                if (t.empty())
+                {
+                    return false;
+                }
+
+                auto const same = p.front() == '?'
+                    ? t.front() != '/'
+                    : t.front() == p.front();
+                if (not same)
+                {
+                    return false;
+                }
+                p.remove_prefix(1);
+                t.remove_prefix(1);
+            }
+            return t.empty();
+        }
+    }
+
+    auto TestFilter::include
+        (std::string_view const glob) -> TestFilter&
+    {
+        includes_.emplace_back(Pattern {std::string(glob), std::nullopt});
+        return *this;
+    }
+
+    auto TestFilter::exclude
+        (std::string_view const glob) -> TestFilter&
+    {
+        excludes_.emplace_back(Pattern {std::string(glob), std::nullopt});
+        return *this;
+    }
+
+    auto TestFilter::include_regex
+        (std::string_view const regex) -> TestFilter&
+    {
+        includes_.emplace_back(Pattern {
+            std::string(regex),
+            std::regex(regex.begin(), regex.end())
+        });
+        return *this;
+    }
+
+    auto TestFilter::exclude_regex
+        (std::string_view const regex) -> TestFilter&
+    {
+        excludes_.emplace_back(Pattern {
+            std::string(regex),
+            std::regex(regex.begin(), regex.end())
+        });
+        return *this;
+    }
+
+    auto TestFilter::shard
+        (TestShard shard) -> TestFilter&
+    {
+        shard_ = std::move(shard);
+        return *this;
+    }
+
+    auto TestFilter::empty
+        () const -> bool
+    {
+        return includes_.empty() && excludes_.empty() && shard_.count() < 2;
+    }
+
+    auto TestFilter::selects_leaf
+        (std::string_view const path) const -> bool
+    {
+        return (includes_.empty() || matches_any(includes_, path))
+            && not matches_any(excludes_, path)
+            && shard_.selects(path);
+    }
+
+    auto TestFilter::selects_composite
+        (std::string_view const path) const -> bool
+    {
+        if (matches_any(excludes_, path))
+        {
+            return false;
+        }
+
+        if (includes_.empty() || matches_any(includes_, path))
+        {
+            return true;
+        }
+
+        auto const below = path.empty()
+            ? std::string()
+            : std::string(path) + '/';
+        for (auto const& p : includes_)
+        {
+            if (p.regex_ || glob_match(p.glob_, below, true))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto TestFilter::matches
+        (Pattern const& p, std::string_view const path) -> bool
+    {
+        return p.regex_
+            ? std::regex_match(path.begin(), path.end(), *p.regex_)
+            : glob_match(p.glob_, path, false);
+    }
+
+    auto TestFilter::matches_any
+        (std::vector<Pattern> const& ps, std::string_view const path) -> bool
+    {
+        // The path itself and paths of all of its ancestors.
+        for (auto const& p : ps)
+        {
+            auto end = path.size();
+            for (;;)
+            {
+                if (matches(p, path.substr(0, end)))
+                {
+                    return true;
+                }
+
+                auto const slash = end > 0
+                    ? path.rfind('/', end - 1)
+                    : std::string_view::npos;
+                if (slash == std::string_view::npos)
+                {
+                    break;
+                }
+                end = slash;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef ROG_FILTER_HPP
+#define ROG_FILTER_HPP
+
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <librog/sharding.hpp>
+
+namespace rog
+{
+    /**
+     *  \brief Selects tests by their paths.
+     *
+     *  Path of a test consists of names of all its ancestors and the name
+     *  of the test itself joined by '/'. A pattern that matches path of
+     *  a composite matches all of its descendants too. A test is selected
+     *  if no include pattern is given or some of them matches it,
+     *  and none of the exclude patterns matches it.
+     *
+     *  In glob patterns, '*' matches any sequence of characters except '/',
+     *  '**' matches any sequence of characters, and '?' matches any single
+     *  character except '/'. Regular expressions use the ECMAScript grammar
+     *  and must match the whole path. Composites that can not contain
+     *  a selected test are not run at all. This is only decided for glob
+     *  includes, composites are never pruned by a regex include.
+     *
+     *  Optionally, only leaves of one shard are selected, see \c TestShard .
+     */
+    class TestFilter
+    {
+    public:
+        auto include (std::string_view glob) -> TestFilter&;
+        auto exclude (std::string_view glob) -> TestFilter&;
+
+        /**
+         *  \throws std::regex_error if \p regex is not valid.
+         */
+        auto include_regex (std::string_view regex) -> TestFilter&;
+
+        /**
+         *  \throws std::regex_error if \p regex is not valid.
+         */
+        auto exclude_regex (std::string_view regex) -> TestFilter&;
+
+        /**
+         *  \brief Selects only leaves that belong to \p shard .
+         *  Composites are not pruned by the shard.
+         */
+        auto shard (TestShard shard) -> TestFilter&;
+
+        /**
+         *  \brief Returns true if the filter selects all tests.
+         */
+        auto empty () const -> bool;
+
+        /**
+         *  \brief Returns true if the test without subtests at \p path
+         *  is selected.
+         */
+        auto selects_leaf (std::string_view path) const -> bool;
+
+        /**
+         *  \brief Returns true if the composite at \p path can contain
+         *  a selected test.
+         */
+        auto selects_composite (std::string_view path) const -> bool;
+
+    private:
+        struct Pattern
+        {
+            std::string glob_;
+            std::optional<std::regex> regex_;
+        };
+
+    private:
+        static auto matches (Pattern const& p, std::string_view path) -> bool;
+        static auto matches_any
+            (std::vector<Pattern> const& ps, std::string_view path) -> bool;
+
+    private:
+        std::vector<Pattern> includes_;
+        std::vector<Pattern> excludes_;
+        TestShard shard_;
+    };
+}
+
+#endif
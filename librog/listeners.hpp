@@ -0,0 +1,69 @@
+#ifndef ROG_LISTENERS_HPP
+#define ROG_LISTENERS_HPP
+
+#include <string_view>
+
+namespace rog
+{
+    class Test;
+    class LeafTest;
+    class CompositeTest;
+    class BenchmarkTest;
+    struct TestMessage;
+
+    /**
+     *  \brief Receives events of a running test hierarchy.
+     *
+     *  Path of a test consists of names of all its ancestors and the name
+     *  of the test itself joined by '/'. In a parallel run, methods can be
+     *  called concurrently from multiple threads. Default implementations
+     *  do nothing.
+     */
+    struct ITestListener
+    {
+        virtual ~ITestListener () = default;
+
+        virtual auto on_run_started (Test const&) -> void
+        {
+        }
+
+        virtual auto on_run_finished (Test const&) -> void
+        {
+        }
+
+        virtual auto on_test_started (LeafTest const&, std::string_view) -> void
+        {
+        }
+
+        virtual auto on_assertion_failed
+            (LeafTest const&, std::string_view, TestMessage const&) -> void
+        {
+        }
+
+        virtual auto on_test_finished (LeafTest const&, std::string_view) -> void
+        {
+        }
+
+        virtual auto on_composite_started
+            (CompositeTest const&, std::string_view) -> void
+        {
+        }
+
+        virtual auto on_composite_finished
+            (CompositeTest const&, std::string_view) -> void
+        {
+        }
+
+        virtual auto on_benchmark_started
+            (BenchmarkTest const&, std::string_view) -> void
+        {
+        }
+
+        virtual auto on_benchmark_finished
+            (BenchmarkTest const&, std::string_view) -> void
+        {
+        }
+    };
+}
+
+#endif
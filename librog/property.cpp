@@ -0,0 +1,182 @@
+#include <librog/property.hpp>
+#include <librog/details/cancellation.hpp>
+#include <librog/details/run_context.hpp>
+#include <librog/details/thread_pool.hpp>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+namespace rog
+{
+    namespace
+    {
+        auto mix (std::uint64_t z) -> std::uint64_t
+        {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        constexpr auto Golden = std::uint64_t {0x9e3779b97f4a7c15ull};
+    }
+
+// Random:
+
+    Random::Random
+        (std::uint64_t const seed) :
+        state_ (seed)
+    {
+    }
+
+    auto Random::next
+        () -> std::uint64_t
+    {
+        state_ += Golden;
+        return mix(state_);
+    }
+
+    auto Random::below
+        (std::uint64_t const n) -> std::uint64_t
+    {
+        // Rejects the incomplete range at the top to avoid modulo bias.
+        auto const limit = std::numeric_limits<std::uint64_t>::max()
+                         - std::numeric_limits<std::uint64_t>::max() % n;
+        auto x = this->next();
+        while (x >= limit)
+        {
+            x = this->next();
+        }
+        return x % n;
+    }
+
+    auto Random::unit
+        () -> double
+    {
+        return static_cast<double>(this->next() >> 11) * 0x1.0p-53;
+    }
+
+// Property details:
+
+    namespace details
+    {
+        auto property_seed
+            (PropertySettings const& settings, RunContext const* const context)
+            -> std::uint64_t
+        {
+            if (settings.seed_)
+            {
+                return *settings.seed_;
+            }
+
+            if (context && context->settings_->seed_)
+            {
+                return *context->settings_->seed_;
+            }
+
+            auto device = std::random_device();
+            return (std::uint64_t {device()} << 32) ^ std::uint64_t {device()};
+        }
+
+        auto case_seed
+            (std::uint64_t const seed, std::size_t const index) -> std::uint64_t
+        {
+            return mix(seed + Golden * (std::uint64_t {index} + 1));
+        }
+
+        auto case_size
+            (PropertySettings const& settings, std::size_t const index)
+            -> std::size_t
+        {
+            if (settings.caseCount_ < 2)
+            {
+                return settings.maxSize_;
+            }
+            return index * settings.maxSize_ / (settings.caseCount_ - 1);
+        }
+
+        auto find_failing_case
+            (
+                RunContext const* const context,
+                PropertySettings const& settings,
+                std::function<bool(std::size_t)> const& fails
+            ) -> std::optional<std::size_t>
+        {
+            auto const is_cancelled = [context]()
+            {
+                return context && context->cancel_ && context->cancel_->is_cancelled();
+            };
+
+            auto const count = settings.caseCount_;
+            if (not settings.parallel_ || not context || not context->pool_)
+            {
+                for (auto i = std::size_t {0}; i < count && not is_cancelled(); ++i)
+                {
+                    if (fails(i))
+                    {
+                        return i;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            // Cases are taken in order, so every case before the first
+            // failing one is checked and the result does not depend
+            // on scheduling.
+            auto next = std::atomic<std::size_t>(0);
+            auto first = std::atomic<std::size_t>(count);
+            auto group = TaskGroup(*context->pool_);
+            auto const taskCount = std::max(1u, std::thread::hardware_concurrency());
+            for (auto t = 0u; t < taskCount; ++t)
+            {
+                group.run([&]()
+                {
+                    for (;;)
+                    {
+                        auto const i = next.fetch_add(1, std::memory_order_relaxed);
+                        if (i >= first.load(std::memory_order_relaxed) || is_cancelled())
+                        {
+                            return;
+                        }
+
+                        if (fails(i))
+                        {
+                            auto f = first.load(std::memory_order_relaxed);
+                            while (i < f && not first.compare_exchange_weak(f, i))
+                            {
+                            }
+                            return;
+                        }
+                    }
+                });
+            }
+            group.wait();
+
+            auto const failing = first.load();
+            return failing < count
+                ? std::optional<std::size_t>(failing)
+                : std::nullopt;
+        }
+
+        auto falsified_message
+            (Falsification const& f) -> std::string
+        {
+            auto message = "Falsified by case " + std::to_string(f.caseIndex_ + 1)
+                         + " with seed " + std::to_string(f.seed_)
+                         + ": " + f.value_ + ". " + f.reason_;
+            if (f.shrinkSteps_ > 0)
+            {
+                message += ". Shrunk in " + std::to_string(f.shrinkSteps_)
+                         + " steps from " + f.original_;
+            }
+            return message;
+        }
+
+        auto held_message
+            (std::size_t const caseCount, std::uint64_t const seed) -> std::string
+        {
+            return "Property holds for " + std::to_string(caseCount)
+                 + " cases with seed " + std::to_string(seed);
+        }
+    }
+}
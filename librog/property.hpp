@@ -0,0 +1,872 @@
+#ifndef ROG_PROPERTY_HPP
+#define ROG_PROPERTY_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <librog/rog.hpp>
+
+namespace rog
+{
+    /**
+     *  \brief Deterministic pseudo-random generator (SplitMix64).
+     *  Produces the same sequence for a seed on every platform.
+     */
+    class Random
+    {
+    public:
+        /**
+         *  \brief Initializes the generator with \p seed .
+         *  \param seed seed of the sequence.
+         */
+        explicit Random (std::uint64_t seed);
+
+        /**
+         *  \brief Returns next number of the sequence.
+         *  \return Uniformly distributed 64-bit number.
+         */
+        auto next () -> std::uint64_t;
+
+        /**
+         *  \brief Returns number from [0, n) , \p n must be positive.
+         *  \param n upper bound.
+         *  \return Uniformly distributed number less than \p n .
+         */
+        auto below (std::uint64_t n) -> std::uint64_t;
+
+        /**
+         *  \brief Returns number from [0, 1) .
+         *  \return Uniformly distributed number.
+         */
+        auto unit () -> double;
+
+    private:
+        std::uint64_t state_;
+    };
+
+    /**
+     *  \brief Generated value together with its simpler variants.
+     *
+     *  Variants are made lazily, only when a failing value is shrunk.
+     *  Each variant has variants of its own, so shrinking walks down
+     *  a tree whose leaves are the simplest values.
+     */
+    template<class T>
+    class Shrinkable
+    {
+    public:
+        using shrinks_t = std::function<std::vector<Shrinkable<T>>()>;
+
+    public:
+        /**
+         *  \brief Initializes the value.
+         *  \param value generated value.
+         *  \param shrinks makes simpler variants of \p value , ordered
+         *  from the simplest. Empty if the value can not be shrunk.
+         */
+        Shrinkable (T value, shrinks_t shrinks = shrinks_t());
+
+        /**
+         *  \brief Returns the value.
+         *  \return The value.
+         */
+        auto value () const -> T const&;
+
+        /**
+         *  \brief Returns simpler variants of the value.
+         *  \return Variants ordered from the simplest.
+         */
+        auto shrinks () const -> std::vector<Shrinkable<T>>;
+
+        /**
+         *  \brief Applies \p f to the value and to all of its variants.
+         *  \param f function applied to the values.
+         *  \return Transformed value.
+         */
+        template<class F>
+        auto map (F f) const -> Shrinkable<std::invoke_result_t<F, T const&>>;
+
+        /**
+         *  \brief Removes variants that do not satisfy \p predicate .
+         *  \param predicate predicate that variants must satisfy.
+         *  \return Value with filtered variants.
+         */
+        template<class P>
+        auto filter (P predicate) const -> Shrinkable<T>;
+
+    private:
+        T value_;
+        shrinks_t shrinks_;
+    };
+
+    /**
+     *  \brief Makes shrinkable values of type \p T .
+     *
+     *  Generators are combined from the functions in \c rog::gen ,
+     *  custom ones wrap a function that makes the value from a random
+     *  generator and a size. The size grows from small values in the
+     *  first cases to \c PropertySettings::maxSize_ in the last ones,
+     *  generators of containers use it to limit their length.
+     */
+    template<class T>
+    class Generator
+    {
+    public:
+        using value_t = T;
+        using generate_t = std::function<Shrinkable<T>(Random&, std::size_t)>;
+
+    public:
+        /**
+         *  \brief Initializes the generator.
+         *  \param generate makes a value from a random generator and a size.
+         */
+        explicit Generator (generate_t generate);
+
+        /**
+         *  \brief Makes a value.
+         *  \param random source of randomness.
+         *  \param size size of the case.
+         *  \return New value.
+         */
+        auto operator() (Random& random, std::size_t size) const -> Shrinkable<T>;
+
+    private:
+        generate_t generate_;
+    };
+
+    /**
+     *  \brief Settings of a property test.
+     */
+    struct PropertySettings
+    {
+        /**
+         *  \brief Number of generated cases.
+         */
+        std::size_t caseCount_ {1000};
+
+        /**
+         *  \brief Size of the last case, see \c Generator .
+         */
+        std::size_t maxSize_ {100};
+
+        /**
+         *  \brief Maximal number of values checked while shrinking.
+         */
+        std::size_t maxShrinkAttempts_ {10000};
+
+        /**
+         *  \brief Seed of the cases. If empty, \c RunSettings::seed_
+         *  is used.
+         */
+        std::optional<std::uint64_t> seed_ {};
+
+        /**
+         *  \brief Specifies whether the cases may be checked concurrently.
+         *  They are if the run is parallel, the property must be safe
+         *  to call from several threads then.
+         */
+        bool parallel_ {false};
+    };
+
+    /**
+     *  \brief Base class for implementation of a property-based test.
+     *
+     *  Checks the property on values made by a generator. Each case has
+     *  its own random generator derived from the seed and the index
+     *  of the case, so a case does not depend on the others and a run
+     *  with the same seed checks the same values. The first failing case
+     *  is shrunk to the simplest value that still fails. The test fails
+     *  with that value, the original one and the seed.
+     */
+    template<class T>
+    class PropertyTest : public LeafTest
+    {
+    public:
+        /**
+         *  \brief Initializes the test with \p name .
+         *  \param name name of the test.
+         *  \param generator makes the checked values.
+         *  \param settings settings of the test.
+         */
+        PropertyTest (
+            std::string name,
+            Generator<T> generator,
+            PropertySettings settings = PropertySettings()
+        );
+
+        /**
+         *  \brief Returns settings of the test.
+         *  \return Settings of the test.
+         */
+        auto settings () const -> PropertySettings const&;
+
+    protected:
+        /**
+         *  \brief Child classes implements the property in this method.
+         *  The property fails if it returns false or throws. It must
+         *  not use the assertions of \c LeafTest , which would record
+         *  every shrinking attempt.
+         *  \param value generated value.
+         *  \return true if the property holds for \p value .
+         */
+        virtual auto property (T const& value) -> bool = 0;
+
+    private:
+        auto test () -> void override final;
+        auto generate (std::uint64_t seed, std::size_t index) const -> Shrinkable<T>;
+        auto check_case (T const& value) -> std::optional<std::string>;
+
+    private:
+        Generator<T> generator_;
+        PropertySettings settings_;
+    };
+
+    namespace details
+    {
+        /**
+         *  \brief Returns seed of a property test run in \p context .
+         */
+        auto property_seed
+            (PropertySettings const& settings, RunContext const* context)
+            -> std::uint64_t;
+
+        /**
+         *  \brief Returns seed of the case at \p index .
+         */
+        auto case_seed (std::uint64_t seed, std::size_t index) -> std::uint64_t;
+
+        /**
+         *  \brief Returns size of the case at \p index .
+         */
+        auto case_size (PropertySettings const& settings, std::size_t index)
+            -> std::size_t;
+
+        /**
+         *  \brief Returns index of the first case for which \p fails
+         *  returns true. All cases before it are checked. If allowed,
+         *  the cases are checked in parallel on the pool of \p context .
+         */
+        auto find_failing_case (
+            RunContext const* context,
+            PropertySettings const& settings,
+            std::function<bool(std::size_t)> const& fails
+        ) -> std::optional<std::size_t>;
+
+        /**
+         *  \brief Failed property and its counterexample.
+         */
+        struct Falsification
+        {
+            std::size_t caseIndex_;
+            std::uint64_t seed_;
+            std::string value_;
+            std::string original_;
+            std::string reason_;
+            std::size_t shrinkSteps_;
+        };
+
+        auto falsified_message (Falsification const& f) -> std::string;
+        auto held_message (std::size_t caseCount, std::uint64_t seed)
+            -> std::string;
+
+        /**
+         *  \brief Returns values between \p value and \p target ,
+         *  starting with \p target and approaching \p value .
+         */
+        template<std::integral T>
+        auto towards (T const value, T const target) -> std::vector<T>
+        {
+            using U = std::uint64_t;
+            auto const up = value < target;
+            auto const distance = up
+                ? static_cast<U>(target) - static_cast<U>(value)
+                : static_cast<U>(value) - static_cast<U>(target);
+
+            auto values = std::vector<T>();
+            for (auto step = distance; step > 0; step /= 2)
+            {
+                values.push_back(static_cast<T>(
+                    up ? static_cast<U>(value) + step
+                       : static_cast<U>(value) - step
+                ));
+            }
+            return values;
+        }
+
+        template<std::integral T>
+        auto shrink_integer (T const value, T const target) -> Shrinkable<T>
+        {
+            return Shrinkable<T>(value, [value, target]()
+            {
+                auto shrinks = std::vector<Shrinkable<T>>();
+                for (auto const v : towards(value, target))
+                {
+                    shrinks.push_back(shrink_integer(v, target));
+                }
+                return shrinks;
+            });
+        }
+
+        /**
+         *  \brief Returns value from [min, max] .
+         */
+        template<std::integral T>
+        auto uniform_integer (Random& random, T const min, T const max) -> T
+        {
+            using U = std::uint64_t;
+            auto const span = static_cast<U>(max) - static_cast<U>(min);
+            auto const offset = span == std::numeric_limits<U>::max()
+                ? random.next()
+                : random.below(span + 1);
+            return static_cast<T>(static_cast<U>(min) + offset);
+        }
+
+        template<std::floating_point T>
+        auto shrink_float (T const value, T const min, T const max, T const target)
+            -> Shrinkable<T>
+        {
+            return Shrinkable<T>(value, [=]()
+            {
+                auto const distance = std::abs(value - target);
+                auto candidates = std::vector<T> {target, std::trunc(value)};
+                for (auto step = (value - target) / 2; std::abs(step) >= 1; step /= 2)
+                {
+                    candidates.push_back(std::trunc(value - step));
+                }
+                if (distance >= 1)
+                {
+                    candidates.push_back(value < target ? value + 1 : value - 1);
+                }
+
+                auto shrinks = std::vector<Shrinkable<T>>();
+                auto previous = std::vector<T>();
+                for (auto const c : candidates)
+                {
+                    auto const simpler = c >= min && c <= max
+                        && std::abs(c - target) < distance;
+                    if (simpler && std::ranges::find(previous, c) == previous.end())
+                    {
+                        previous.push_back(c);
+                        shrinks.push_back(shrink_float(c, min, max, target));
+                    }
+                }
+                return shrinks;
+            });
+        }
+
+        template<class T>
+        auto shrink_vector
+            (std::vector<Shrinkable<T>> elements, std::size_t const minSize)
+            -> Shrinkable<std::vector<T>>
+        {
+            auto values = std::vector<T>();
+            values.reserve(elements.size());
+            for (auto const& e : elements)
+            {
+                values.push_back(e.value());
+            }
+
+            return Shrinkable<std::vector<T>>(
+                std::move(values),
+                [elements = std::move(elements), minSize]()
+                {
+                    auto shrinks = std::vector<Shrinkable<std::vector<T>>>();
+                    auto const size = elements.size();
+
+                    // Remove chunks of elements, the largest first.
+                    for (auto chunk = size - std::min(size, minSize); chunk > 0; chunk /= 2)
+                    {
+                        for (auto begin = std::size_t {0}; begin + chunk <= size; begin += chunk)
+                        {
+                            auto rest = std::vector<Shrinkable<T>>();
+                            rest.reserve(size - chunk);
+                            auto const first = elements.begin();
+                            rest.insert(rest.end(), first, first + static_cast<std::ptrdiff_t>(begin));
+                            rest.insert(rest.end(), first + static_cast<std::ptrdiff_t>(begin + chunk), elements.end());
+                            shrinks.push_back(shrink_vector(std::move(rest), minSize));
+                        }
+                    }
+
+                    // Then shrink single elements.
+                    for (auto i = std::size_t {0}; i < size; ++i)
+                    {
+                        for (auto& s : elements[i].shrinks())
+                        {
+                            auto copy = elements;
+                            copy[i] = std::move(s);
+                            shrinks.push_back(shrink_vector(std::move(copy), minSize));
+                        }
+                    }
+                    return shrinks;
+                }
+            );
+        }
+
+        template<class... Ts>
+        auto shrink_tuple (std::tuple<Shrinkable<Ts>...> parts)
+            -> Shrinkable<std::tuple<Ts...>>
+        {
+            auto value = std::apply([](auto const&... p)
+            {
+                return std::tuple<Ts...>(p.value()...);
+            }, parts);
+
+            return Shrinkable<std::tuple<Ts...>>(
+                std::move(value),
+                [parts = std::move(parts)]()
+                {
+                    auto shrinks = std::vector<Shrinkable<std::tuple<Ts...>>>();
+                    auto const shrink_part = [&]<std::size_t I>()
+                    {
+                        for (auto& s : std::get<I>(parts).shrinks())
+                        {
+                            auto copy = parts;
+                            std::get<I>(copy) = std::move(s);
+                            shrinks.push_back(shrink_tuple(std::move(copy)));
+                        }
+                    };
+                    [&]<std::size_t... Is>(std::index_sequence<Is...>)
+                    {
+                        (shrink_part.template operator()<Is>(), ...);
+                    }(std::index_sequence_for<Ts...>());
+                    return shrinks;
+                }
+            );
+        }
+    }
+
+    /**
+     *  \brief Generators of common types and combinators that make
+     *  generators of composed types.
+     */
+    namespace gen
+    {
+        /**
+         *  \brief Makes values of \p generator transformed by \p f .
+         *  Shrinks the values before they are transformed.
+         */
+        template<class T, class F>
+        auto map (Generator<T> generator, F f)
+            -> Generator<std::invoke_result_t<F, T const&>>
+        {
+            using U = std::invoke_result_t<F, T const&>;
+            return Generator<U>(
+                [generator = std::move(generator), f = std::move(f)]
+                (Random& random, std::size_t const size)
+            {
+                return generator(random, size).map(f);
+            });
+        }
+
+        /**
+         *  \brief Makes values of \p generator that satisfy \p predicate .
+         *  Throws if it does not make one in 100 attempts.
+         */
+        template<class T, class P>
+        auto filter (Generator<T> generator, P predicate) -> Generator<T>
+        {
+            return Generator<T>(
+                [generator = std::move(generator), predicate = std::move(predicate)]
+                (Random& random, std::size_t const size)
+            {
+                for (auto attempt = std::size_t {0}; attempt < 100; ++attempt)
+                {
+                    auto value = generator(random, size + attempt);
+                    if (std::invoke(predicate, value.value()))
+                    {
+                        return value.filter(predicate);
+                    }
+                }
+                throw std::runtime_error("Filter rejected 100 generated values");
+            });
+        }
+
+        /**
+         *  \brief Makes always \p value .
+         */
+        template<class T>
+        auto just (T value) -> Generator<T>
+        {
+            return Generator<T>([value = std::move(value)](Random&, std::size_t)
+            {
+                return Shrinkable<T>(value);
+            });
+        }
+
+        /**
+         *  \brief Makes true or false, shrinks to false.
+         */
+        inline auto booleans () -> Generator<bool>
+        {
+            return Generator<bool>([](Random& random, std::size_t)
+            {
+                auto const value = random.below(2) == 1;
+                return value
+                    ? Shrinkable<bool>(true, []()
+                      {
+                          return std::vector<Shrinkable<bool>> {Shrinkable<bool>(false)};
+                      })
+                    : Shrinkable<bool>(false);
+            });
+        }
+
+        /**
+         *  \brief Makes integers from [min, max] . Bounds and the value
+         *  closest to zero are made more often, small cases stay close
+         *  to zero. Shrinks towards zero.
+         */
+        template<std::integral T>
+        auto integers (
+            T const min = std::numeric_limits<T>::min(),
+            T const max = std::numeric_limits<T>::max()
+        ) -> Generator<T>
+        {
+            auto const target = std::clamp(T {0}, min, max);
+            return Generator<T>([=](Random& random, std::size_t const size)
+            {
+                using U = std::uint64_t;
+                auto value = target;
+                switch (random.below(8))
+                {
+                    case 0: value = min; break;
+                    case 1: value = max; break;
+                    case 2: value = target; break;
+                    case 3:
+                    case 4:
+                    case 5:
+                    {
+                        auto const below = static_cast<U>(target) - static_cast<U>(min);
+                        auto const above = static_cast<U>(max) - static_cast<U>(target);
+                        auto const lo = static_cast<T>(static_cast<U>(target) - std::min<U>(below, size));
+                        auto const hi = static_cast<T>(static_cast<U>(target) + std::min<U>(above, size));
+                        value = details::uniform_integer(random, lo, hi);
+                        break;
+                    }
+                    default: value = details::uniform_integer(random, min, max); break;
+                }
+                return details::shrink_integer(value, target);
+            });
+        }
+
+        /**
+         *  \brief Makes finite floating-point numbers from [min, max] .
+         *  Bounds and the value closest to zero are made more often,
+         *  small cases stay close to zero. Shrinks towards zero and
+         *  integral values.
+         */
+        template<std::floating_point T>
+        auto floats (
+            T const min = std::numeric_limits<T>::lowest(),
+            T const max = std::numeric_limits<T>::max()
+        ) -> Generator<T>
+        {
+            auto const target = std::clamp(T {0}, min, max);
+            return Generator<T>([=](Random& random, std::size_t const size)
+            {
+                auto const u = static_cast<T>(random.unit());
+                auto value = target;
+                switch (random.below(8))
+                {
+                    case 0: value = min; break;
+                    case 1: value = max; break;
+                    case 2: value = target; break;
+                    case 3:
+                    case 4:
+                    case 5:
+                    {
+                        auto const s = static_cast<T>(size);
+                        value = std::lerp(
+                            std::max(min, target - s),
+                            std::min(max, target + s),
+                            u
+                        );
+                        break;
+                    }
+                    default: value = std::lerp(min, max, u); break;
+                }
+                return details::shrink_float(std::clamp(value, min, max), min, max, target);
+            });
+        }
+
+        /**
+         *  \brief Makes one of \p values , shrinks towards the first one.
+         */
+        template<class T>
+        auto elements (std::vector<T> values) -> Generator<T>
+        {
+            auto const last = values.size() - 1;
+            return map(integers<std::size_t>(0, last), [values = std::move(values)]
+                (std::size_t const i)
+            {
+                return values[i];
+            });
+        }
+
+        /**
+         *  \brief Makes vectors of values made by \p element . Length
+         *  is at most the size of the case. Shrinks by removing elements
+         *  and then by shrinking them.
+         */
+        template<class T>
+        auto vectors (
+            Generator<T> element,
+            std::size_t const minSize = 0,
+            std::size_t const maxSize = std::numeric_limits<std::size_t>::max()
+        ) -> Generator<std::vector<T>>
+        {
+            return Generator<std::vector<T>>(
+                [element = std::move(element), minSize, maxSize]
+                (Random& random, std::size_t const size)
+            {
+                auto const hi = std::max(minSize, std::min(maxSize, size));
+                auto const length = minSize + random.below(hi - minSize + 1);
+                auto elements = std::vector<Shrinkable<T>>();
+                elements.reserve(length);
+                for (auto i = std::size_t {0}; i < length; ++i)
+                {
+                    elements.push_back(element(random, size));
+                }
+                return details::shrink_vector(std::move(elements), minSize);
+            });
+        }
+
+        /**
+         *  \brief Makes strings of characters from \p alphabet of length
+         *  at most \p maxLength . Shrinks to shorter strings of earlier
+         *  characters of the alphabet.
+         */
+        inline auto strings (
+            std::size_t const maxLength = 32,
+            std::string_view const alphabet =
+                "abcdefghijklmnopqrstuvwxyz"
+                "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+                "0123456789 !\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~"
+        ) -> Generator<std::string>
+        {
+            auto chars = vectors(
+                elements(std::vector<char>(alphabet.begin(), alphabet.end())),
+                0,
+                maxLength
+            );
+            return map(std::move(chars), [](std::vector<char> const& cs)
+            {
+                return std::string(cs.begin(), cs.end());
+            });
+        }
+
+        /**
+         *  \brief Makes tuples of values made by \p generators .
+         *  Shrinks the elements one by one.
+         */
+        template<class... Ts>
+        auto tuples (Generator<Ts>... generators) -> Generator<std::tuple<Ts...>>
+        {
+            return Generator<std::tuple<Ts...>>(
+                [... generators = std::move(generators)]
+                (Random& random, std::size_t const size)
+            {
+                // Braced initialization keeps the order of the calls.
+                auto parts = std::tuple<Shrinkable<Ts>...> {generators(random, size)...};
+                return details::shrink_tuple(std::move(parts));
+            });
+        }
+    }
+
+// Shrinkable:
+
+    template<class T>
+    Shrinkable<T>::Shrinkable
+        (T value, shrinks_t shrinks) :
+        value_   (std::move(value)),
+        shrinks_ (std::move(shrinks))
+    {
+    }
+
+    template<class T>
+    auto Shrinkable<T>::value
+        () const -> T const&
+    {
+        return value_;
+    }
+
+    template<class T>
+    auto Shrinkable<T>::shrinks
+        () const -> std::vector<Shrinkable<T>>
+    {
+        return shrinks_ ? shrinks_() : std::vector<Shrinkable<T>>();
+    }
+
+    template<class T>
+    template<class F>
+    auto Shrinkable<T>::map
+        (F f) const -> Shrinkable<std::invoke_result_t<F, T const&>>
+    {
+        using U = std::invoke_result_t<F, T const&>;
+        auto value = std::invoke(f, value_);
+        return Shrinkable<U>(std::move(value), [source = *this, f]()
+        {
+            auto shrinks = std::vector<Shrinkable<U>>();
+            for (auto const& s : source.shrinks())
+            {
+                shrinks.push_back(s.map(f));
+            }
+            return shrinks;
+        });
+    }
+
+    template<class T>
+    template<class P>
+    auto Shrinkable<T>::filter
+        (P predicate) const -> Shrinkable<T>
+    {
+        return Shrinkable<T>(value_, [source = *this, predicate]()
+        {
+            auto shrinks = std::vector<Shrinkable<T>>();
+            for (auto const& s : source.shrinks())
+            {
+                if (std::invoke(predicate, s.value()))
+                {
+                    shrinks.push_back(s.filter(predicate));
+                }
+            }
+            return shrinks;
+        });
+    }
+
+// Generator:
+
+    template<class T>
+    Generator<T>::Generator
+        (generate_t generate) :
+        generate_ (std::move(generate))
+    {
+    }
+
+    template<class T>
+    auto Generator<T>::operator()
+        (Random& random, std::size_t const size) const -> Shrinkable<T>
+    {
+        return generate_(random, size);
+    }
+
+// PropertyTest:
+
+    template<class T>
+    PropertyTest<T>::PropertyTest
+        (std::string name, Generator<T> generator, PropertySettings settings) :
+        LeafTest   (std::move(name)),
+        generator_ (std::move(generator)),
+        settings_  (settings)
+    {
+    }
+
+    template<class T>
+    auto PropertyTest<T>::settings
+        () const -> PropertySettings const&
+    {
+        return settings_;
+    }
+
+    template<class T>
+    auto PropertyTest<T>::test
+        () -> void
+    {
+        auto const seed = details::property_seed(settings_, this->run_context());
+        auto const failing = details::find_failing_case(
+            this->run_context(),
+            settings_,
+            [this, seed](std::size_t const index)
+            {
+                auto const value = this->generate(seed, index);
+                return this->check_case(value.value()).has_value();
+            }
+        );
+
+        if (not failing)
+        {
+            this->pass(details::held_message(settings_.caseCount_, seed));
+            return;
+        }
+
+        auto const original = this->generate(seed, *failing);
+        auto current = original;
+        auto reason = this->check_case(current.value()).value_or("");
+        auto steps = std::size_t {0};
+        auto attempts = std::size_t {0};
+        auto shrunk = true;
+        while (shrunk && attempts < settings_.maxShrinkAttempts_)
+        {
+            shrunk = false;
+            for (auto& candidate : current.shrinks())
+            {
+                if (attempts++ == settings_.maxShrinkAttempts_)
+                {
+                    break;
+                }
+
+                if (auto failure = this->check_case(candidate.value()))
+                {
+                    current = std::move(candidate);
+                    reason = std::move(*failure);
+                    ++steps;
+                    shrunk = true;
+                    break;
+                }
+            }
+        }
+
+        this->fail(details::falsified_message(details::Falsification {
+            *failing,
+            seed,
+            details::print_value(current.value()),
+            details::print_value(original.value()),
+            std::move(reason),
+            steps
+        }));
+    }
+
+    template<class T>
+    auto PropertyTest<T>::generate
+        (std::uint64_t const seed, std::size_t const index) const -> Shrinkable<T>
+    {
+        auto random = Random(details::case_seed(seed, index));
+        return generator_(random, details::case_size(settings_, index));
+    }
+
+    template<class T>
+    auto PropertyTest<T>::check_case
+        (T const& value) -> std::optional<std::string>
+    {
+        try
+        {
+            if (this->property(value))
+            {
+                return std::nullopt;
+            }
+            return std::string("Property does not hold");
+        }
+        catch (std::exception const& e)
+        {
+            return std::string("Unhandled exception: ") + e.what();
+        }
+        catch (...)
+        {
+            return std::string("Unhandled exception.");
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,622 @@
+#include <librog/registry.hpp>
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <optional>
+#include <regex>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <librog/baseline.hpp>
+#include <librog/binary_log.hpp>
+#include <librog/reporters.hpp>
+#include <librog/sharding.hpp>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
+#elif defined(__APPLE__) || defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rog
+{
+    namespace
+    {
+        struct Registration
+        {
+            std::string path_;
+            LazyTest::factory_t factory_;
+        };
+
+        /**
+         *  \brief Returns registered tests. Constructed on first use,
+         *  so that registration works during static initialization.
+         */
+        auto registrations () -> std::vector<Registration>&
+        {
+            static auto rs = std::vector<Registration>();
+            return rs;
+        }
+
+        /**
+         *  \brief Paths of registered leaves and of the composites that
+         *  contain them.
+         */
+        struct RegisteredPaths
+        {
+            std::unordered_set<std::string> leaves_;
+            std::unordered_set<std::string> composites_;
+        };
+
+        auto registered_paths () -> RegisteredPaths&
+        {
+            static auto ps = RegisteredPaths();
+            return ps;
+        }
+
+        class RegisteredSuite : public CompositeTest
+        {
+        public:
+            RegisteredSuite (std::string name) :
+                CompositeTest (std::move(name))
+            {
+            }
+
+            using CompositeTest::add_test;
+        };
+
+        /**
+         *  \brief Node of the hierarchy before it is built. Composites are
+         *  built bottom-up so that their summaries count all leaves.
+         */
+        struct Node
+        {
+            std::string name_;
+            Registration const* leaf_ {nullptr};
+            std::vector<std::unique_ptr<Node>> children_ {};
+            std::unordered_map<std::string_view, Node*> composites_ {};
+        };
+
+        auto composite_child
+            (Node& parent, std::string_view const name) -> Node&
+        {
+            auto const it = parent.composites_.find(name);
+            if (it != parent.composites_.end())
+            {
+                return *it->second;
+            }
+
+            auto& child = parent.children_.emplace_back(
+                std::make_unique<Node>(Node {std::string(name)})
+            );
+            parent.composites_.emplace(child->name_, child.get());
+            return *child;
+        }
+
+        auto build (Node const& node) -> std::unique_ptr<CompositeTest>
+        {
+            auto suite = std::make_unique<RegisteredSuite>(node.name_);
+            for (auto const& child : node.children_)
+            {
+                if (child->leaf_)
+                {
+                    suite->add_test(child->name_, child->leaf_->factory_);
+                }
+                else
+                {
+                    suite->add_test(build(*child));
+                }
+            }
+            return suite;
+        }
+
+        auto open_output (std::string const& path) -> int
+        {
+#if defined(_WIN32) || defined(_WIN64)
+            return ::_open(
+                path.c_str(),
+                _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                _S_IREAD | _S_IWRITE
+            );
+#elif defined(__APPLE__) || defined(__linux__)
+            return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#else
+            static_cast<void>(path);
+            return -1;
+#endif
+        }
+
+        auto close_output (int const fd) -> void
+        {
+#if defined(_WIN32) || defined(_WIN64)
+            ::_close(fd);
+#elif defined(__APPLE__) || defined(__linux__)
+            ::close(fd);
+#else
+            static_cast<void>(fd);
+#endif
+        }
+
+        auto parse_count
+            (std::string_view const str) -> std::optional<unsigned int>
+        {
+            auto value = 0u;
+            auto const end = str.data() + str.size();
+            auto const [ptr, ec] = std::from_chars(str.data(), end, value);
+            return ec == std::errc() && ptr == end
+                ? std::optional<unsigned int>(value)
+                : std::nullopt;
+        }
+
+        /**
+         *  \brief Parses non-negative percentage into a fraction.
+         */
+        auto parse_percent
+            (std::string_view const str) -> std::optional<double>
+        {
+            auto value = 0.0;
+            auto const end = str.data() + str.size();
+            auto const [ptr, ec] = std::from_chars(str.data(), end, value);
+            return ec == std::errc() && ptr == end && std::isfinite(value) && value >= 0
+                ? std::optional<double>(value / 100)
+                : std::nullopt;
+        }
+
+        auto parse_seed
+            (std::string_view const str) -> std::optional<std::uint64_t>
+        {
+            auto value = std::uint64_t {0};
+            auto const end = str.data() + str.size();
+            auto const [ptr, ec] = std::from_chars(str.data(), end, value);
+            return ec == std::errc() && ptr == end
+                ? std::optional<std::uint64_t>(value)
+                : std::nullopt;
+        }
+
+        constexpr auto Usage = std::string_view(
+            "Options:\n"
+            "  --filter GLOB          run only tests whose path matches GLOB\n"
+            "  --exclude GLOB         skip tests whose path matches GLOB\n"
+            "  --filter-regex REGEX   run only tests whose path matches REGEX\n"
+            "  --exclude-regex REGEX  skip tests whose path matches REGEX\n"
+            "  --list                 print paths of the selected tests\n"
+            "  --shard-index I        run only shard I of the tests\n"
+            "  --shard-count N        split the tests into N shards\n"
+            "  --shard-timings FILE   balance shards by times in binary log FILE\n"
+            "  --threads N            run tests on N threads\n"
+            "  --processes N          run tests in N worker processes\n"
+            "  --coordinator SOCKET   hand out tests to workers connected to SOCKET,\n"
+            "                         --processes N starts N local workers\n"
+            "  --worker SOCKET        run tests handed out by coordinator at SOCKET\n"
+            "  --timeout SECONDS      fail tests that run longer than SECONDS\n"
+            "  --fail-fast            stop the run after the first failed test\n"
+            "  --max-failures N       stop the run after N failed tests\n"
+            "  --seed N               seed of property tests\n"
+            "  --perf-counters        count cycles, instructions, cache and branch\n"
+            "                         misses of each test with perf_event_open\n"
+            "  --baseline FILE        fail tests that regressed against binary log FILE\n"
+            "  --regression-threshold PERCENT\n"
+            "                         growth of baseline measurements taken as noise\n"
+            "  --full                 print messages of all tests\n"
+            "  --color auto|always|never\n"
+            "  --slowest N            print N slowest tests\n"
+            "  --junit FILE           write JUnit XML report into FILE\n"
+            "  --jsonl FILE           write JSON Lines report into FILE\n"
+            "  --tap FILE             write TAP report into FILE\n"
+            "  --log FILE             write binary log into FILE\n"
+            "  --help                 print this help\n"
+        );
+
+        auto usage_error (std::string_view const message) -> int
+        {
+            std::fprintf(
+                stderr,
+                "%.*s\n%.*s",
+                static_cast<int>(message.size()), message.data(),
+                static_cast<int>(Usage.size()), Usage.data()
+            );
+            return 2;
+        }
+    }
+
+    auto register_test
+        (std::string path, LazyTest::factory_t factory) -> bool
+    {
+        // A leaf can not share its path with another leaf nor with
+        // a composite, paths identify tests across runs and processes.
+        auto& paths = registered_paths();
+        auto const conflict = [&path](std::string_view const reason)
+        {
+            return std::invalid_argument(
+                "Test " + path + " can not be registered, " + std::string(reason)
+            );
+        };
+        if (paths.leaves_.contains(path))
+        {
+            throw conflict("the path is already registered");
+        }
+        if (paths.composites_.contains(path))
+        {
+            throw conflict("the path is already registered as a suite");
+        }
+        for (auto slash = path.find('/');
+             slash != std::string::npos;
+             slash = path.find('/', slash + 1))
+        {
+            if (paths.leaves_.contains(path.substr(0, slash)))
+            {
+                throw conflict("its suite is already registered as a test");
+            }
+        }
+
+        for (auto slash = path.find('/');
+             slash != std::string::npos;
+             slash = path.find('/', slash + 1))
+        {
+            paths.composites_.emplace(path, 0, slash);
+        }
+        paths.leaves_.emplace(path);
+        registrations().emplace_back(
+            Registration {std::move(path), std::move(factory)}
+        );
+        return true;
+    }
+
+    auto make_registered_tests
+        (TestFilter const& filter) -> std::unique_ptr<CompositeTest>
+    {
+        auto root = Node();
+        for (auto const& r : registrations())
+        {
+            if (not filter.selects_leaf(r.path_))
+            {
+                continue;
+            }
+
+            auto* parent = &root;
+            auto path = std::string_view(r.path_);
+            for (auto slash = path.find('/');
+                 slash != std::string_view::npos;
+                 slash = path.find('/'))
+            {
+                parent = &composite_child(*parent, path.substr(0, slash));
+                path.remove_prefix(slash + 1);
+            }
+
+            parent->children_.emplace_back(
+                std::make_unique<Node>(Node {std::string(path), &r})
+            );
+        }
+        return build(root);
+    }
+
+    auto run_main
+        (int const argc, char** const argv) -> int
+    {
+        auto settings = RunSettings();
+        auto output = ConsoleOutputType::NoLeaf;
+        auto color = ColorMode::Auto;
+        auto slowest = 0u;
+        auto list = false;
+        auto shardIndex = 0u;
+        auto shardCount = 1u;
+        auto timingsPath = std::string();
+        auto baselinePath = std::string();
+        auto regression = RegressionSettings();
+        auto workerSocket = std::string();
+        auto files = std::vector<std::pair<std::string_view, std::string>>();
+
+        try
+        {
+            for (auto i = 1; i < argc; ++i)
+            {
+                auto const arg = std::string_view(argv[i]);
+                auto const hasValue = i + 1 < argc;
+                auto const value = hasValue
+                    ? std::string_view(argv[i + 1])
+                    : std::string_view();
+
+                if (arg == "--help")
+                {
+                    std::fwrite(Usage.data(), 1, Usage.size(), stdout);
+                    return 0;
+                }
+                else if (arg == "--list")
+                {
+                    list = true;
+                    continue;
+                }
+                else if (arg == "--full")
+                {
+                    output = ConsoleOutputType::Full;
+                    continue;
+                }
+                else if (arg == "--fail-fast")
+                {
+                    settings.maxFailures_ = 1;
+                    continue;
+                }
+                else if (arg == "--perf-counters")
+                {
+                    settings.hardwareCounters_ = true;
+                    continue;
+                }
+
+                auto const takesValue =
+                    arg == "--filter" || arg == "--exclude"
+                 || arg == "--filter-regex" || arg == "--exclude-regex"
+                 || arg == "--threads" || arg == "--processes"
+                 || arg == "--slowest" || arg == "--color"
+                 || arg == "--timeout" || arg == "--max-failures"
+                 || arg == "--junit" || arg == "--jsonl"
+                 || arg == "--tap" || arg == "--log"
+                 || arg == "--shard-index" || arg == "--shard-count"
+                 || arg == "--shard-timings"
+                 || arg == "--coordinator" || arg == "--worker"
+                 || arg == "--seed" || arg == "--baseline"
+                 || arg == "--regression-threshold";
+                if (not takesValue)
+                {
+                    return usage_error("Unknown option " + std::string(arg));
+                }
+
+                if (not hasValue)
+                {
+                    return usage_error("Missing value of " + std::string(arg));
+                }
+                ++i;
+
+                if (arg == "--filter")
+                {
+                    settings.filter_.include(value);
+                }
+                else if (arg == "--exclude")
+                {
+                    settings.filter_.exclude(value);
+                }
+                else if (arg == "--filter-regex")
+                {
+                    settings.filter_.include_regex(value);
+                }
+                else if (arg == "--exclude-regex")
+                {
+                    settings.filter_.exclude_regex(value);
+                }
+                else if (arg == "--shard-timings")
+                {
+                    timingsPath = value;
+                }
+                else if (arg == "--baseline")
+                {
+                    baselinePath = value;
+                }
+                else if (arg == "--coordinator")
+                {
+                    settings.coordinatorSocket_ = value;
+                }
+                else if (arg == "--worker")
+                {
+                    workerSocket = value;
+                }
+                else if (arg == "--seed")
+                {
+                    settings.seed_ = parse_seed(value);
+                    if (not settings.seed_)
+                    {
+                        return usage_error("Invalid seed " + std::string(value));
+                    }
+                }
+                else if (arg == "--regression-threshold")
+                {
+                    auto const threshold = parse_percent(value);
+                    if (not threshold)
+                    {
+                        return usage_error("Invalid percentage " + std::string(value));
+                    }
+                    regression.threshold_ = *threshold;
+                }
+                else if (arg == "--threads" || arg == "--processes"
+                      || arg == "--slowest" || arg == "--shard-index"
+                      || arg == "--shard-count" || arg == "--timeout"
+                      || arg == "--max-failures")
+                {
+                    auto const count = parse_count(value);
+                    if (not count)
+                    {
+                        return usage_error("Invalid number " + std::string(value));
+                    }
+                    if (arg == "--threads")
+                    {
+                        settings.threadCount_ = *count;
+                    }
+                    else if (arg == "--processes")
+                    {
+                        settings.processCount_ = *count;
+                    }
+                    else if (arg == "--shard-index")
+                    {
+                        shardIndex = *count;
+                    }
+                    else if (arg == "--shard-count")
+                    {
+                        shardCount = *count;
+                    }
+                    else if (arg == "--timeout")
+                    {
+                        settings.timeout_ = std::chrono::seconds(*count);
+                    }
+                    else if (arg == "--max-failures")
+                    {
+                        settings.maxFailures_ = *count;
+                    }
+                    else
+                    {
+                        slowest = *count;
+                    }
+                }
+                else if (arg == "--color")
+                {
+                    if (value == "auto")
+                    {
+                        color = ColorMode::Auto;
+                    }
+                    else if (value == "always")
+                    {
+                        color = ColorMode::Always;
+                    }
+                    else if (value == "never")
+                    {
+                        color = ColorMode::Never;
+                    }
+                    else
+                    {
+                        return usage_error("Invalid color " + std::string(value));
+                    }
+                }
+                else
+                {
+                    files.emplace_back(arg, std::string(value));
+                }
+            }
+        }
+        catch (std::regex_error const& e)
+        {
+            return usage_error(std::string("Invalid regex: ") + e.what());
+        }
+
+        // Workers compare their leaves with the baseline too.
+        auto baseline = std::optional<Baseline>();
+        if (not baselinePath.empty())
+        {
+            auto const log = BinaryLog(baselinePath);
+            if (not log.is_open())
+            {
+                std::fprintf(stderr, "Can not read %s\n", baselinePath.c_str());
+                return 2;
+            }
+            baseline.emplace(log, regression);
+            settings.baseline_ = &*baseline;
+        }
+
+        if (not workerSocket.empty())
+        {
+            // The coordinator selects the tests.
+            auto root = make_registered_tests();
+            if (not run_as_worker(*root, workerSocket, settings))
+            {
+                std::fprintf(stderr, "Can not connect to %s\n", workerSocket.c_str());
+                return 2;
+            }
+            return 0;
+        }
+
+        if (shardCount == 0 || shardIndex >= shardCount)
+        {
+            return usage_error("Shard index must be less than shard count");
+        }
+
+        if (timingsPath.empty())
+        {
+            settings.filter_.shard(TestShard(shardIndex, shardCount));
+        }
+        else
+        {
+            auto const log = BinaryLog(timingsPath);
+            if (not log.is_open())
+            {
+                std::fprintf(stderr, "Can not read %s\n", timingsPath.c_str());
+                return 2;
+            }
+
+            // Shard is computed from the tests selected by the patterns.
+            auto paths = std::vector<std::string_view>();
+            for (auto const& r : registrations())
+            {
+                if (settings.filter_.selects_leaf(r.path_))
+                {
+                    paths.emplace_back(r.path_);
+                }
+            }
+            settings.filter_.shard(TestShard::balanced(
+                shardIndex,
+                shardCount,
+                paths,
+                read_timings(log)
+            ));
+        }
+
+        if (list)
+        {
+            auto console = Console(color);
+            for (auto const& r : registrations())
+            {
+                if (settings.filter_.selects_leaf(r.path_))
+                {
+                    console.println(r.path_);
+                }
+            }
+            return 0;
+        }
+
+        auto fds = std::vector<int>();
+        auto listeners = std::vector<std::unique_ptr<ITestListener>>();
+        listeners.emplace_back(
+            std::make_unique<StreamingConsoleReporter>(output, color, slowest)
+        );
+        for (auto const& [kind, path] : files)
+        {
+            auto const fd = open_output(path);
+            if (fd < 0)
+            {
+                for (auto const f : fds)
+                {
+                    close_output(f);
+                }
+                std::fprintf(stderr, "Can not open %s\n", path.c_str());
+                return 2;
+            }
+            fds.emplace_back(fd);
+
+            if (kind == "--junit")
+            {
+                listeners.emplace_back(std::make_unique<JUnitXmlReporter>(fd));
+            }
+            else if (kind == "--jsonl")
+            {
+                listeners.emplace_back(std::make_unique<JsonLinesReporter>(fd));
+            }
+            else if (kind == "--tap")
+            {
+                listeners.emplace_back(std::make_unique<TapReporter>(fd));
+            }
+            else
+            {
+                listeners.emplace_back(std::make_unique<BinaryLogWriter>(fd));
+            }
+        }
+
+        for (auto const& l : listeners)
+        {
+            settings.listeners_.emplace_back(l.get());
+        }
+
+        auto root = make_registered_tests(settings.filter_);
+        root->run(settings);
+        auto const summary = root->summary();
+
+        // Reporters flush on destruction, the files are closed after them.
+        listeners.clear();
+        for (auto const fd : fds)
+        {
+            close_output(fd);
+        }
+
+        return summary.fail_ + summary.partial_ > 0 ? 1 : 0;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef ROG_REGISTRY_HPP
+#define ROG_REGISTRY_HPP
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <librog/rog.hpp>
+
+namespace rog
+{
+    /**
+     *  \brief Registers factory of a leaf under \p path .
+     *
+     *  Path consists of names of composites joined by '/' followed by
+     *  the name of the leaf, e.g. "Suite/Group/Test". Nothing is built
+     *  when the test is registered. Can be called during static
+     *  initialization.
+     *  \param path path of the test.
+     *  \param factory creates the leaf.
+     *  \return true, so that the result can initialize a static variable.
+     *  \throws std::invalid_argument if \p path is already registered,
+     *  or if it is the path of a suite of a registered test or vice versa.
+     */
+    auto register_test (std::string path, LazyTest::factory_t factory) -> bool;
+
+    /**
+     *  \brief Builds hierarchy of the registered tests selected
+     *  by \p filter . Composites are created only for the selected tests
+     *  and leaves are built only when they run, see \c LazyTest .
+     *  The root has an empty name, so the paths of the tests are
+     *  the paths they were registered under.
+     *  \param filter selects the tests.
+     *  \return Root of the hierarchy.
+     */
+    auto make_registered_tests
+        (TestFilter const& filter = TestFilter()) -> std::unique_ptr<CompositeTest>;
+
+    /**
+     *  \brief Runs the registered tests as configured by command line
+     *  arguments. Run with --help to list the options.
+     *  \param argc number of arguments.
+     *  \param argv arguments.
+     *  \return 0 if no test failed, 1 if some test failed,
+     *  2 if the arguments are not valid.
+     */
+    auto run_main (int argc, char** argv) -> int;
+
+    /**
+     *  \brief Registers test \c T during static initialization, e.g.
+     *  static auto const r = RegisterTest<MyTest>("Suite/MyTest");
+     *  The test is built from copies of the arguments.
+     */
+    template<class T>
+    class RegisterTest
+    {
+    public:
+        template<class... Args>
+        explicit RegisterTest (std::string path, Args... args)
+        {
+            register_test(
+                std::move(path),
+                [args = std::make_tuple(std::move(args)...)]()
+                {
+                    return std::apply(
+                        [](auto const&... as)
+                        {
+                            return std::unique_ptr<LeafTest>(
+                                std::make_unique<T>(as...)
+                            );
+                        },
+                        args
+                    );
+                }
+            );
+        }
+    };
+}
+
+#endif
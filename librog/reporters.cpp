@@ -0,0 +1,588 @@
+#include <librog/reporters.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <librog/benchmark.hpp>
+#include <librog/rog.hpp>
+
+namespace rog
+{
+    namespace
+    {
+        auto result_to_string (TestResult const result) -> std::string_view
+        {
+            switch (result)
+            {
+            case TestResult::Pass:
+                return "pass";
+
+            case TestResult::Fail:
+                return "fail";
+
+            case TestResult::Partial:
+                return "partial";
+
+            default:
+                return "skipped";
+            }
+        }
+
+        auto message_type_to_string (TestMessageType const type) -> std::string_view
+        {
+            switch (type)
+            {
+            case TestMessageType::Pass:
+                return "pass";
+
+            case TestMessageType::Fail:
+                return "fail";
+
+            default:
+                return "info";
+            }
+        }
+
+        auto format_double
+            (char const* format, double const value) -> std::string
+        {
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), format, value);
+            return buffer;
+        }
+
+        auto seconds (std::chrono::nanoseconds const d) -> std::string
+        {
+            return format_double(
+                "%.6f",
+                std::chrono::duration<double>(d).count()
+            );
+        }
+
+        auto milliseconds (std::chrono::nanoseconds const d) -> std::string
+        {
+            return format_double(
+                "%.3f",
+                std::chrono::duration<double, std::milli>(d).count()
+            );
+        }
+
+        /**
+         *  \brief Returns path of the parent of the test at \p path .
+         */
+        auto parent_path
+            (Test const& t, std::string_view const path) -> std::string_view
+        {
+            auto const size = t.name().size() + 1;
+            return path.size() > size
+                ? path.substr(0, path.size() - size)
+                : std::string_view();
+        }
+    }
+
+// JUnitXmlReporter:
+
+    JUnitXmlReporter::JUnitXmlReporter
+        (int const fd) :
+        out_ (fd)
+    {
+    }
+
+    auto JUnitXmlReporter::on_run_started
+        (Test const& t) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        out_.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+        out_.write("<testsuites>\n");
+        out_.write("  <testsuite name=\"");
+        out_.write_xml_escaped(t.name());
+        out_.write("\">\n");
+    }
+
+    auto JUnitXmlReporter::on_run_finished
+        (Test const&) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        out_.write("  </testsuite>\n");
+        out_.write("</testsuites>\n");
+        out_.flush();
+    }
+
+    auto JUnitXmlReporter::on_test_finished
+        (LeafTest const& t, std::string_view const path) -> void
+    {
+        auto const result = t.result();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_testcase_start(t, path);
+        out_.write("        <property name=\"passed\" value=\"");
+        out_.write(std::to_string(t.pass_count()));
+        out_.write("\"/>\n");
+        out_.write("        <property name=\"failed\" value=\"");
+        out_.write(std::to_string(t.fail_count()));
+        out_.write("\"/>\n");
+        if constexpr (details::TrackAllocations)
+        {
+            out_.write("        <property name=\"allocations\" value=\"");
+            out_.write(std::to_string(t.allocations().count_));
+            out_.write("\"/>\n");
+            out_.write("        <property name=\"leaked_bytes\" value=\"");
+            out_.write(std::to_string(t.allocations().leakedBytes_));
+            out_.write("\"/>\n");
+        }
+        for (auto const& [name, value] : details::counter_fields(t.hardware_counters()))
+        {
+            if (value)
+            {
+                out_.write("        <property name=\"");
+                out_.write(name);
+                out_.write("\" value=\"");
+                out_.write(std::to_string(*value));
+                out_.write("\"/>\n");
+            }
+        }
+        out_.write("      </properties>\n");
+
+        if (result == TestResult::NotEvaluated)
+        {
+            out_.write("      <skipped/>\n");
+        }
+        else if (result == TestResult::Fail || result == TestResult::Partial)
+        {
+            out_.write("      <failure type=\"assertion\" message=\"");
+            out_.write(std::to_string(t.fail_count()));
+            out_.write(" of ");
+            out_.write(std::to_string(t.pass_count() + t.fail_count()));
+            out_.write(" assertions failed\">");
+            for (auto const& m : t.output())
+            {
+                if (m.type_ == TestMessageType::Fail)
+                {
+                    out_.write_xml_escaped(m.text_);
+                    out_.write('\n');
+                }
+            }
+            out_.write("</failure>\n");
+        }
+
+        auto hasOutput = false;
+        for (auto const& m : t.output())
+        {
+            if (m.type_ != TestMessageType::Fail)
+            {
+                if (not hasOutput)
+                {
+                    out_.write("      <system-out>");
+                    hasOutput = true;
+                }
+                out_.write(message_type_to_string(m.type_));
+                out_.write(' ');
+                out_.write_xml_escaped(m.text_);
+                out_.write('\n');
+            }
+        }
+        if (hasOutput)
+        {
+            out_.write("</system-out>\n");
+        }
+
+        out_.write("    </testcase>\n");
+    }
+
+    auto JUnitXmlReporter::on_benchmark_finished
+        (BenchmarkTest const& t, std::string_view const path) -> void
+    {
+        auto const& s = t.stats();
+        auto const property = [this](std::string_view name, std::string const& value)
+        {
+            out_.write("        <property name=\"");
+            out_.write(name);
+            out_.write("\" value=\"");
+            out_.write(value);
+            out_.write("\"/>\n");
+        };
+
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_testcase_start(t, path);
+        property("iterations", std::to_string(s.iterations_));
+        property("samples", std::to_string(s.samples_));
+        property("mean_ns", format_double("%.3f", s.mean_.count()));
+        property("median_ns", format_double("%.3f", s.median_.count()));
+        property("stddev_ns", format_double("%.3f", s.stddev_.count()));
+        property("min_ns", format_double("%.3f", s.min_.count()));
+        property("items_per_second", format_double("%.3f", s.itemsPerSecond_));
+        property("bytes_per_second", format_double("%.3f", s.bytesPerSecond_));
+        for (auto const& [name, value] : details::counter_fields(t.hardware_counters()))
+        {
+            if (value)
+            {
+                property(name, std::to_string(*value));
+            }
+        }
+        out_.write("      </properties>\n");
+
+        if (t.result() == TestResult::NotEvaluated)
+        {
+            out_.write("      <skipped/>\n");
+        }
+        else if (not t.error().empty())
+        {
+            out_.write("      <error message=\"");
+            out_.write_xml_escaped(t.error());
+            out_.write("\"/>\n");
+        }
+        else if (not t.regression().empty())
+        {
+            out_.write("      <failure type=\"regression\" message=\"");
+            out_.write_xml_escaped(t.regression());
+            out_.write("\"/>\n");
+        }
+
+        out_.write("    </testcase>\n");
+    }
+
+    auto JUnitXmlReporter::write_testcase_start
+        (Test const& t, std::string_view const path) -> void
+    {
+        out_.write("    <testcase classname=\"");
+        out_.write_xml_escaped(parent_path(t, path));
+        out_.write("\" name=\"");
+        out_.write_xml_escaped(t.name());
+        out_.write("\" time=\"");
+        out_.write(seconds(t.wall_time()));
+        out_.write("\">\n");
+        out_.write("      <properties>\n");
+        out_.write("        <property name=\"cpu_time\" value=\"");
+        out_.write(seconds(t.cpu_time()));
+        out_.write("\"/>\n");
+    }
+
+// JsonLinesReporter:
+
+    JsonLinesReporter::JsonLinesReporter
+        (int const fd) :
+        out_ (fd),
+        count_ (0)
+    {
+    }
+
+    auto JsonLinesReporter::on_run_started
+        (Test const& t) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        count_ = 0;
+        this->write_event("run_started");
+        this->write_string("name", t.name());
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::on_run_finished
+        (Test const& t) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_event("run_finished");
+        this->write_string("name", t.name());
+        this->write_number("tests", std::to_string(count_));
+        this->write_summary(t);
+        out_.write("}\n");
+        out_.flush();
+    }
+
+    auto JsonLinesReporter::on_test_started
+        (LeafTest const&, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_event("test_started");
+        this->write_string("path", path);
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::on_assertion_failed
+        ( LeafTest const&
+        , std::string_view const path
+        , TestMessage const& message ) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_event("assertion_failed");
+        this->write_string("path", path);
+        this->write_string("text", message.text_);
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::on_test_finished
+        (LeafTest const& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        ++count_;
+        this->write_event("test_finished");
+        this->write_string("path", path);
+        this->write_string("result", result_to_string(t.result()));
+        this->write_number("wall_ns", std::to_string(t.wall_time().count()));
+        this->write_number("cpu_ns", std::to_string(t.cpu_time().count()));
+        this->write_number("passed", std::to_string(t.pass_count()));
+        this->write_number("failed", std::to_string(t.fail_count()));
+        if constexpr (details::TrackAllocations)
+        {
+            auto const& a = t.allocations();
+            this->write_number("allocations", std::to_string(a.count_));
+            this->write_number("allocated_bytes", std::to_string(a.bytes_));
+            this->write_number("peak_bytes", std::to_string(a.peakBytes_));
+            this->write_number("leaked_bytes", std::to_string(a.leakedBytes_));
+        }
+        this->write_counters(t);
+        out_.write(",\"messages\":[");
+        auto first = true;
+        for (auto const& m : t.output())
+        {
+            out_.write(first ? "{\"type\":\"" : ",{\"type\":\"");
+            out_.write(message_type_to_string(m.type_));
+            out_.write("\",\"text\":\"");
+            out_.write_json_escaped(m.text_);
+            out_.write("\"}");
+            first = false;
+        }
+        out_.write("]}\n");
+    }
+
+    auto JsonLinesReporter::on_composite_started
+        (CompositeTest const&, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_event("composite_started");
+        this->write_string("path", path);
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::on_composite_finished
+        (CompositeTest const& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_event("composite_finished");
+        this->write_string("path", path);
+        this->write_summary(t);
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::on_benchmark_started
+        (BenchmarkTest const&, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_event("benchmark_started");
+        this->write_string("path", path);
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::on_benchmark_finished
+        (BenchmarkTest const& t, std::string_view const path) -> void
+    {
+        auto const& s = t.stats();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        ++count_;
+        this->write_event("benchmark_finished");
+        this->write_string("path", path);
+        this->write_string("result", result_to_string(t.result()));
+        if (not t.error().empty())
+        {
+            this->write_string("error", t.error());
+        }
+        if (not t.regression().empty())
+        {
+            this->write_string("regression", t.regression());
+        }
+        this->write_number("wall_ns", std::to_string(t.wall_time().count()));
+        this->write_number("cpu_ns", std::to_string(t.cpu_time().count()));
+        this->write_number("iterations", std::to_string(s.iterations_));
+        this->write_number("samples", std::to_string(s.samples_));
+        this->write_number("mean_ns", format_double("%.3f", s.mean_.count()));
+        this->write_number("median_ns", format_double("%.3f", s.median_.count()));
+        this->write_number("stddev_ns", format_double("%.3f", s.stddev_.count()));
+        this->write_number("min_ns", format_double("%.3f", s.min_.count()));
+        this->write_number("items_per_second", format_double("%.3f", s.itemsPerSecond_));
+        this->write_number("bytes_per_second", format_double("%.3f", s.bytesPerSecond_));
+        this->write_counters(t);
+        out_.write("}\n");
+    }
+
+    auto JsonLinesReporter::write_event
+        (std::string_view const event) -> void
+    {
+        out_.write("{\"event\":\"");
+        out_.write(event);
+        out_.write('"');
+    }
+
+    auto JsonLinesReporter::write_string
+        (std::string_view const key, std::string_view const value) -> void
+    {
+        out_.write(",\"");
+        out_.write(key);
+        out_.write("\":\"");
+        out_.write_json_escaped(value);
+        out_.write('"');
+    }
+
+    auto JsonLinesReporter::write_number
+        (std::string_view const key, std::string_view const value) -> void
+    {
+        out_.write(",\"");
+        out_.write(key);
+        out_.write("\":");
+        out_.write(value);
+    }
+
+    auto JsonLinesReporter::write_summary
+        (Test const& t) -> void
+    {
+        auto const s = t.summary();
+        this->write_string("result", result_to_string(t.result()));
+        this->write_number("wall_ns", std::to_string(t.wall_time().count()));
+        this->write_number("cpu_ns", std::to_string(t.cpu_time().count()));
+        this->write_number("passed", std::to_string(s.pass_));
+        this->write_number("failed", std::to_string(s.fail_));
+        this->write_number("partial", std::to_string(s.partial_));
+        this->write_number("skipped", std::to_string(s.notEvaluated_));
+    }
+
+    auto JsonLinesReporter::write_counters
+        (Test const& t) -> void
+    {
+        for (auto const& [name, value] : details::counter_fields(t.hardware_counters()))
+        {
+            if (value)
+            {
+                this->write_number(name, std::to_string(*value));
+            }
+        }
+    }
+
+// TapReporter:
+
+    TapReporter::TapReporter
+        (int const fd) :
+        out_ (fd),
+        count_ (0)
+    {
+    }
+
+    auto TapReporter::on_run_started
+        (Test const&) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        count_ = 0;
+        out_.write("TAP version 13\n");
+    }
+
+    auto TapReporter::on_run_finished
+        (Test const&) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        out_.write("1..");
+        out_.write(std::to_string(count_));
+        out_.write('\n');
+        out_.flush();
+    }
+
+    auto TapReporter::on_test_finished
+        (LeafTest const& t, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_test_point(t, path);
+        out_.write("  passed: ");
+        out_.write(std::to_string(t.pass_count()));
+        out_.write("\n  failed: ");
+        out_.write(std::to_string(t.fail_count()));
+        out_.write('\n');
+        for (auto const& [name, value] : details::counter_fields(t.hardware_counters()))
+        {
+            if (value)
+            {
+                out_.write("  ");
+                out_.write(name);
+                out_.write(": ");
+                out_.write(std::to_string(*value));
+                out_.write('\n');
+            }
+        }
+
+        auto hasFailures = false;
+        for (auto const& m : t.output())
+        {
+            if (m.type_ == TestMessageType::Fail)
+            {
+                if (not hasFailures)
+                {
+                    out_.write("  failures:\n");
+                    hasFailures = true;
+                }
+                // YAML double-quoted scalars accept JSON escapes.
+                out_.write("    - \"");
+                out_.write_json_escaped(m.text_);
+                out_.write("\"\n");
+            }
+        }
+        out_.write("  ...\n");
+    }
+
+    auto TapReporter::on_benchmark_finished
+        (BenchmarkTest const& t, std::string_view const path) -> void
+    {
+        auto const& s = t.stats();
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        this->write_test_point(t, path);
+        if (not t.error().empty())
+        {
+            out_.write("  error: \"");
+            out_.write_json_escaped(t.error());
+            out_.write("\"\n");
+        }
+        if (not t.regression().empty())
+        {
+            out_.write("  regression: \"");
+            out_.write_json_escaped(t.regression());
+            out_.write("\"\n");
+        }
+        out_.write("  iterations: ");
+        out_.write(std::to_string(s.iterations_));
+        out_.write("\n  samples: ");
+        out_.write(std::to_string(s.samples_));
+        out_.write("\n  mean_ns: ");
+        out_.write(format_double("%.3f", s.mean_.count()));
+        out_.write("\n  median_ns: ");
+        out_.write(format_double("%.3f", s.median_.count()));
+        out_.write("\n  stddev_ns: ");
+        out_.write(format_double("%.3f", s.stddev_.count()));
+        out_.write("\n  min_ns: ");
+        out_.write(format_double("%.3f", s.min_.count()));
+        out_.write("\n  ...\n");
+    }
+
+    auto TapReporter::write_test_point
+        (Test const& t, std::string_view const path) -> void
+    {
+        auto const result = t.result();
+        ++count_;
+        out_.write(
+            result == TestResult::Pass || result == TestResult::NotEvaluated
+                ? "ok "
+                : "not ok "
+        );
+        out_.write(std::to_string(count_));
+        out_.write(" - ");
+        for (auto const c : path)
+        {
+            if (c == '#')
+            {
+                out_.write('\\');
+            }
+            out_.write(c == '\n' ? ' ' : c);
+        }
+        if (result == TestResult::NotEvaluated)
+        {
+            out_.write(" # SKIP not evaluated");
+        }
+        out_.write("\n  ---\n  duration_ms: ");
+        out_.write(milliseconds(t.wall_time()));
+        out_.write("\n  cpu_ms: ");
+        out_.write(milliseconds(t.cpu_time()));
+        out_.write('\n');
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef ROG_REPORTERS_HPP
+#define ROG_REPORTERS_HPP
+
+#include <librog/details/file_writer.hpp>
+#include <librog/listeners.hpp>
+#include <cstddef>
+#include <mutex>
+
+namespace rog
+{
+    /**
+     *  \brief Writes results in the JUnit XML format to a file descriptor.
+     *
+     *  Each leaf and benchmark is written as a testcase as soon as it
+     *  finishes, its \c classname is the path of its parent. Since the
+     *  output is streamed, numbers of tests and failures are left
+     *  for the consumer to count. Does not own the descriptor.
+     */
+    class JUnitXmlReporter : public ITestListener
+    {
+    public:
+        explicit JUnitXmlReporter (int fd);
+        auto on_run_started (Test const&) -> void override;
+        auto on_run_finished (Test const&) -> void override;
+        auto on_test_finished (LeafTest const&, std::string_view) -> void override;
+        auto on_benchmark_finished
+            (BenchmarkTest const&, std::string_view) -> void override;
+
+    private:
+        auto write_testcase_start (Test const&, std::string_view) -> void;
+
+    private:
+        std::mutex mutex_;
+        details::FileWriter out_;
+    };
+
+    /**
+     *  \brief Writes every event as a single line JSON object
+     *  to a file descriptor. The end of the run carries the number
+     *  of leaves and benchmarks that finished. Does not own the descriptor.
+     */
+    class JsonLinesReporter : public ITestListener
+    {
+    public:
+        explicit JsonLinesReporter (int fd);
+        auto on_run_started (Test const&) -> void override;
+        auto on_run_finished (Test const&) -> void override;
+        auto on_test_started (LeafTest const&, std::string_view) -> void override;
+        auto on_assertion_failed
+            (LeafTest const&, std::string_view, TestMessage const&) -> void override;
+        auto on_test_finished (LeafTest const&, std::string_view) -> void override;
+        auto on_composite_started
+            (CompositeTest const&, std::string_view) -> void override;
+        auto on_composite_finished
+            (CompositeTest const&, std::string_view) -> void override;
+        auto on_benchmark_started
+            (BenchmarkTest const&, std::string_view) -> void override;
+        auto on_benchmark_finished
+            (BenchmarkTest const&, std::string_view) -> void override;
+
+    private:
+        auto write_event (std::string_view event) -> void;
+        auto write_string (std::string_view key, std::string_view value) -> void;
+        auto write_number (std::string_view key, std::string_view value) -> void;
+        auto write_summary (Test const&) -> void;
+        auto write_counters (Test const&) -> void;
+
+    private:
+        std::mutex mutex_;
+        details::FileWriter out_;
+        std::size_t count_;
+    };
+
+    /**
+     *  \brief Writes results in the Test Anything Protocol (version 13)
+     *  to a file descriptor. Timing and counters of each test point are
+     *  written in its YAML block, the plan is written at the end of the run.
+     *  Does not own the descriptor.
+     */
+    class TapReporter : public ITestListener
+    {
+    public:
+        explicit TapReporter (int fd);
+        auto on_run_started (Test const&) -> void override;
+        auto on_run_finished (Test const&) -> void override;
+        auto on_test_finished (LeafTest const&, std::string_view) -> void override;
+        auto on_benchmark_finished
+            (BenchmarkTest const&, std::string_view) -> void override;
+
+    private:
+        auto write_test_point (Test const&, std::string_view) -> void;
+
+    private:
+        std::mutex mutex_;
+        details::FileWriter out_;
+        std::size_t count_;
+    };
+}
+
+#endif
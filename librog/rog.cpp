@@ -1,18 +1,68 @@
 #include <librog/rog.hpp>
+#include <librog/baseline.hpp>
+#include <librog/benchmark.hpp>
+#include <librog/details/cancellation.hpp>
 #include <librog/details/console_output.hpp>
+#include <librog/details/coordinator.hpp>
+#include <librog/details/isolated_runner.hpp>
+#include <librog/details/run_context.hpp>
+#include <librog/details/test_access.hpp>
+#include <librog/details/thread_pool.hpp>
+#include <librog/details/timing.hpp>
+#include <librog/details/watchdog.hpp>
 
 #include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <ranges>
 #include <exception>
+#include <mutex>
 
 namespace rog
 {
+    namespace
+    {
+        auto count_of (TestSummary& s, TestResult const r) -> std::size_t&
+        {
+            switch (r)
+            {
+            case TestResult::Pass:
+                return s.pass_;
+
+            case TestResult::Fail:
+                return s.fail_;
+
+            case TestResult::Partial:
+                return s.partial_;
+
+            default:
+                return s.notEvaluated_;
+            }
+        }
+
+        auto leaf_count (TestSummary const& s) -> std::size_t
+        {
+            return s.pass_ + s.fail_ + s.partial_ + s.notEvaluated_;
+        }
+
+        auto add (TestSummary& lhs, TestSummary const& rhs) -> void
+        {
+            lhs.pass_ += rhs.pass_;
+            lhs.fail_ += rhs.fail_;
+            lhs.partial_ += rhs.partial_;
+            lhs.notEvaluated_ += rhs.notEvaluated_;
+        }
+    }
+
 // Test:
 
     Test::Test
         (std::string name) :
-        name_ (std::move(name))
+        name_ (std::move(name)),
+        wallTime_ (0),
+        cpuTime_ (0),
+        counters_ (),
+        timeout_ (std::nullopt)
     {
     }
 
@@ -22,6 +72,132 @@ namespace rog
         return name_;
     }
 
+    auto Test::wall_time
+        () const -> std::chrono::nanoseconds
+    {
+        return wallTime_;
+    }
+
+    auto Test::cpu_time
+        () const -> std::chrono::nanoseconds
+    {
+        return cpuTime_;
+    }
+
+    auto Test::hardware_counters
+        () const -> HardwareCounters const&
+    {
+        return counters_;
+    }
+
+    auto Test::set_timeout
+        (std::chrono::nanoseconds const limit) -> void
+    {
+        timeout_ = limit;
+    }
+
+    auto Test::timeout
+        () const -> std::optional<std::chrono::nanoseconds>
+    {
+        return timeout_;
+    }
+
+    auto Test::set_times
+        ( std::chrono::nanoseconds const wall
+        , std::chrono::nanoseconds const cpu ) -> void
+    {
+        wallTime_ = wall;
+        cpuTime_ = cpu;
+    }
+
+    auto Test::set_hardware_counters
+        (HardwareCounters const& counters) -> void
+    {
+        counters_ = counters;
+    }
+
+    auto Test::run
+        () -> void
+    {
+        this->run(RunSettings());
+    }
+
+    namespace
+    {
+        auto is_selected
+            (Test const& t, std::string_view const path, TestFilter const& f)
+            -> bool
+        {
+            if (f.empty())
+            {
+                return true;
+            }
+            return dynamic_cast<CompositeTest const*>(&t)
+                ? f.selects_composite(path)
+                : f.selects_leaf(path);
+        }
+
+        auto is_cancelled (details::RunContext const& context) -> bool
+        {
+            return context.cancel_ && context.cancel_->is_cancelled();
+        }
+    }
+
+    auto Test::run
+        (RunSettings const& settings) -> void
+    {
+        auto const coordinated = not settings.coordinatorSocket_.empty();
+        auto const isolated = settings.processCount_ > 0;
+        auto pool = std::optional<details::ThreadPool>();
+        if (settings.threadCount_ > 1 && not isolated && not coordinated)
+        {
+            pool.emplace(settings.threadCount_);
+        }
+
+        // Leaves in worker processes are stopped by their parent.
+        auto watchdog = std::optional<details::Watchdog>();
+        if (not isolated && not coordinated)
+        {
+            watchdog.emplace(*this);
+        }
+
+        auto cancellation = details::CancellationToken(settings.maxFailures_);
+        auto context = details::RunContext {
+            &settings,
+            pool ? &*pool : nullptr,
+            std::string(this->name()),
+            settings.timeout_,
+            watchdog ? &*watchdog : nullptr,
+            &cancellation
+        };
+
+        for (auto* l : settings.listeners_)
+        {
+            l->on_run_started(*this);
+        }
+
+        if (is_selected(*this, context.path_, settings.filter_))
+        {
+            if (coordinated)
+            {
+                details::run_coordinator(*this, context);
+            }
+            else if (isolated)
+            {
+                details::run_isolated(*this, context);
+            }
+            else
+            {
+                this->run(context);
+            }
+        }
+
+        for (auto* l : settings.listeners_)
+        {
+            l->on_run_finished(*this);
+        }
+    }
+
 // LeafTest:
 
     namespace
@@ -29,67 +205,367 @@ namespace rog
         struct test_failed_exception
         {
         };
+
+        struct test_cancelled_exception
+        {
+        };
+
+        /**
+         *  \brief Returns message \p m made by a test for the test to keep.
+         *  With allocation tracking, it is copied under the caller's
+         *  \c AllocationPause , so that the message made by the test is
+         *  deallocated and not reported as a leak. It is moved otherwise.
+         */
+        auto kept_message (std::string& m) -> std::string
+        {
+            if constexpr (details::TrackAllocations)
+            {
+                return std::string(m);
+            }
+            else
+            {
+                return std::move(m);
+            }
+        }
+
+        /**
+         *  \brief Holds results of a leaf that no longer exists.
+         */
+        class LeafSnapshot : public LeafTest
+        {
+        public:
+            LeafSnapshot (std::string name) :
+                LeafTest (std::move(name))
+            {
+            }
+
+            /**
+             *  \brief Returns result of the leaf the snapshot was taken
+             *  from if it is kept, e.g. a leaf with only info messages
+             *  passed although none of them is kept.
+             */
+            auto result () const -> TestResult override
+            {
+                return result_.value_or(LeafTest::result());
+            }
+
+            auto keep_result (std::optional<TestResult> const result) -> void
+            {
+                result_ = result;
+            }
+
+        protected:
+            auto test () -> void override
+            {
+            }
+
+        private:
+            std::optional<TestResult> result_;
+        };
+
+        /**
+         *  \brief Returns the running composite of \p open that contains
+         *  \p t at \p path , null if there is none.
+         */
+        auto find_parent
+            ( std::vector<details::Watchdog::open_t> const& open
+            , Test const&                                   t
+            , std::string_view const                        path ) -> CompositeTest*
+        {
+            auto const slash = path.rfind('/');
+            auto const parentPath = slash == std::string_view::npos
+                ? std::string_view()
+                : path.substr(0, slash);
+            for (auto const& [p, c, start] : open)
+            {
+                if (p != parentPath)
+                {
+                    continue;
+                }
+
+                for (auto const& st : c->subtests())
+                {
+                    // Leaves built by lazy tests are not in the hierarchy.
+                    if (st.get() == &t
+                     || (dynamic_cast<LazyTest const*>(st.get()) && st->name() == t.name()))
+                    {
+                        return c;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         *  \brief Reports leaf \p t that exceeded its time limit as failed,
+         *  finishes the run and exits. The leaf keeps running, so its state
+         *  can not be read. The listeners receive a snapshot instead.
+         *  Other threads are stopped at their next event, and composites
+         *  that are still running are finished from the innermost one,
+         *  so that the reports stay well-formed.
+         */
+        [[noreturn]] auto abort_timed_out
+            ( LeafTest const&                 t
+            , details::RunContext const&      context
+            , std::chrono::nanoseconds const  elapsed
+            , std::chrono::nanoseconds const  limit ) -> void
+        {
+            // Never unlocked, the process exits while holding it.
+            auto& watchdog = *context.watchdog_;
+            watchdog.events().lock();
+            if (context.cancel_)
+            {
+                context.cancel_->cancel();
+            }
+
+            auto snapshot = LeafSnapshot(std::string(t.name()));
+            auto& messages = details::TestAccess::messages(snapshot);
+            messages.emplace_back(TestMessage {
+                TestMessageType::Fail,
+                details::timeout_message(elapsed, limit)
+            });
+            details::TestAccess::fail_count(snapshot) = 1;
+            details::TestAccess::set_times(snapshot, elapsed, std::chrono::nanoseconds(0));
+
+            auto const& listeners = context.settings_->listeners_;
+            for (auto* l : listeners)
+            {
+                l->on_assertion_failed(snapshot, context.path_, messages.front());
+            }
+            for (auto* l : listeners)
+            {
+                l->on_test_finished(snapshot, context.path_);
+            }
+
+            // Each finished test counts in its parent, as in a regular run.
+            auto const open = watchdog.open_composites();
+            if (auto* parent = find_parent(open, t, context.path_))
+            {
+                details::TestAccess::subtest_finished(*parent, snapshot);
+            }
+
+            auto const now = details::Watchdog::clock_t::now();
+            for (auto const& [path, c, start] : open)
+            {
+                details::TestAccess::set_times(
+                    *c,
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - start),
+                    c->cpu_time()
+                );
+                for (auto* l : listeners)
+                {
+                    l->on_composite_finished(*c, path);
+                }
+                if (auto* parent = find_parent(open, *c, path))
+                {
+                    details::TestAccess::subtest_finished(*parent, *c);
+                }
+            }
+
+            // A root that is not a composite is the leaf itself.
+            auto const& root = open.empty()
+                ? static_cast<Test const&>(snapshot)
+                : watchdog.root();
+            for (auto* l : listeners)
+            {
+                l->on_run_finished(root);
+            }
+
+            std::fprintf(
+                stderr,
+                "%s: %s, aborting the run.\n",
+                context.path_.c_str(),
+                messages.front().text_.c_str()
+            );
+            std::cout.flush();
+            std::fflush(nullptr);
+            std::_Exit(EXIT_FAILURE);
+        }
     }
 
     LeafTest::LeafTest
-        (std::string name, AssertPolicy policy) :
+        ( std::string        name
+        , AssertPolicy const policy
+        , RecordPolicy const record
+        , std::size_t const  failureLimit ) :
         rog::Test::Test (std::move(name)),
-        assertPolicy_ (policy)
+        context_ (nullptr),
+        cancelled_ (nullptr),
+        passCount_ (0),
+        failCount_ (0),
+        assertPolicy_ (policy),
+        recordPolicy_ (record),
+        activeRecordPolicy_ (record),
+        failureLimit_ (failureLimit),
+        keptFailures_ (0),
+        omittedFailures_ (0)
     {
     }
 
     auto LeafTest::run
-        () -> void
+        (details::RunContext& context) -> void
     {
+        results_.clear();
+        passCount_ = 0;
+        failCount_ = 0;
+        keptFailures_ = 0;
+        omittedFailures_ = 0;
+        lastFailures_.clear();
+        activeRecordPolicy_ = context.settings_->recordPolicy_ == RecordPolicy::RecordAll
+            ? recordPolicy_
+            : RecordPolicy::CountersOnly;
+        context_ = &context;
+        cancelled_ = context.cancel_ ? &context.cancel_->flag() : nullptr;
+
+        {
+            auto const events = details::lock_events(context);
+            for (auto* l : context.settings_->listeners_)
+            {
+                l->on_test_started(*this, context.path_);
+            }
+        }
+
+        auto const wallStart = std::chrono::steady_clock::now();
+        auto const cpuStart = details::thread_cpu_time();
+
+        auto const limit = this->timeout().value_or(context.timeout_);
+        auto ticket = std::optional<details::Watchdog::Ticket>();
+        if (context.watchdog_ && limit > std::chrono::nanoseconds::zero())
+        {
+            ticket = context.watchdog_->arm(
+                wallStart + limit,
+                [this, &context, wallStart, limit]()
+                {
+                    abort_timed_out(
+                        *this,
+                        context,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - wallStart
+                        ),
+                        limit
+                    );
+                }
+            );
+        }
+
+        auto counters = details::HardwareCounterScope(
+            context.settings_->hardwareCounters_
+        );
+        auto allocations = details::AllocationScope();
+        auto cancelled = false;
         try
         {
-            results_.clear();
             this->test();
         }
         catch (test_failed_exception)
         {
             this->info("Terminated after failed assertion.");
         }
+        catch (test_cancelled_exception)
+        {
+            // The test did not finish, so it is not evaluated.
+            auto const pause = details::AllocationPause();
+            cancelled = true;
+            results_.clear();
+            passCount_ = 0;
+            failCount_ = 0;
+            keptFailures_ = 0;
+            omittedFailures_ = 0;
+            lastFailures_.clear();
+        }
         catch (const std::exception& e)
         {
             using namespace std::string_literals;
+            auto const pause = details::AllocationPause();
             this->log_fail("Unhandled exception: "s + e.what());
         }
         catch (...)
         {
+            auto const pause = details::AllocationPause();
             this->log_fail("Unhandled exception.");
         }
+        allocations_ = allocations.stop();
+        this->set_hardware_counters(counters.stop());
+
+        if (ticket)
+        {
+            context.watchdog_->disarm(*ticket);
+        }
+
+        this->set_times(
+            std::chrono::steady_clock::now() - wallStart,
+            details::thread_cpu_time() - cpuStart
+        );
+
+        if (auto const* baseline = context.settings_->baseline_;
+            baseline && not cancelled)
+        {
+            for (auto& r : baseline->regressions(context.path_, measurement_of(*this)))
+            {
+                this->log_fail(std::move(r));
+            }
+        }
+        this->flush_failures();
+        context_ = nullptr;
+        cancelled_ = nullptr;
+
+        if (context.cancel_ && failCount_ > 0)
+        {
+            context.cancel_->add_failure();
+        }
+
+        auto const events = details::lock_events(context);
+        for (auto* l : context.settings_->listeners_)
+        {
+            l->on_test_finished(*this, context.path_);
+        }
     }
 
     auto LeafTest::result
         () const -> TestResult
     {
-        auto const is_pass = [](auto const r)
-        {
-            return r == TestMessageType::Pass;
-        };
-        auto asserts = results_
-                     | std::ranges::views::transform(&TestMessage::type_)
-                     | std::ranges::views::filter([](auto const t)
-                       {
-                           return t != TestMessageType::Info;
-                       });
         return
-            results_.empty()
+            results_.empty() && passCount_ == 0 && failCount_ == 0
                 ? TestResult::NotEvaluated :
-            std::ranges::all_of(asserts, is_pass)
+            failCount_ == 0
                 ? TestResult::Pass :
-            std::ranges::none_of(asserts, is_pass)
+            passCount_ == 0
                 ? TestResult::Fail :
             TestResult::Partial;
     }
 
+    auto LeafTest::summary
+        () const -> TestSummary
+    {
+        auto s = TestSummary();
+        ++count_of(s, this->result());
+        return s;
+    }
+
     auto LeafTest::output
         () const -> std::vector<TestMessage> const&
     {
         return results_;
     }
 
+    auto LeafTest::pass_count
+        () const -> std::size_t
+    {
+        return passCount_;
+    }
+
+    auto LeafTest::fail_count
+        () const -> std::size_t
+    {
+        return failCount_;
+    }
+
+    auto LeafTest::allocations
+        () const -> AllocationStats const&
+    {
+        return allocations_;
+    }
+
     auto LeafTest::accept
         (IVisitor& v) -> void
     {
@@ -97,22 +573,18 @@ namespace rog
     }
 
     auto LeafTest::assert_true
-        (bool const b, std::string m) -> void
+        (bool const b, std::string_view const m) -> void
     {
-        if (b)
-        {
-            this->pass(std::move(m));
-        }
-        else
+        this->check(b, [m]()
         {
-            this->fail(std::move(m));
-        }
+            return std::string(m);
+        });
     }
 
     auto LeafTest::assert_false
-        (bool const b, std::string m) -> void
+        (bool const b, std::string_view const m) -> void
     {
-        this->assert_true(not b, std::move(m));
+        this->assert_true(not b, m);
     }
 
     auto LeafTest::assert_null
@@ -139,18 +611,202 @@ namespace rog
         this->fail("Nullopt literal never has value");
     }
 
+    auto LeafTest::assert_range_equals
+        ( std::span<float const> const expected
+        , std::span<float const> const actual
+        , FloatTolerance const&        tolerance ) -> void
+    {
+        this->assert_floats_close(expected, actual, tolerance);
+    }
+
+    auto LeafTest::assert_range_equals
+        ( std::span<double const> const expected
+        , std::span<double const> const actual
+        , FloatTolerance const&         tolerance ) -> void
+    {
+        this->assert_floats_close(expected, actual, tolerance);
+    }
+
+    template<std::floating_point T>
+    auto LeafTest::assert_floats_close
+        ( std::span<T const> const expected
+        , std::span<T const> const actual
+        , FloatTolerance const&    tolerance ) -> void
+    {
+        auto const common = std::min(expected.size(), actual.size());
+        auto difference = details::compare_floats(
+            expected.data(),
+            actual.data(),
+            common,
+            tolerance
+        );
+
+        if (expected.size() != actual.size())
+        {
+            if (difference.count_ == 0)
+            {
+                difference.first_ = common;
+            }
+            difference.count_ += std::max(expected.size(), actual.size()) - common;
+        }
+
+        this->check(difference.count_ == 0, [&]()
+        {
+            auto const element = [&](std::size_t const i)
+            {
+                auto const print = [i](std::span<T const> const values)
+                {
+                    return i < values.size()
+                        ? details::print_value(values[i])
+                        : std::string("nothing");
+                };
+                return "index " + std::to_string(i) + ": expected "
+                     + print(expected) + " got " + print(actual);
+            };
+
+            auto message = std::string();
+            if (difference.count_ == 0)
+            {
+                message = std::to_string(common) + " elements within tolerance";
+            }
+            else
+            {
+                message = std::to_string(difference.count_) + " of "
+                        + std::to_string(std::max(expected.size(), actual.size()))
+                        + " elements out of tolerance";
+                if (expected.size() != actual.size())
+                {
+                    message += ", expected size " + std::to_string(expected.size())
+                             + " got " + std::to_string(actual.size());
+                }
+                message += ", first at " + element(difference.first_);
+            }
+
+            if (common > 0)
+            {
+                message += ". Max error " + details::print_value(difference.maxError_)
+                         + " at " + element(difference.maxErrorIndex_);
+            }
+            return message;
+        });
+    }
+
+    auto LeafTest::assert_bytes_equal
+        ( std::span<std::byte const> const expected
+        , std::span<std::byte const> const actual ) -> void
+    {
+        auto const common = std::min(expected.size(), actual.size());
+        auto difference = details::compare_bytes(
+            expected.data(),
+            actual.data(),
+            common,
+            1
+        );
+
+        if (expected.size() != actual.size())
+        {
+            if (not difference)
+            {
+                difference = details::RangeDifference {common, 0};
+            }
+            difference->count_ += std::max(expected.size(), actual.size()) - common;
+        }
+
+        this->check(not difference, [&]()
+        {
+            if (not difference)
+            {
+                return "Buffers of " + std::to_string(expected.size()) + " bytes are equal";
+            }
+
+            auto const first = difference->first_;
+            auto const begin = first - std::min(first, details::DifferenceContext);
+            auto const window = [&](std::span<std::byte const> const bytes)
+            {
+                constexpr auto Digits = std::string_view("0123456789abcdef");
+                auto const end = std::min(bytes.size(), first + details::DifferenceContext + 1);
+                auto values = std::vector<std::string>();
+                for (auto i = begin; i < end; ++i)
+                {
+                    auto const b = std::to_integer<unsigned int>(bytes[i]);
+                    values.push_back({Digits[b >> 4], Digits[b & 0xF]});
+                }
+                return values;
+            };
+            return details::range_difference_message(
+                *difference,
+                expected.size(),
+                actual.size(),
+                "bytes",
+                begin,
+                window(expected),
+                window(actual)
+            );
+        });
+    }
+
+    auto LeafTest::assert_bulk
+        (BulkResult const& result, std::string_view const what) -> void
+    {
+        for (auto const& m : result.mismatches_)
+        {
+            this->info(
+                "Input " + m.input_ + ": expected " + m.expected_
+              + " got " + m.actual_
+            );
+        }
+
+        this->check(result.mismatchCount_ == 0, [&]()
+        {
+            auto const total = std::to_string(result.checked_);
+            return result.mismatchCount_ == 0
+                ? std::string(what) + " matches for all " + total + " values"
+                : std::string(what) + " mismatches for "
+                    + std::to_string(result.mismatchCount_) + " of " + total
+                    + " values";
+        });
+    }
+
+    auto LeafTest::check_allocations
+        (std::uint64_t const limit, AllocationStats const& stats) -> void
+    {
+        if constexpr (not details::TrackAllocations)
+        {
+            this->info(
+                "Allocations are not tracked, configure with "
+                "-DROG_TRACK_ALLOCATIONS=ON"
+            );
+        }
+        else
+        {
+            this->check(stats.count_ <= limit, [&]()
+            {
+                auto const made =
+                    std::to_string(stats.count_) + " allocations of "
+                  + std::to_string(stats.bytes_) + " bytes";
+                return stats.count_ <= limit
+                    ? "Function made " + made
+                    : "Function made " + made + ", at most "
+                        + std::to_string(limit) + " expected";
+            });
+        }
+    }
+
     auto LeafTest::info
         (std::string m) -> void
     {
+        auto const pause = details::AllocationPause();
         results_.emplace_back(
-            TestMessage {TestMessageType::Info, std::move(m)}
+            TestMessage {TestMessageType::Info, kept_message(m)}
         );
     }
 
     auto LeafTest::fail
         (std::string m) -> void
     {
-        this->log_fail(std::move(m));
+        this->stop_if_cancelled();
+        auto const pause = details::AllocationPause();
+        this->log_fail(kept_message(m));
         if (assertPolicy_ == AssertPolicy::StopAtFirstFail)
         {
             throw test_failed_exception();
@@ -159,6 +815,33 @@ namespace rog
 
     auto LeafTest::pass
         (std::string m) -> void
+    {
+        this->stop_if_cancelled();
+        ++passCount_;
+        if (activeRecordPolicy_ == RecordPolicy::RecordAll)
+        {
+            auto const pause = details::AllocationPause();
+            this->log_pass(kept_message(m));
+        }
+    }
+
+    auto LeafTest::run_context
+        () const -> details::RunContext const*
+    {
+        return context_;
+    }
+
+    auto LeafTest::stop_if_cancelled
+        () -> void
+    {
+        if (cancelled_ && cancelled_->load(std::memory_order_relaxed))
+        {
+            throw test_cancelled_exception();
+        }
+    }
+
+    auto LeafTest::log_pass
+        (std::string m) -> void
     {
         results_.emplace_back(
             TestMessage {TestMessageType::Pass, std::move(m)}
@@ -168,16 +851,67 @@ namespace rog
     auto LeafTest::log_fail
         (std::string m) -> void
     {
-        results_.emplace_back(
-            TestMessage {TestMessageType::Fail, std::move(m)}
-        );
+        ++failCount_;
+        if (context_ && not context_->settings_->listeners_.empty())
+        {
+            auto const message = TestMessage {TestMessageType::Fail, m};
+            auto const events = details::lock_events(*context_);
+            for (auto* l : context_->settings_->listeners_)
+            {
+                l->on_assertion_failed(*this, context_->path_, message);
+            }
+        }
+
+        if (activeRecordPolicy_ == RecordPolicy::RecordAll
+         || keptFailures_ < failureLimit_)
+        {
+            ++keptFailures_;
+            results_.emplace_back(
+                TestMessage {TestMessageType::Fail, std::move(m)}
+            );
+            return;
+        }
+
+        if (failureLimit_ == 0)
+        {
+            ++omittedFailures_;
+            return;
+        }
+
+        if (lastFailures_.size() == failureLimit_)
+        {
+            lastFailures_.pop_front();
+            ++omittedFailures_;
+        }
+        lastFailures_.emplace_back(std::move(m));
+    }
+
+    auto LeafTest::flush_failures
+        () -> void
+    {
+        if (omittedFailures_ > 0)
+        {
+            results_.emplace_back(TestMessage {
+                TestMessageType::Info,
+                std::to_string(omittedFailures_) + " failures omitted."
+            });
+        }
+
+        for (auto& m : lastFailures_)
+        {
+            results_.emplace_back(
+                TestMessage {TestMessageType::Fail, std::move(m)}
+            );
+        }
+        lastFailures_.clear();
     }
 
 // CompositeTest:
 
     CompositeTest::CompositeTest
-        (std::string name) :
-        Test (std::move(name))
+        (std::string name, ExecutionPolicy const policy) :
+        Test (std::move(name)),
+        executionPolicy_ (policy)
     {
     }
 
@@ -188,40 +922,117 @@ namespace rog
     }
 
     auto CompositeTest::run
-        () -> void
+        (details::RunContext& context) -> void
     {
-        for (auto& t : tests_)
         {
-            t->run();
+            // Before a subtest finishes, all of its leaves are not evaluated.
+            // Subtests that are skipped are cleared to match.
+            auto const events = details::lock_events(context);
+            subtestResults_ = TestSummary {.notEvaluated_ = tests_.size()};
+            summary_ = TestSummary {.notEvaluated_ = leaf_count(summary_)};
+            this->set_times({}, {});
+            if (context.watchdog_)
+            {
+                context.watchdog_->composite_started(*this, context.path_);
+            }
+
+            for (auto* l : context.settings_->listeners_)
+            {
+                l->on_composite_started(*this, context.path_);
+            }
         }
-    }
 
-    auto CompositeTest::result
-        () const -> TestResult
-    {
-        auto const didfail = [](auto const r)
+        auto const wallStart = std::chrono::steady_clock::now();
+        auto const& filter = context.settings_->filter_;
+        auto const limit = this->timeout().value_or(context.timeout_);
+
+        if (context.pool_ && executionPolicy_ == ExecutionPolicy::Parallel)
         {
-            return r == TestResult::Fail;
-        };
-        auto const didpass = [](auto const r)
+            auto mutex = std::mutex();
+            auto group = details::TaskGroup(*context.pool_);
+            for (auto& t : tests_)
+            {
+                auto sub = details::subtest_context(context, t->name());
+                if (is_cancelled(context) || not is_selected(*t, sub.path_, filter))
+                {
+                    details::TestAccess::clear_results(*t);
+                    continue;
+                }
+                sub.timeout_ = limit;
+                group.run([this, &t, &mutex, sub = std::move(sub)]() mutable
+                {
+                    if (is_cancelled(sub))
+                    {
+                        details::TestAccess::clear_results(*t);
+                        return;
+                    }
+                    t->run(sub);
+                    auto const events = details::lock_events(sub);
+                    auto lock = std::lock_guard<std::mutex>(mutex);
+                    this->subtest_finished(*t);
+                });
+            }
+            group.wait();
+        }
+        else
         {
-            return r == TestResult::Pass;
-        };
-        auto const didntev = [](auto const r)
+            for (auto& t : tests_)
+            {
+                auto sub = details::subtest_context(context, t->name());
+                if (is_cancelled(context) || not is_selected(*t, sub.path_, filter))
+                {
+                    details::TestAccess::clear_results(*t);
+                    continue;
+                }
+                sub.timeout_ = limit;
+                t->run(sub);
+                auto const events = details::lock_events(context);
+                this->subtest_finished(*t);
+            }
+        }
+
+        auto const events = details::lock_events(context);
+        this->set_times(
+            std::chrono::steady_clock::now() - wallStart,
+            this->cpu_time()
+        );
+        if (context.watchdog_)
         {
-            return r == TestResult::NotEvaluated;
-        };
+            context.watchdog_->composite_finished(*this, context.path_);
+        }
+
+        for (auto* l : context.settings_->listeners_)
+        {
+            l->on_composite_finished(*this, context.path_);
+        }
+    }
 
+    auto CompositeTest::result
+        () const -> TestResult
+    {
+        auto const count = tests_.size();
         return
-            std::ranges::all_of(tests_, didntev, &Test::result)
+            subtestResults_.notEvaluated_ == count
                 ? TestResult::NotEvaluated :
-            std::ranges::all_of(tests_, didfail, &Test::result)
+            subtestResults_.fail_ == count
                 ? TestResult::Fail :
-            std::ranges::all_of(tests_, didpass, &Test::result)
+            subtestResults_.pass_ == count
                 ? TestResult::Pass :
             TestResult::Partial;
     }
 
+    auto CompositeTest::summary
+        () const -> TestSummary
+    {
+        return summary_;
+    }
+
+    auto CompositeTest::execution_policy
+        () const -> ExecutionPolicy
+    {
+        return executionPolicy_;
+    }
+
     auto CompositeTest::subtests
         () const -> std::vector<std::unique_ptr<Test>> const&
     {
@@ -234,17 +1045,381 @@ namespace rog
         return tests_;
     }
 
+    auto CompositeTest::update_summary
+        () -> void
+    {
+        subtestResults_ = TestSummary();
+        summary_ = TestSummary();
+        auto wall = std::chrono::nanoseconds(0);
+        auto cpu = std::chrono::nanoseconds(0);
+        for (auto const& t : tests_)
+        {
+            ++count_of(subtestResults_, t->result());
+            add(summary_, t->summary());
+            wall += t->wall_time();
+            cpu += t->cpu_time();
+        }
+        this->set_times(wall, cpu);
+    }
+
     auto CompositeTest::add_test
         (std::unique_ptr<Test> t) -> void
     {
+        ++count_of(subtestResults_, t->result());
+        add(summary_, t->summary());
         tests_.emplace_back(std::move(t));
     }
 
+    auto CompositeTest::add_test
+        ( std::string                                 name
+        , std::function<std::unique_ptr<LeafTest>()> factory ) -> void
+    {
+        this->add_test(
+            std::make_unique<LazyTest>(std::move(name), std::move(factory))
+        );
+    }
+
+    auto CompositeTest::subtest_finished
+        (Test const& t) -> void
+    {
+        auto const s = t.summary();
+        --subtestResults_.notEvaluated_;
+        ++count_of(subtestResults_, t.result());
+        summary_.notEvaluated_ -= leaf_count(s);
+        add(summary_, s);
+        this->set_times(this->wall_time(), this->cpu_time() + t.cpu_time());
+    }
+
+// LazyTest:
+
+    LazyTest::LazyTest
+        (std::string name, factory_t factory) :
+        Test (name),
+        factory_ (std::move(factory)),
+        snapshot_ (std::make_unique<LeafSnapshot>(std::move(name)))
+    {
+    }
+
+    auto LazyTest::run
+        (details::RunContext& context) -> void
+    {
+        if (is_cancelled(context))
+        {
+            details::TestAccess::clear_results(*this);
+            return;
+        }
+
+        auto leaf = std::unique_ptr<LeafTest>();
+        auto error = std::string();
+        try
+        {
+            leaf = factory_();
+        }
+        catch (std::exception const& e)
+        {
+            using namespace std::string_literals;
+            error = "Unhandled exception while building the test: "s + e.what();
+        }
+        catch (...)
+        {
+            error = "Unhandled exception while building the test.";
+        }
+
+        if (leaf)
+        {
+            auto leafContext = context;
+            leafContext.timeout_ = this->timeout().value_or(context.timeout_);
+            leaf->run(leafContext);
+            this->keep_snapshot(*leaf);
+            return;
+        }
+
+        if (error.empty())
+        {
+            error = "Factory did not build the test.";
+        }
+
+        details::TestAccess::clear_results(*this);
+        auto& messages = details::TestAccess::messages(*snapshot_);
+        messages.emplace_back(TestMessage {TestMessageType::Fail, error});
+        details::TestAccess::fail_count(*snapshot_) = 1;
+
+        if (context.cancel_)
+        {
+            context.cancel_->add_failure();
+        }
+
+        auto const events = details::lock_events(context);
+        for (auto* l : context.settings_->listeners_)
+        {
+            l->on_test_started(*snapshot_, context.path_);
+        }
+        for (auto* l : context.settings_->listeners_)
+        {
+            l->on_assertion_failed(*snapshot_, context.path_, messages.front());
+        }
+        for (auto* l : context.settings_->listeners_)
+        {
+            l->on_test_finished(*snapshot_, context.path_);
+        }
+    }
+
+    auto LazyTest::result
+        () const -> TestResult
+    {
+        return snapshot_->result();
+    }
+
+    auto LazyTest::summary
+        () const -> TestSummary
+    {
+        return snapshot_->summary();
+    }
+
+    auto LazyTest::snapshot
+        () const -> LeafTest const&
+    {
+        return *snapshot_;
+    }
+
+    auto LazyTest::snapshot
+        () -> LeafTest&
+    {
+        return *snapshot_;
+    }
+
+    auto LazyTest::accept
+        (IVisitor& v) -> void
+    {
+        v.visit(*this);
+    }
+
+    auto LazyTest::keep_snapshot
+        (LeafTest& leaf) -> void
+    {
+        auto& messages = details::TestAccess::messages(*snapshot_);
+        messages.clear();
+        for (auto& m : details::TestAccess::messages(leaf))
+        {
+            if (m.type_ == TestMessageType::Fail)
+            {
+                messages.emplace_back(std::move(m));
+            }
+        }
+        messages.shrink_to_fit();
+        details::TestAccess::keep_result(*snapshot_, leaf.result());
+        details::TestAccess::pass_count(*snapshot_) = leaf.pass_count();
+        details::TestAccess::fail_count(*snapshot_) = leaf.fail_count();
+        details::TestAccess::allocations(*snapshot_) = leaf.allocations();
+        details::TestAccess::hardware_counters(*snapshot_) = leaf.hardware_counters();
+        details::TestAccess::set_times(
+            *snapshot_,
+            leaf.wall_time(),
+            leaf.cpu_time()
+        );
+        this->set_times(leaf.wall_time(), leaf.cpu_time());
+    }
+
+// TestAccess:
+
+    auto details::TestAccess::messages
+        (LeafTest& t) -> std::vector<TestMessage>&
+    {
+        return t.results_;
+    }
+
+    auto details::TestAccess::set_times
+        ( Test&                          t
+        , std::chrono::nanoseconds const wall
+        , std::chrono::nanoseconds const cpu ) -> void
+    {
+        t.set_times(wall, cpu);
+    }
+
+    auto details::TestAccess::pass_count
+        (LeafTest& t) -> std::size_t&
+    {
+        return t.passCount_;
+    }
+
+    auto details::TestAccess::fail_count
+        (LeafTest& t) -> std::size_t&
+    {
+        return t.failCount_;
+    }
+
+    auto details::TestAccess::allocations
+        (LeafTest& t) -> AllocationStats&
+    {
+        return t.allocations_;
+    }
+
+    auto details::TestAccess::hardware_counters
+        (Test& t) -> HardwareCounters&
+    {
+        return t.counters_;
+    }
+
+    auto details::TestAccess::evaluated
+        (BenchmarkTest& t) -> bool&
+    {
+        return t.evaluated_;
+    }
+
+    auto details::TestAccess::keep_result
+        (LeafTest& t, std::optional<TestResult> const result) -> void
+    {
+        if (auto* const snapshot = dynamic_cast<LeafSnapshot*>(&t))
+        {
+            snapshot->keep_result(result);
+        }
+    }
+
+    auto details::TestAccess::subtest_finished
+        (CompositeTest& t, Test const& subtest) -> void
+    {
+        t.subtest_finished(subtest);
+    }
+
+    namespace
+    {
+        /**
+         *  \brief Clears results of visited tests.
+         */
+        class ResultsCleaner : public IVisitor
+        {
+        public:
+            auto visit (LeafTest& t) -> void override
+            {
+                using details::TestAccess;
+                TestAccess::messages(t).clear();
+                TestAccess::pass_count(t) = 0;
+                TestAccess::fail_count(t) = 0;
+                TestAccess::allocations(t) = AllocationStats();
+                TestAccess::hardware_counters(t) = HardwareCounters();
+                TestAccess::keep_result(t, std::nullopt);
+                TestAccess::set_times(t, {}, {});
+            }
+
+            auto visit (CompositeTest& t) -> void override
+            {
+                for (auto const& st : t.subtests())
+                {
+                    st->accept(*this);
+                }
+                t.update_summary();
+            }
+
+            auto visit (BenchmarkTest& t) -> void override
+            {
+                details::TestAccess::evaluated(t) = false;
+                details::TestAccess::hardware_counters(t) = HardwareCounters();
+                details::TestAccess::set_times(t, {}, {});
+            }
+
+            auto visit (LazyTest& t) -> void override
+            {
+                this->visit(t.snapshot());
+                details::TestAccess::set_times(t, {}, {});
+            }
+        };
+    }
+
+    auto details::TestAccess::clear_results
+        (Test& t) -> void
+    {
+        auto cleaner = ResultsCleaner();
+        t.accept(cleaner);
+    }
+
 // Free functions:
 
-    auto console_print_results (Test& t, ConsoleOutputType o) -> void
+    auto console_print_results
+        ( Test&                   t
+        , ConsoleOutputType const o
+        , ColorMode const         c
+        , TimeColumn const        times ) -> void
     {
-        auto out = TestOutputterVisitor(o);
+        auto out = TestOutputterVisitor(o, c, times);
         t.accept(out);
     }
-}
\ No newline at end of file
+
+    namespace
+    {
+        class SlowestCollector : public IVisitor
+        {
+        public:
+            SlowestCollector (std::size_t const n) :
+                slowest_ (n)
+            {
+            }
+
+            auto visit (LeafTest& t) -> void override
+            {
+                slowest_.add(t.wall_time(), this->path_of(t));
+            }
+
+            auto visit (BenchmarkTest& t) -> void override
+            {
+                slowest_.add(t.wall_time(), this->path_of(t));
+            }
+
+            auto visit (LazyTest& t) -> void override
+            {
+                slowest_.add(t.wall_time(), this->path_of(t));
+            }
+
+            auto visit (CompositeTest& t) -> void override
+            {
+                auto const size = path_.size();
+                path_ = this->path_of(t);
+                for (auto const& st : t.subtests())
+                {
+                    st->accept(*this);
+                }
+                path_.resize(size);
+            }
+
+            auto slowest () const -> details::SlowestLeaves const&
+            {
+                return slowest_;
+            }
+
+        private:
+            auto path_of (Test const& t) const -> std::string
+            {
+                return path_.empty()
+                    ? std::string(t.name())
+                    : path_ + "/" + std::string(t.name());
+            }
+
+        private:
+            details::SlowestLeaves slowest_;
+            std::string path_;
+        };
+    }
+
+    auto console_print_slowest
+        (Test& t, std::size_t const n) -> void
+    {
+        auto collector = SlowestCollector(n);
+        t.accept(collector);
+
+        auto console = Console();
+        console.println("Slowest tests:");
+        for (auto const& e : collector.slowest().sorted())
+        {
+            console.print("    ");
+            console.print(details::format_duration(e.time_), Color::Default, 14);
+            console.println(e.path_);
+        }
+    }
+
+    auto run_as_worker
+        ( Test&               t
+        , std::string const&  socketPath
+        , RunSettings const&  settings ) -> bool
+    {
+        return details::run_remote_worker(t, socketPath, settings);
+    }
+}
@@ -1,21 +1,36 @@
 #ifndef ROG_ROG_HPP
 #define ROG_ROG_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <iomanip>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <ranges>
+#include <span>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include <librog/details/allocation.hpp>
+#include <librog/details/compare.hpp>
 #include <librog/details/console_output.hpp>
 #include <librog/details/concepts.hpp>
+#include <librog/details/hardware_counters.hpp>
+#include <librog/filter.hpp>
+#include <librog/listeners.hpp>
 #include <librog/visitors.hpp>
 
 #if __has_include(<format>)
@@ -24,6 +39,14 @@
 
 namespace rog
 {
+    class Baseline;
+
+    namespace details
+    {
+        struct RunContext;
+        struct TestAccess;
+    }
+
     /**
      *  \brief Result of a Test.
      */
@@ -35,6 +58,17 @@ namespace rog
         NotEvaluated
     };
 
+    /**
+     *  \brief Number of leaf tests with given result.
+     */
+    struct TestSummary
+    {
+        std::size_t pass_ {0};
+        std::size_t fail_ {0};
+        std::size_t partial_ {0};
+        std::size_t notEvaluated_ {0};
+    };
+
     /**
      *  \brief Type of a test message.
      */
@@ -54,6 +88,101 @@ namespace rog
         std::string text_;
     };
 
+    /**
+     *  \brief Tolerance of floating-point comparisons. An actual value
+     *  is within tolerance if it equals the expected value or if it is
+     *  within any of the nonzero tolerances.
+     */
+    struct FloatTolerance
+    {
+        /**
+         *  \brief Largest absolute difference.
+         */
+        double absolute_ {0};
+
+        /**
+         *  \brief Largest difference relative to the larger magnitude
+         *  of the two values.
+         */
+        double relative_ {0};
+
+        /**
+         *  \brief Largest number of representable values between
+         *  the two values.
+         */
+        std::uint64_t ulps_ {0};
+
+        /**
+         *  \brief Specifies whether NaN equals NaN.
+         */
+        bool nanEqual_ {false};
+    };
+
+    /**
+     *  \brief Input for which a checked function differs from its reference.
+     */
+    struct BulkMismatch
+    {
+        std::uint64_t index_;
+        std::string input_;
+        std::string expected_;
+        std::string actual_;
+    };
+
+    /**
+     *  \brief Totals of a bulk check of many values, see \c check_domain .
+     *  Only the first few mismatches are kept.
+     */
+    struct BulkResult
+    {
+        std::uint64_t checked_ {0};
+        std::uint64_t mismatchCount_ {0};
+        std::vector<BulkMismatch> mismatches_ {};
+    };
+
+    /**
+     *  \brief Allocations made by a thread during a test or a function,
+     *  see \c details::AllocationScope . Sizes are usable sizes reported
+     *  by the allocator.
+     */
+    struct AllocationStats
+    {
+        /**
+         *  \brief Number of allocations.
+         */
+        std::uint64_t count_ {0};
+
+        /**
+         *  \brief Total size of the allocations.
+         */
+        std::uint64_t bytes_ {0};
+
+        /**
+         *  \brief Largest size of memory allocated at the same time.
+         */
+        std::uint64_t peakBytes_ {0};
+
+        /**
+         *  \brief Allocations that were not deallocated. Negative if
+         *  memory allocated before was deallocated.
+         */
+        std::int64_t leakedCount_ {0};
+        std::int64_t leakedBytes_ {0};
+    };
+
+    /**
+     *  \brief Hardware events counted in user space while a test ran,
+     *  see \c RunSettings::hardwareCounters_ . A counter is empty if it
+     *  is not available, e.g. in a virtual machine or a container.
+     */
+    struct HardwareCounters
+    {
+        std::optional<std::uint64_t> cycles_ {};
+        std::optional<std::uint64_t> instructions_ {};
+        std::optional<std::uint64_t> cacheMisses_ {};
+        std::optional<std::uint64_t> branchMisses_ {};
+    };
+
     /**
      *  \brief Specifies behavior of failed assertion.
      */
@@ -63,6 +192,116 @@ namespace rog
         RunAll
     };
 
+    /**
+     *  \brief Specifies which messages of a test are kept.
+     *
+     *  \c CountersOnly keeps only counts of passed and failed assertions,
+     *  informational messages, and a limited number of failures from the
+     *  beginning and the end of the test. Messages of passed assertions
+     *  are then never formatted. A leaf is recorded with the stricter
+     *  of its own policy and \c RunSettings::recordPolicy_ .
+     */
+    enum class RecordPolicy
+    {
+        RecordAll,
+        CountersOnly
+    };
+
+    /**
+     *  \brief Specifies whether subtests of a composite test may run
+     *  concurrently in a parallel run.
+     */
+    enum class ExecutionPolicy
+    {
+        Parallel,
+        Serial
+    };
+
+    /**
+     *  \brief Settings of a single run of a test hierarchy.
+     */
+    struct RunSettings
+    {
+        /**
+         *  \brief Number of worker threads.
+         *  Values less than 2 run all tests on the calling thread.
+         */
+        unsigned int threadCount_ {1};
+
+        /**
+         *  \brief Number of forked worker processes that run the leaves.
+         *  A crash of a leaf does not affect the rest of the run.
+         *  Zero runs all tests in the calling process.
+         */
+        unsigned int processCount_ {0};
+
+        /**
+         *  \brief Path of a Unix domain socket. If not empty, the leaves
+         *  are handed out on demand to worker processes that connect
+         *  to the socket, see \c run_as_worker , and \c processCount_
+         *  local workers are forked as well. Results of all workers
+         *  are merged into this run.
+         */
+        std::string coordinatorSocket_ {};
+
+        /**
+         *  \brief Time limit of leaves that have none of their own nor
+         *  from their ancestors, see \c Test::set_timeout . Zero means
+         *  no limit.
+         */
+        std::chrono::nanoseconds timeout_ {0};
+
+        /**
+         *  \brief Number of failed leaves after which the run is cancelled.
+         *  Tests that are not started yet are left not evaluated, running
+         *  leaves stop at their next assertion and are left not evaluated
+         *  too. Leaves in worker processes finish. Zero means that
+         *  the run is never cancelled.
+         */
+        std::size_t maxFailures_ {0};
+
+        /**
+         *  \brief Seed of property tests that do not have their own,
+         *  see \c PropertySettings::seed_ . If empty, each property test
+         *  draws a random seed and reports it.
+         */
+        std::optional<std::uint64_t> seed_ {};
+
+        /**
+         *  \brief Specifies whether hardware counters are read around each
+         *  leaf and the measured samples of each benchmark. Uses
+         *  \c perf_event_open on Linux, counters stay empty where they are
+         *  not available.
+         */
+        bool hardwareCounters_ {false};
+
+        /**
+         *  \brief Measurements of a previous run. Benchmarks that regressed
+         *  are Partial, a regression of a leaf is a failed assertion.
+         *  Must outlive the run.
+         */
+        Baseline const* baseline_ {nullptr};
+
+        /**
+         *  \brief Specifies which messages of leaves are kept. \c CountersOnly
+         *  records every leaf that way, \c RecordAll leaves it to the
+         *  policies of the leaves.
+         */
+        RecordPolicy recordPolicy_ {RecordPolicy::RecordAll};
+
+        /**
+         *  \brief Listeners notified about progress of the run.
+         *  They must outlive the run.
+         */
+        std::vector<ITestListener*> listeners_ {};
+
+        /**
+         *  \brief Selects tests that are run. Tests that are not selected
+         *  are left not evaluated.
+         */
+        TestFilter filter_ {};
+    };
+
     /**
      *  \brief Common base class for tests.
      */
@@ -72,9 +311,21 @@ namespace rog
         virtual ~Test () = default;
 
         /**
-         *  \brief Runs the test. Implemented by child classes.
+         *  \brief Runs the test serially on the calling thread.
          */
-        virtual auto run () -> void = 0;
+        auto run () -> void;
+
+        /**
+         *  \brief Runs the test using \p settings .
+         *  \param settings settings of the run.
+         */
+        auto run (RunSettings const& settings) -> void;
+
+        /**
+         *  \brief Runs the test within a run. Implemented by child classes.
+         *  \param context state shared by all tests of the run.
+         */
+        virtual auto run (details::RunContext& context) -> void = 0;
 
         /**
          *  \brief Returns result of the test. Implemented by child classes.
@@ -82,12 +333,59 @@ namespace rog
          */
         virtual auto result () const -> TestResult = 0;
 
+        /**
+         *  \brief Returns number of leaves in the hierarchy of this test
+         *  by their results. Implemented by child classes.
+         *  \return Summary of the results.
+         */
+        virtual auto summary () const -> TestSummary = 0;
+
         /**
          *  \brief Returns name of the test.
          *  \return Name of the test.
          */
         auto name () const -> std::string_view;
 
+        /**
+         *  \brief Returns wall-clock time of the last run.
+         *  \return Duration of the last run.
+         */
+        auto wall_time () const -> std::chrono::nanoseconds;
+
+        /**
+         *  \brief Returns CPU time consumed by the last run.
+         *  For composite tests, it is the sum over subtests.
+         *  \return CPU time of the last run.
+         */
+        auto cpu_time () const -> std::chrono::nanoseconds;
+
+        /**
+         *  \brief Returns hardware counters of the last run. For benchmarks,
+         *  the counts cover all measured samples. Composite tests have
+         *  no counts.
+         *  \return Counters of the last run.
+         */
+        auto hardware_counters () const -> HardwareCounters const&;
+
+        /**
+         *  \brief Sets time limit of the test. Limit of a composite applies
+         *  to each of its leaves that has no limit of its own. Zero means
+         *  no limit.
+         *
+         *  A leaf that runs in a worker process fails when it exceeds
+         *  the limit and its worker is killed. A leaf that runs in-process
+         *  can not be stopped. Its failure is reported to the listeners,
+         *  the run is finished and the process exits.
+         *  \param limit time limit.
+         */
+        auto set_timeout (std::chrono::nanoseconds limit) -> void;
+
+        /**
+         *  \brief Returns time limit of the test if it has one.
+         *  \return Time limit set by \c set_timeout .
+         */
+        auto timeout () const -> std::optional<std::chrono::nanoseconds>;
+
     protected:
         /**
          *  \brief Initializes the test with \p name .
@@ -95,8 +393,31 @@ namespace rog
          */
         Test (std::string name);
 
+        /**
+         *  \brief Sets times of the last run.
+         *  \param wall wall-clock time.
+         *  \param cpu CPU time.
+         */
+        auto set_times (
+            std::chrono::nanoseconds wall,
+            std::chrono::nanoseconds cpu
+        ) -> void;
+
+        /**
+         *  \brief Sets hardware counters of the last run.
+         *  \param counters counted events.
+         */
+        auto set_hardware_counters (HardwareCounters const& counters) -> void;
+
+    private:
+        friend struct details::TestAccess;
+
     private:
         std::string name_;
+        std::chrono::nanoseconds wallTime_;
+        std::chrono::nanoseconds cpuTime_;
+        HardwareCounters counters_;
+        std::optional<std::chrono::nanoseconds> timeout_;
     };
 
     /**
@@ -109,16 +430,24 @@ namespace rog
          *  \brief Initializes the test with \p name .
          *  \param name name of the test.
          *  \param policy specifies behavior after first failed assertion.
+         *  \param record specifies which messages are kept.
+         *  \param failureLimit number of failures kept from the beginning
+         *  and from the end of the test if \p record is \c CountersOnly .
          */
         LeafTest (
             std::string name,
-            AssertPolicy policy = AssertPolicy::StopAtFirstFail
+            AssertPolicy policy = AssertPolicy::StopAtFirstFail,
+            RecordPolicy record = RecordPolicy::RecordAll,
+            std::size_t failureLimit = 16
         );
 
+        using Test::run;
+
         /**
          *  \brief Runs the test.
+         *  \param context state shared by all tests of the run.
          */
-        auto run () -> void override final;
+        auto run (details::RunContext& context) -> void override final;
 
         /**
          *  \brief Returns result of the test.
@@ -126,12 +455,37 @@ namespace rog
          */
         auto result () const -> TestResult override;
 
+        /**
+         *  \brief Returns summary with this test as the only leaf.
+         *  \return Summary of the result.
+         */
+        auto summary () const -> TestSummary override;
+
         /**
          *  \brief Returns output of the test.
          *  \return Vector of messages produced by the test.
          */
         auto output () const -> std::vector<TestMessage> const&;
 
+        /**
+         *  \brief Returns number of passed assertions.
+         *  \return Number of passed assertions.
+         */
+        auto pass_count () const -> std::size_t;
+
+        /**
+         *  \brief Returns number of failed assertions.
+         *  \return Number of failed assertions.
+         */
+        auto fail_count () const -> std::size_t;
+
+        /**
+         *  \brief Returns allocations made by the test. All counts are zero
+         *  unless the library is built with \c ROG_TRACK_ALLOCATIONS .
+         *  \return Allocations of the last run.
+         */
+        auto allocations () const -> AllocationStats const&;
+
         /**
          *  \brief Implements the visitor design patter.
          *  \param visitor visitor.
@@ -149,14 +503,14 @@ namespace rog
          *  \param b condition to be checked.
          *  \param message message that describes the assertion.
          */
-        auto assert_true (bool b, std::string message) -> void;
+        auto assert_true (bool b, std::string_view message) -> void;
 
         /**
          *  \brief Asserts that \p b is false.
          *  \param b condition to be checked.
          *  \param message message that describes the assertion.
          */
-        auto assert_false (bool b, std::string message) -> void;
+        auto assert_false (bool b, std::string_view message) -> void;
 
         /**
          *  \brief Asserts that \p expected and \p actual are equal.
@@ -188,7 +542,7 @@ namespace rog
         auto assert_equals (
             T const& expected,
             T const& actual,
-            std::string message
+            std::string_view message
         ) -> void;
 
         /**
@@ -227,7 +581,7 @@ namespace rog
             T expected,
             T actual,
             T epsilon,
-            std::string message
+            std::string_view message
         ) -> void;
 
         /**
@@ -260,7 +614,7 @@ namespace rog
         auto assert_not_equals (
             T const& expected,
             T const& actual,
-            std::string message
+            std::string_view message
         ) -> void;
 
         /**
@@ -298,7 +652,7 @@ namespace rog
             T expected,
             T actual,
             T epsilon,
-            std::string message
+            std::string_view message
         ) -> void;
 
         /**
@@ -316,7 +670,7 @@ namespace rog
          *  \param message message that describes the assertion.
          */
         template<std::invocable F>
-        auto assert_throws (F f, std::string message) -> void;
+        auto assert_throws (F f, std::string_view message) -> void;
 
         /**
          *  \brief Asserts that null literal is nullptr which is indeed true.
@@ -394,6 +748,89 @@ namespace rog
         template<class T>
         auto assert_has_value (std::optional<T> const& o) -> void;
 
+        /**
+         *  \brief Asserts that contiguous ranges \p expected and \p actual
+         *  have equal elements. Integers, enums and pointers are compared
+         *  by their bytes with a vectorized kernel. On failure, reports
+         *  index of the first difference, elements around it, and number
+         *  of differing elements instead of the whole ranges.
+         *  \param expected expected elements.
+         *  \param actual actual elements.
+         */
+        template<std::ranges::contiguous_range R1, std::ranges::contiguous_range R2>
+        requires std::equality_comparable_with<
+            std::ranges::range_value_t<R1>,
+            std::ranges::range_value_t<R2>
+        >
+        auto assert_range_equals (R1 const& expected, R2 const& actual) -> void;
+
+        /**
+         *  \brief Asserts that all elements of \p actual are within
+         *  \p tolerance of \p expected . Elements are checked with SIMD
+         *  where it is available. Reports number of elements out
+         *  of tolerance, the first of them, and the largest error.
+         *  \param expected expected values.
+         *  \param actual actual values.
+         *  \param tolerance tolerance of the elements.
+         */
+        auto assert_range_equals (
+            std::span<float const> expected,
+            std::span<float const> actual,
+            FloatTolerance const& tolerance
+        ) -> void;
+
+        /**
+         *  \brief Asserts that all elements of \p actual are within
+         *  \p tolerance of \p expected , see the overload for floats.
+         *  \param expected expected values.
+         *  \param actual actual values.
+         *  \param tolerance tolerance of the elements.
+         */
+        auto assert_range_equals (
+            std::span<double const> expected,
+            std::span<double const> actual,
+            FloatTolerance const& tolerance
+        ) -> void;
+
+        /**
+         *  \brief Asserts that buffers \p expected and \p actual are equal,
+         *  reports differences as \c assert_range_equals with bytes
+         *  printed in hexadecimal.
+         *  \param expected expected bytes.
+         *  \param actual actual bytes.
+         */
+        auto assert_bytes_equal (
+            std::span<std::byte const> expected,
+            std::span<std::byte const> actual
+        ) -> void;
+
+        /**
+         *  \brief Asserts that a bulk check found no mismatch. Counts as
+         *  a single assertion, kept mismatches are logged as informational
+         *  messages before the failure.
+         *  \param result result of the check.
+         *  \param what description of the checked function.
+         */
+        auto assert_bulk (BulkResult const& result, std::string_view what) -> void;
+
+        /**
+         *  \brief Asserts that \p f makes at most \p limit allocations
+         *  on the calling thread. Logs informational message instead
+         *  if allocations are not tracked.
+         *  \param limit largest number of allocations.
+         *  \param f checked function.
+         */
+        template<std::invocable F>
+        auto assert_max_allocations (std::uint64_t limit, F f) -> void;
+
+        /**
+         *  \brief Asserts that \p f makes no allocation on the calling
+         *  thread, see \c assert_max_allocations .
+         *  \param f checked function.
+         */
+        template<std::invocable F>
+        auto assert_no_allocations (F f) -> void;
+
         /**
          *  \brief Logs informational message.
          *  \param message message to be logged.
@@ -412,16 +849,77 @@ namespace rog
          */
         auto pass (std::string message) -> void;
 
+        /**
+         *  \brief Returns context of the run that runs the test.
+         *  \return Context of the run, null outside of a run.
+         */
+        auto run_context () const -> details::RunContext const*;
+
     private:
+        /**
+         *  \brief Counts the assertion and logs message made by \p message
+         *  if it has to be kept. The message is not made otherwise.
+         *  \param b result of the assertion.
+         *  \param message callable object that makes the message.
+         */
+        template<class MessageFactory>
+        auto check (bool b, MessageFactory&& message) -> void;
+
+        /**
+         *  \brief Implements \c assert_range_equals with a tolerance.
+         */
+        template<std::floating_point T>
+        auto assert_floats_close (
+            std::span<T const> expected,
+            std::span<T const> actual,
+            FloatTolerance const& tolerance
+        ) -> void;
+
+        /**
+         *  \brief Implements \c assert_max_allocations .
+         */
+        auto check_allocations (std::uint64_t limit, AllocationStats const& stats) -> void;
+
+        /**
+         *  \brief Stops the test if the run was cancelled.
+         */
+        auto stop_if_cancelled () -> void;
+
+        /**
+         *  \brief Logs passed assertion.
+         *  \param message message to be logged.
+         */
+        auto log_pass (std::string message) -> void;
+
         /**
          *  \brief Logs failed assertion.
          *  \param message message to be logged.
          */
         auto log_fail (std::string message) -> void;
 
+        /**
+         *  \brief Moves failures kept from the end of the test to the
+         *  output.
+         */
+        auto flush_failures () -> void;
+
+    private:
+        friend struct details::TestAccess;
+
     private:
         std::vector<TestMessage> results_;
+        details::RunContext const* context_;
+        std::atomic<bool> const* cancelled_;
+        std::size_t passCount_;
+        std::size_t failCount_;
         AssertPolicy assertPolicy_;
+        RecordPolicy recordPolicy_;
+        RecordPolicy activeRecordPolicy_;
+        std::size_t failureLimit_;
+        std::size_t keptFailures_;
+        std::size_t omittedFailures_;
+        std::deque<std::string> lastFailures_;
+        AllocationStats allocations_;
     };
 
     /**
@@ -433,8 +931,12 @@ namespace rog
         /**
          *  \brief Initializes the test with \p name .
          *  \param name name of the test.
+         *  \param policy specifies whether subtests may run concurrently.
          */
-        CompositeTest (std::string name);
+        CompositeTest (
+            std::string name,
+            ExecutionPolicy policy = ExecutionPolicy::Parallel
+        );
 
         /**
          *  \brief Deleted copy constructor.
@@ -454,10 +956,17 @@ namespace rog
          */
         auto accept (IVisitor& visitor) -> void override;
 
+        using Test::run;
+
         /**
-         *  Runs all substests.
+         *  \brief Runs all substests.
+         *  Subtests are distributed among workers of the run if there are
+         *  any and the execution policy of this test allows it.
+         *  Results of subtests skipped by the filter or by cancellation
+         *  are cleared, so they are not evaluated.
+         *  \param context state shared by all tests of the run.
          */
-        auto run () -> void override final;
+        auto run (details::RunContext& context) -> void override final;
 
         /**
          *  \brief Returns result of the test.
@@ -465,10 +974,24 @@ namespace rog
          *  Fail if all subtests failed.
          *  Partial if some subtests passed and some failed.
          *  NotEvaluated if there is no output.
+         *  The result is updated as subtests finish and is not recomputed.
          *  \return Resuslt of the test.
          */
         auto result () const -> TestResult override;
 
+        /**
+         *  \brief Returns summary of all leaves in the hierarchy.
+         *  The summary is updated as subtests finish and is not recomputed.
+         *  \return Summary of the results.
+         */
+        auto summary () const -> TestSummary override;
+
+        /**
+         *  \brief Returns execution policy of the subtests.
+         *  \return Execution policy.
+         */
+        auto execution_policy () const -> ExecutionPolicy;
+
         /**
          *  \brief Returns subtests.
          *  \return Vector of subtests.
@@ -477,10 +1000,18 @@ namespace rog
 
         /**
          *  \brief Returns subtests.
+         *  Call \c update_summary after changing the results of subtests
+         *  outside of \c run .
          *  \return Vector of subtests.
          */
         auto subtests () -> std::vector<std::unique_ptr<Test>>&;
 
+        /**
+         *  \brief Recomputes result and summary from the subtests.
+         *  Does NOT proceed recursively.
+         */
+        auto update_summary () -> void;
+
     protected:
         /**
          *  \brief Adds new subtest.
@@ -488,8 +1019,104 @@ namespace rog
          */
         auto add_test (std::unique_ptr<Test> t) -> void;
 
+        /**
+         *  \brief Adds new subtest that is built by \p factory right
+         *  before it runs and destroyed right after. See \c LazyTest .
+         *  \param name name of the subtest.
+         *  \param factory creates the subtest.
+         */
+        auto add_test (
+            std::string name,
+            std::function<std::unique_ptr<LeafTest>()> factory
+        ) -> void;
+
+    private:
+        /**
+         *  \brief Replaces contribution of \p t before it was run by its
+         *  current result.
+         *  \param t subtest that finished.
+         */
+        auto subtest_finished (Test const& t) -> void;
+
+    private:
+        friend struct details::TestAccess;
+
     private:
         std::vector<std::unique_ptr<Test>> tests_;
+        ExecutionPolicy executionPolicy_;
+        TestSummary subtestResults_;
+        TestSummary summary_;
+    };
+
+    /**
+     *  \brief Leaf test that is built only for the time it runs.
+     *
+     *  The leaf is created by a factory right before it runs and destroyed
+     *  right after. Only its snapshot is kept in the hierarchy: name, result,
+     *  counters, times and messages of failed assertions. Peak memory
+     *  of a run thus depends on the number of leaves that run at the same
+     *  time and not on the size of the suite. Name of the built leaf
+     *  should match the name of this test.
+     */
+    class LazyTest : public Test
+    {
+    public:
+        using factory_t = std::function<std::unique_ptr<LeafTest>()>;
+
+    public:
+        /**
+         *  \brief Initializes the test with \p name .
+         *  \param name name of the test.
+         *  \param factory creates the leaf.
+         */
+        LazyTest (std::string name, factory_t factory);
+
+        using Test::run;
+
+        /**
+         *  \brief Builds the leaf, runs it, and keeps its snapshot.
+         *  Nothing is built if the run is cancelled. A factory that fails
+         *  counts as a failed leaf.
+         *  \param context state shared by all tests of the run.
+         */
+        auto run (details::RunContext& context) -> void override final;
+
+        /**
+         *  \brief Returns result of the last run.
+         *  \return Result of the test.
+         */
+        auto result () const -> TestResult override;
+
+        /**
+         *  \brief Returns summary with this test as the only leaf.
+         *  \return Summary of the result.
+         */
+        auto summary () const -> TestSummary override;
+
+        /**
+         *  \brief Returns snapshot of the last run.
+         *  \return Leaf that holds results of the last run.
+         */
+        auto snapshot () const -> LeafTest const&;
+
+        /**
+         *  \brief Returns snapshot of the last run.
+         *  \return Leaf that holds results of the last run.
+         */
+        auto snapshot () -> LeafTest&;
+
+        /**
+         *  \brief Implements the visitor design patter.
+         *  \param visitor visitor.
+         */
+        auto accept (IVisitor& visitor) -> void override;
+
+    private:
+        auto keep_snapshot (LeafTest& leaf) -> void;
+
+    private:
+        factory_t factory_;
+        std::unique_ptr<LeafTest> snapshot_;
     };
 
     /**
@@ -497,12 +1124,41 @@ namespace rog
      *  It is best to use this with the root test.
      *  \param t test to be printed.
      *  \param o specifies level of details in the output.
+     *  \param c specifies whether the output is colored.
+     *  \param times specifies whether run times of tests are printed.
      */
     auto console_print_results (
         Test& t,
-        ConsoleOutputType o = ConsoleOutputType::Full
+        ConsoleOutputType o = ConsoleOutputType::Full,
+        ColorMode c = ColorMode::Auto,
+        TimeColumn times = TimeColumn::Hide
     ) -> void;
 
+    /**
+     *  \brief Prints paths and wall-clock times of \p n slowest leaves
+     *  in the hierarchy of \p t into console.
+     *  \param t test to be searched.
+     *  \param n number of leaves to be printed.
+     */
+    auto console_print_slowest (Test& t, std::size_t n) -> void;
+
+    /**
+     *  \brief Runs leaves of \p t handed out by a coordinator until it
+     *  tells the worker to stop, see \c RunSettings::coordinatorSocket_ .
+     *  The worker must have the leaves the coordinator hands out, e.g.
+     *  it is the same program. Results are sent to the coordinator.
+     *  \param t root of the test hierarchy.
+     *  \param socketPath socket of the coordinator.
+     *  \param settings settings of the leaves, e.g. \c seed_ .
+     *  Listeners and the filter are not used.
+     *  \return false if the coordinator could not be reached.
+     */
+    auto run_as_worker (
+        Test& t,
+        std::string const& socketPath,
+        RunSettings const& settings = RunSettings()
+    ) -> bool;
+
 // LeafTest:
 
     namespace details
@@ -535,21 +1191,114 @@ namespace rog
                 }
             });
         }
+
+        template<class T>
+        auto print_value (T const& value) -> std::string;
+
+        template<class Tuple, std::size_t... Is>
+        auto print_tuple (Tuple const& t, std::index_sequence<Is...>)
+            -> std::string
+        {
+            auto out = std::string("(");
+            ((out += (Is == 0 ? "" : ", ") + print_value(std::get<Is>(t))), ...);
+            out += ')';
+            return out;
+        }
+
+        template<class T>
+        concept TupleLike = requires
+        {
+            std::tuple_size<T>::value;
+        };
+
+        /**
+         *  \brief Prints a checked value. Strings and characters are quoted,
+         *  tuples and ranges are printed element by element.
+         */
+        template<class T>
+        auto print_value (T const& value) -> std::string
+        {
+            if constexpr (std::same_as<T, bool>)
+            {
+                return value ? "true" : "false";
+            }
+            else if constexpr (std::floating_point<T>)
+            {
+                auto ost = std::ostringstream();
+                ost << std::setprecision(std::numeric_limits<T>::max_digits10) << value;
+                return ost.str();
+            }
+            else if constexpr (std::same_as<T, char>)
+            {
+                return std::string("'") + value + "'";
+            }
+            else if constexpr (std::convertible_to<T const&, std::string_view>)
+            {
+                return "\"" + std::string(std::string_view(value)) + "\"";
+            }
+            else if constexpr (TupleLike<T>)
+            {
+                return print_tuple(
+                    value,
+                    std::make_index_sequence<std::tuple_size_v<T>>()
+                );
+            }
+            else if constexpr (std::ranges::input_range<T const>)
+            {
+                auto out = std::string("[");
+                auto first = true;
+                for (auto const& e : value)
+                {
+                    out += first ? "" : ", ";
+                    out += print_value(e);
+                    first = false;
+                }
+                out += ']';
+                return out;
+            }
+            else
+            {
+                return try_print(value).value_or("<value>");
+            }
+        }
+    }
+
+    template<class MessageFactory>
+    auto LeafTest::check (bool const b, MessageFactory&& message) -> void
+    {
+        if (cancelled_ && cancelled_->load(std::memory_order_relaxed))
+        {
+            this->stop_if_cancelled();
+        }
+
+        // Messages are not allocations of the test.
+        auto const pause = details::AllocationPause();
+        if (b)
+        {
+            ++passCount_;
+            if (activeRecordPolicy_ == RecordPolicy::RecordAll)
+            {
+                this->log_pass(std::invoke(message));
+            }
+        }
+        else
+        {
+            this->fail(std::invoke(message));
+        }
     }
 
     template<class T>
     requires (std::equality_comparable<T> && not std::floating_point<T>)
     auto LeafTest::assert_equals (T const& expected, T const& actual) -> void
     {
-        auto const expectedStr = details::try_print(expected);
-        auto const actualStr = details::try_print(actual);
-        this->assert_equals(
-            expected,
-            actual,
-            expectedStr && actualStr
+        this->check(expected == actual, [&]()
+        {
+            auto const expectedStr = details::try_print(expected);
+            auto const actualStr = details::try_print(actual);
+            return expectedStr && actualStr
                 ? "Expected " + *expectedStr + " got " + *actualStr
-                : "Expected value equals to the actual value"
-        );
+                : std::string("Expected value equals to the actual value");
+        });
     }
 
     template<class T>
@@ -557,29 +1306,27 @@ namespace rog
     auto LeafTest::assert_equals (
         T const& expected,
         T const& actual,
-        std::string m
+        std::string_view m
     ) -> void
     {
-        this->assert_true(expected == actual, std::move(m));
+        this->assert_true(expected == actual, m);
     }
 
     template<class T>
     requires std::equality_comparable<T> && std::floating_point<T>
     auto LeafTest::assert_equals (T expected, T actual, T epsilon) -> void
     {
-        auto ost = std::ostringstream();
+        this->check(std::abs(expected - actual) < epsilon, [=]()
+        {
+            auto ost = std::ostringstream();
 
-        ost.precision(std::numeric_limits<double>::max_digits10);
-        ost << "Expected " << expected
-            << " got " << actual
-            << " using presision " << epsilon;
+            ost.precision(std::numeric_limits<double>::max_digits10);
+            ost << "Expected " << expected
+                << " got " << actual
+                << " using presision " << epsilon;
 
-        this->assert_equals(
-            expected,
-            actual,
-            epsilon,
-            ost.str()
-        );
+            return ost.str();
+        });
     }
 
     template<class T>
@@ -588,10 +1335,10 @@ namespace rog
         T expected,
         T actual,
         T epsilon,
-        std::string m
+        std::string_view m
     ) -> void
     {
-        this->assert_true(std::abs(expected - actual) < epsilon, std::move(m));
+        this->assert_true(std::abs(expected - actual) < epsilon, m);
     }
 
     template<class T>
@@ -601,16 +1348,15 @@ namespace rog
         T const& actual
     ) -> void
     {
-        auto const expectedStr = details::try_print(expected);
-        auto const actualStr = details::try_print(actual);
-        this->assert_not_equals(
-            expected,
-            actual,
-            expectedStr && actualStr
+        this->check(expected != actual, [&]()
+        {
+            auto const expectedStr = details::try_print(expected);
+            auto const actualStr = details::try_print(actual);
+            return expectedStr && actualStr
                 ? "Expected " + *expectedStr + " and " + *actualStr +
                   " to be different"
-                : "Values should be different"
-        );
+                : std::string("Values should be different");
+        });
     }
 
     template<class T>
@@ -618,10 +1364,10 @@ namespace rog
     auto LeafTest::assert_not_equals (
         T const& expected,
         T const& actual,
-        std::string m
+        std::string_view m
     ) -> void
     {
-        this->assert_true(expected != actual, std::move(m));
+        this->assert_true(expected != actual, m);
     }
 
     template<class T>
@@ -632,19 +1378,17 @@ namespace rog
         T epsilon
     ) -> void
     {
-        auto ost = std::ostringstream();
+        this->check(std::abs(expected - actual) >= epsilon, [=]()
+        {
+            auto ost = std::ostringstream();
 
-        ost.precision(std::numeric_limits<double>::max_digits10);
-        ost << "Expected " << expected
-            << " and " << actual
-            << " to be different using presision " << epsilon;
+            ost.precision(std::numeric_limits<double>::max_digits10);
+            ost << "Expected " << expected
+                << " and " << actual
+                << " to be different using presision " << epsilon;
 
-        this->assert_not_equals(
-            expected,
-            actual,
-            epsilon,
-            ost.str()
-        );
+            return ost.str();
+        });
     }
 
     template<class T>
@@ -653,10 +1397,10 @@ namespace rog
         T expected,
         T actual,
         T epsilon,
-        std::string m
+        std::string_view m
     ) -> void
     {
-        this->assert_true(std::abs(expected - actual) >= epsilon, std::move(m));
+        this->assert_true(std::abs(expected - actual) >= epsilon, m);
     }
 
     template<std::invocable F>
@@ -668,17 +1412,34 @@ namespace rog
 
     template<std::invocable F>
     auto LeafTest::assert_throws
-        (F f, std::string m) -> void
+        (F f, std::string_view m) -> void
     {
+        auto thrown = false;
         try
         {
             std::invoke(f);
-            this->fail(std::move(m));
         }
         catch (...)
         {
-            this->pass(std::move(m));
+            thrown = true;
         }
+        this->assert_true(thrown, m);
+    }
+
+    template<std::invocable F>
+    auto LeafTest::assert_max_allocations
+        (std::uint64_t const limit, F f) -> void
+    {
+        auto scope = details::AllocationScope();
+        std::invoke(f);
+        this->check_allocations(limit, scope.stop());
+    }
+
+    template<std::invocable F>
+    auto LeafTest::assert_no_allocations
+        (F f) -> void
+    {
+        this->assert_max_allocations(0, std::move(f));
     }
 
     template<class T>
@@ -736,6 +1497,72 @@ namespace rog
     {
         this->assert_true(o.has_value(), "Optional has value");
     }
+
+    template<std::ranges::contiguous_range R1, std::ranges::contiguous_range R2>
+    requires std::equality_comparable_with<
+        std::ranges::range_value_t<R1>,
+        std::ranges::range_value_t<R2>
+    >
+    auto LeafTest::assert_range_equals (R1 const& expected, R2 const& actual) -> void
+    {
+        using T = std::ranges::range_value_t<R1>;
+        using U = std::ranges::range_value_t<R2>;
+        auto const* const e = std::ranges::data(expected);
+        auto const* const a = std::ranges::data(actual);
+        auto const expectedSize = static_cast<std::size_t>(std::ranges::size(expected));
+        auto const actualSize = static_cast<std::size_t>(std::ranges::size(actual));
+        auto const common = std::min(expectedSize, actualSize);
+
+        auto difference = std::optional<details::RangeDifference>();
+        if constexpr (std::same_as<T, U>
+                   && (std::integral<T> || std::is_enum_v<T> || std::is_pointer_v<T>))
+        {
+            difference = details::compare_bytes(e, a, common, sizeof(T));
+        }
+        else
+        {
+            difference = details::compare_elements(e, a, common);
+        }
+
+        if (expectedSize != actualSize)
+        {
+            if (not difference)
+            {
+                difference = details::RangeDifference {common, 0};
+            }
+            difference->count_ += std::max(expectedSize, actualSize) - common;
+        }
+
+        this->check(not difference, [&]()
+        {
+            if (not difference)
+            {
+                return "Ranges of " + std::to_string(expectedSize) + " elements are equal";
+            }
+
+            auto const first = difference->first_;
+            auto const begin = first - std::min(first, details::DifferenceContext);
+            auto const window = [&](auto const* const p, std::size_t const size)
+            {
+                auto const end = std::min(size, first + details::DifferenceContext + 1);
+                auto values = std::vector<std::string>();
+                for (auto i = begin; i < end; ++i)
+                {
+                    values.push_back(details::print_value(p[i]));
+                }
+                return values;
+            };
+            return details::range_difference_message(
+                *difference,
+                expectedSize,
+                actualSize,
+                "elements",
+                begin,
+                window(e, expectedSize),
+                window(a, actualSize)
+            );
+        });
+    }
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <librog/sharding.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <librog/binary_log.hpp>
+
+namespace rog
+{
+    namespace
+    {
+        /**
+         *  \brief 64-bit FNV-1a, stable across platforms and runs.
+         */
+        auto fnv1a (std::string_view const str) -> std::uint64_t
+        {
+            auto hash = std::uint64_t {14695981039346656037ull};
+            for (auto const c : str)
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    TestShard::TestShard
+        () :
+        TestShard (0, 1)
+    {
+    }
+
+    TestShard::TestShard
+        (unsigned int const index, unsigned int const count) :
+        index_    (index),
+        count_    (count),
+        balanced_ (false)
+    {
+    }
+
+    auto TestShard::balanced (
+        unsigned int const index,
+        unsigned int const count,
+        std::vector<std::string_view> const& paths,
+        TestTimings const& timings
+    ) -> TestShard
+    {
+        struct Job
+        {
+            std::chrono::nanoseconds cost_;
+            std::string_view path_;
+        };
+
+        auto jobs = std::vector<Job>();
+        jobs.reserve(paths.size());
+        auto known = std::chrono::nanoseconds::zero();
+        auto knownCount = std::chrono::nanoseconds::rep {0};
+        for (auto const path : paths)
+        {
+            auto const it = timings.find(std::string(path));
+            if (it != timings.end())
+            {
+                known += it->second;
+                ++knownCount;
+            }
+            jobs.emplace_back(Job {
+                it != timings.end()
+                    ? it->second
+                    : std::chrono::nanoseconds(-1),
+                path
+            });
+        }
+
+        auto const mean = knownCount > 0
+            ? known / knownCount
+            : std::chrono::nanoseconds(1);
+        for (auto& job : jobs)
+        {
+            if (job.cost_ < std::chrono::nanoseconds::zero())
+            {
+                job.cost_ = mean;
+            }
+        }
+
+        // Ties are broken by paths, so that the order does not depend
+        // on the order of the paths.
+        std::ranges::sort(jobs, [](Job const& l, Job const& r)
+        {
+            return l.cost_ != r.cost_ ? l.cost_ > r.cost_ : l.path_ < r.path_;
+        });
+
+        auto shard = TestShard(index, count);
+        shard.balanced_ = true;
+        auto loads = std::vector<std::chrono::nanoseconds>(
+            std::max(count, 1u),
+            std::chrono::nanoseconds::zero()
+        );
+        for (auto const& job : jobs)
+        {
+            auto const lowest = std::ranges::min_element(loads);
+            *lowest += job.cost_;
+            if (lowest - loads.begin() == static_cast<std::ptrdiff_t>(index))
+            {
+                shard.paths_.emplace(job.path_);
+            }
+        }
+        return shard;
+    }
+
+    auto TestShard::index
+        () const -> unsigned int
+    {
+        return index_;
+    }
+
+    auto TestShard::count
+        () const -> unsigned int
+    {
+        return count_;
+    }
+
+    auto TestShard::selects
+        (std::string_view const path) const -> bool
+    {
+        if (balanced_)
+        {
+            return paths_.contains(path);
+        }
+        return count_ < 2 || fnv1a(path) % count_ == index_;
+    }
+
+    auto read_timings
+        (BinaryLog const& log) -> TestTimings
+    {
+        auto timings = TestTimings();
+        for (auto i = std::size_t {0}; i < log.size(); ++i)
+        {
+            auto const e = log.entry(i);
+            if (e.kind_ != LogEntryKind::Composite)
+            {
+                timings[log.path(i)] = e.wallTime_;
+            }
+        }
+        return timings;
+    }
+}
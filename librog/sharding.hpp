@@ -0,0 +1,102 @@
+#ifndef ROG_SHARDING_HPP
+#define ROG_SHARDING_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace rog
+{
+    class BinaryLog;
+
+    /**
+     *  \brief Durations of leaves by their paths.
+     */
+    using TestTimings = std::unordered_map<std::string, std::chrono::nanoseconds>;
+
+    /**
+     *  \brief Selects one of \c count disjoint parts of the leaves,
+     *  so that a run can be split across processes or machines.
+     *
+     *  Each leaf belongs to exactly one shard. The partition depends
+     *  only on the paths of the leaves (and on the timings in balanced
+     *  mode), so every runner computes the same partition on its own.
+     */
+    class TestShard
+    {
+    public:
+        /**
+         *  \brief Creates the only shard, which selects all leaves.
+         */
+        TestShard ();
+
+        /**
+         *  \brief Creates shard \p index of \p count that selects leaves
+         *  by a hash of their paths. The hash does not depend on
+         *  the platform nor on the other leaves.
+         */
+        TestShard (unsigned int index, unsigned int count);
+
+        /**
+         *  \brief Creates shard \p index of \p count so that all shards
+         *  take about the same time. The leaves are assigned to shards
+         *  from the slowest one, each to the shard with the lowest total
+         *  time so far. Leaves missing in \p timings are expected to take
+         *  the mean time of the known ones.
+         *  \param index index of the shard.
+         *  \param count number of shards.
+         *  \param paths paths of all leaves of the run. Every runner must
+         *  pass the same set of paths.
+         *  \param timings durations of the leaves in a previous run.
+         *  \return The shard.
+         */
+        static auto balanced (
+            unsigned int index,
+            unsigned int count,
+            std::vector<std::string_view> const& paths,
+            TestTimings const& timings
+        ) -> TestShard;
+
+        auto index () const -> unsigned int;
+        auto count () const -> unsigned int;
+
+        /**
+         *  \brief Returns true if the leaf at \p path belongs to this shard.
+         */
+        auto selects (std::string_view path) const -> bool;
+
+    private:
+        /**
+         *  \brief Hashes paths so that they can be looked up by views.
+         */
+        struct PathHash
+        {
+            using is_transparent = void;
+
+            auto operator() (std::string_view const path) const -> std::size_t
+            {
+                return std::hash<std::string_view>()(path);
+            }
+        };
+
+    private:
+        unsigned int index_;
+        unsigned int count_;
+        bool balanced_;
+        std::unordered_set<std::string, PathHash, std::equal_to<>> paths_;
+    };
+
+    /**
+     *  \brief Reads wall times of leaves and benchmarks from \p log .
+     *  \param log log of a previous run.
+     *  \return Durations by paths of the tests.
+     */
+    auto read_timings (BinaryLog const& log) -> TestTimings;
+}
+
+#endif
@@ -5,6 +5,8 @@ namespace rog
 {
     class LeafTest;
     class CompositeTest;
+    class BenchmarkTest;
+    class LazyTest;
 
     /**
      *  \brief Test visitor interface.
@@ -14,6 +16,8 @@ namespace rog
         virtual ~IVisitor () = default;
         virtual auto visit (LeafTest&) -> void  = 0;
         virtual auto visit (CompositeTest&) -> void  = 0;
+        virtual auto visit (BenchmarkTest&) -> void  = 0;
+        virtual auto visit (LazyTest&) -> void  = 0;
     };
 
     /**
@@ -1,10 +1,44 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 #if __has_include(<format>)
 #include <format>
 #endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <librog/baseline.hpp>
+#include <librog/benchmark.hpp>
+#include <librog/binary_log.hpp>
+#include <librog/domain.hpp>
+#include <librog/property.hpp>
+#include <librog/registry.hpp>
+#include <librog/reporters.hpp>
 #include <librog/rog.hpp>
 
 namespace adl
@@ -27,6 +61,28 @@ namespace adl
     {
         return false;
     }
+
+    /**
+     *  \brief Value that counts how many times it was printed
+     *  in \c printCount .
+     */
+    struct PrintCounted
+    {
+        int value_;
+    };
+
+    auto printCount = 0;
+
+    auto to_string (PrintCounted const& p) -> std::string
+    {
+        ++printCount;
+        return std::to_string(p.value_);
+    }
+
+    auto operator== (PrintCounted const& l, PrintCounted const& r) -> bool
+    {
+        return l.value_ == r.value_;
+    }
 }
 
 
@@ -130,9 +186,2704 @@ protected:
     }
 };
 
-auto main () -> int
+class DummySuite : public rog::CompositeTest
 {
-    auto t = DummyTest();
-    t.run();
-    rog::console_print_results(t, rog::ConsoleOutputType::NoLeaf);
+public:
+    DummySuite () :
+        rog::CompositeTest("Dummy suite")
+    {
+        for (auto i = 0; i < 8; ++i)
+        {
+            this->add_test(std::make_unique<DummyTest>());
+        }
+
+        for (auto i = 0; i < 8; ++i)
+        {
+            this->add_test("Dummy", [](){ return std::make_unique<DummyTest>(); });
+        }
+    }
+};
+
+class DummyBenchmark : public rog::BenchmarkTest
+{
+public:
+    DummyBenchmark () :
+        rog::BenchmarkTest(
+            "Dummy benchmark",
+            rog::BenchmarkSettings {.itemsPerIteration_ = 100}
+        )
+    {
+    }
+
+protected:
+    auto body () -> void override
+    {
+        auto sum = 0;
+        for (auto i = 0; i < 100; ++i)
+        {
+            sum += i;
+            rog::do_not_optimize(sum);
+        }
+    }
+};
+
+class DummyProperty : public rog::PropertyTest<std::tuple<int, std::string>>
+{
+public:
+    DummyProperty () :
+        rog::PropertyTest<std::tuple<int, std::string>>(
+            "Dummy property",
+            rog::gen::tuples(rog::gen::integers(0, 100), rog::gen::strings()),
+            rog::PropertySettings {.seed_ = 42}
+        )
+    {
+    }
+
+protected:
+    auto property (std::tuple<int, std::string> const& value) -> bool override
+    {
+        auto const& [n, str] = value;
+        return std::string(static_cast<std::size_t>(n), 'x').size() + str.size()
+            == static_cast<std::size_t>(n) + str.size();
+    }
+};
+
+class DummyDomainTest : public rog::LeafTest
+{
+public:
+    DummyDomainTest () :
+        rog::LeafTest("Dummy domain test")
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const result = rog::check_domain(
+            rog::BitPatterns<std::uint16_t>(),
+            [](std::uint16_t const x){ return std::popcount(x); },
+            [](std::uint16_t const x)
+            {
+                auto count = 0;
+                for (auto i = 0; i < 16; ++i)
+                {
+                    count += (x >> i) & 1;
+                }
+                return count;
+            }
+        );
+        this->assert_bulk(result, "popcount");
+    }
+};
+
+class DummyAllocationTest : public rog::LeafTest
+{
+public:
+    DummyAllocationTest () :
+        rog::LeafTest("Dummy allocation test", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto numbers = std::vector<int>();
+        numbers.reserve(64);
+        this->assert_no_allocations([&]()
+        {
+            for (auto i = 0; i < 64; ++i)
+            {
+                numbers.push_back(i);
+            }
+        });
+        this->assert_max_allocations(1, [&]()
+        {
+            numbers.push_back(64);
+        });
+    }
+};
+
+/**
+ *  \brief Returns number of occurrences of \p what in \p text .
+ */
+auto count_of (std::string_view const text, std::string_view const what) -> std::size_t
+{
+    auto count = std::size_t {0};
+    for (auto i = text.find(what); i != std::string_view::npos; i = text.find(what, i + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+/**
+ *  \brief Returns value of string or number \p key in JSON object \p line .
+ */
+auto json_field (std::string_view const line, std::string_view const key) -> std::string_view
+{
+    auto const quoted = "\"" + std::string(key) + "\":";
+    auto const at = line.find(quoted);
+    if (at == std::string_view::npos)
+    {
+        return {};
+    }
+
+    auto value = line.substr(at + quoted.size());
+    if (value.starts_with('"'))
+    {
+        value.remove_prefix(1);
+        return value.substr(0, value.find('"'));
+    }
+    return value.substr(0, value.find_first_of(",}"));
+}
+
+/**
+ *  \brief Returns true if a message of type \p type of \p t
+ *  contains \p text .
+ */
+auto has_message
+    ( rog::LeafTest const& t
+    , rog::TestMessageType const type
+    , std::string_view const text ) -> bool
+{
+    return std::ranges::any_of(t.output(), [=] (rog::TestMessage const& m)
+    {
+        return m.type_ == type && m.text_.find(text) != std::string::npos;
+    });
+}
+
+class FirstAbove36 : public rog::PropertyTest<int>
+{
+public:
+    FirstAbove36 () :
+        rog::PropertyTest<int>(
+            "First above 36",
+            rog::gen::integers(0, 1000),
+            rog::PropertySettings {.seed_ = 42}
+        )
+    {
+    }
+
+protected:
+    auto property (int const& value) -> bool override
+    {
+        return value < 37;
+    }
+};
+
+class ShortNameOrSmallNumber : public rog::PropertyTest<std::tuple<int, std::string>>
+{
+public:
+    ShortNameOrSmallNumber () :
+        rog::PropertyTest<std::tuple<int, std::string>>(
+            "Short name or small number",
+            rog::gen::tuples(rog::gen::integers(-100, 100), rog::gen::strings(16, "abc")),
+            rog::PropertySettings {.seed_ = 7}
+        )
+    {
+    }
+
+protected:
+    auto property (std::tuple<int, std::string> const& value) -> bool override
+    {
+        auto const& [n, str] = value;
+        return n < 10 || str.size() < 3;
+    }
+};
+
+/**
+ *  \brief Checks that serial, parallel and process-isolated runs
+ *  of the same suite give the same results.
+ */
+class SuiteCheck : public rog::LeafTest
+{
+public:
+    SuiteCheck () :
+        rog::LeafTest("Suite check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const runs = {
+            std::pair<std::string_view, rog::RunSettings> {"serial", {}},
+            std::pair<std::string_view, rog::RunSettings> {"parallel", {.threadCount_ = 4}},
+#if defined(__unix__) || defined(__APPLE__)
+            std::pair<std::string_view, rog::RunSettings> {"isolated", {.processCount_ = 2}},
+#endif
+        };
+
+        for (auto const& [name, settings] : runs)
+        {
+            auto suite = DummySuite();
+            suite.run(settings);
+            auto const summary = suite.summary();
+            auto const leaves = std::ranges::all_of(suite.subtests(), [](auto const& t)
+            {
+                return t->result() == rog::TestResult::Partial;
+            });
+            this->assert_true(
+                summary.partial_ == 16
+                    && summary.pass_ + summary.fail_ + summary.notEvaluated_ == 0
+                    && suite.result() == rog::TestResult::Partial
+                    && leaves,
+                "Every leaf of the " + std::string(name) + " run is partial"
+            );
+        }
+    }
+};
+
+class InformingTest : public rog::LeafTest
+{
+public:
+    explicit InformingTest (std::string name) :
+        rog::LeafTest(std::move(name))
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->info("Only informs");
+    }
+};
+
+/**
+ *  \brief Leaf that counts its living instances in \p alive .
+ */
+class CountedTest : public InformingTest
+{
+public:
+    CountedTest (std::string name, int& alive) :
+        InformingTest(std::move(name)),
+        alive_(&alive)
+    {
+        ++*alive_;
+    }
+
+    CountedTest (CountedTest const&) = delete;
+    auto operator= (CountedTest const&) -> CountedTest& = delete;
+
+    ~CountedTest () override
+    {
+        --*alive_;
+    }
+
+private:
+    int* alive_;
+};
+
+/**
+ *  \brief Suite of the same info-only leaf built eagerly and lazily.
+ */
+class LazySuite : public rog::CompositeTest
+{
+public:
+    LazySuite (int& builds, int& alive) :
+        rog::CompositeTest("Lazy suite")
+    {
+        this->add_test(std::make_unique<InformingTest>("Eager"));
+        this->add_test("Lazy", [&builds, &alive]
+        {
+            ++builds;
+            return std::make_unique<CountedTest>("Lazy", alive);
+        });
+    }
+};
+
+/**
+ *  \brief Checks that a lazy leaf is built only when it runs, is destroyed
+ *  right after, and reports the same result as the same leaf built eagerly.
+ */
+class LazyCheck : public rog::LeafTest
+{
+public:
+    LazyCheck () :
+        rog::LeafTest("Lazy check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto builds = 0;
+        auto alive = 0;
+        auto suite = LazySuite(builds, alive);
+        this->assert_equals(builds, 0);
+
+        auto excluded = rog::TestFilter();
+        excluded.exclude("Lazy suite/Lazy");
+        suite.run(rog::RunSettings {.filter_ = excluded});
+        this->assert_equals(builds, 0);
+        this->assert_equals(suite.subtests()[1]->result(), rog::TestResult::NotEvaluated);
+
+        suite.run();
+        this->assert_equals(builds, 1);
+        this->assert_equals(alive, 0);
+        this->assert_equals(suite.subtests()[0]->result(), rog::TestResult::Pass);
+        this->assert_equals(suite.subtests()[1]->result(), rog::TestResult::Pass);
+        this->assert_equals(suite.summary().pass_, std::size_t {2});
+
+#if defined(__unix__) || defined(__APPLE__)
+        // The snapshot is sent from the worker process.
+        suite.run(rog::RunSettings {.processCount_ = 1});
+        this->assert_equals(suite.subtests()[1]->result(), rog::TestResult::Pass);
+        this->assert_equals(suite.summary().pass_, std::size_t {2});
+#endif
+    }
+};
+
+/**
+ *  \brief Checks that properties that hold pass and that failing ones
+ *  are shrunk to the minimal counterexample.
+ */
+class PropertyCheck : public rog::LeafTest
+{
+public:
+    PropertyCheck () :
+        rog::LeafTest("Property check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto holds = DummyProperty();
+        holds.run();
+        this->assert_equals(holds.result(), rog::TestResult::Pass);
+        this->assert_true(
+            has_message(holds, rog::TestMessageType::Pass, "holds for 1000 cases with seed 42"),
+            "Property that holds reports its cases and seed"
+        );
+
+        auto integer = FirstAbove36();
+        integer.run();
+        this->assert_equals(integer.result(), rog::TestResult::Fail);
+        this->assert_true(
+            has_message(integer, rog::TestMessageType::Fail, "with seed 42: 37."),
+            "Integer is shrunk to the minimal counterexample"
+        );
+
+        auto tuple = ShortNameOrSmallNumber();
+        tuple.run();
+        this->assert_equals(tuple.result(), rog::TestResult::Fail);
+        this->assert_true(
+            has_message(tuple, rog::TestMessageType::Fail, "with seed 7: (10, \"aaa\")."),
+            "Tuple is shrunk to the minimal counterexample"
+        );
+
+        // The same seed checks the same cases.
+        auto again = FirstAbove36();
+        again.run();
+        this->assert_equals(again.output().front().text_, integer.output().front().text_);
+    }
+};
+
+/**
+ *  \brief Checks that bulk checks count all values and keep the first
+ *  mismatches in order of the domain.
+ */
+class DomainCheck : public rog::LeafTest
+{
+public:
+    DomainCheck () :
+        rog::LeafTest("Domain check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto popcount = DummyDomainTest();
+        popcount.run();
+        this->assert_equals(popcount.result(), rog::TestResult::Pass);
+        this->assert_true(
+            has_message(popcount, rog::TestMessageType::Pass, "popcount matches for all 65536 values"),
+            "All bit patterns are checked"
+        );
+
+        auto const identity = [](int const x){ return x; };
+        auto const result = rog::check_domain(
+            rog::IntegerRange<int>(0, 99'999),
+            [](int const x){ return x % 1000 == 999 ? x + 1 : x; },
+            identity,
+            rog::DomainSettings {.chunkSize_ = 1000, .threadCount_ = 4}
+        );
+        this->assert_equals(result.checked_, std::uint64_t {100'000});
+        this->assert_equals(result.mismatchCount_, std::uint64_t {100});
+        this->assert_equals(result.mismatches_.size(), std::size_t {16});
+        auto ordered = true;
+        for (auto i = std::size_t {0}; i < result.mismatches_.size(); ++i)
+        {
+            auto const& m = result.mismatches_[i];
+            auto const index = 999 + 1000 * i;
+            ordered = ordered
+                && m.index_ == index
+                && m.input_ == std::to_string(index)
+                && m.actual_ == std::to_string(index + 1);
+        }
+        this->assert_true(ordered, "First mismatches are kept in order");
+
+        auto const product = rog::Product(
+            rog::IntegerRange<int>(0, 9),
+            rog::IntegerRange<int>(-5, 4)
+        );
+        this->assert_equals(product.size(), std::uint64_t {100});
+        this->assert_true(product.at(23) == std::tuple(2, -2), "Last element changes fastest");
+        auto const commutes = rog::check_domain(
+            product,
+            [](int const a, int const b){ return a + b; },
+            [](int const a, int const b){ return b + a; }
+        );
+        this->assert_equals(commutes.checked_, std::uint64_t {100});
+        this->assert_equals(commutes.mismatchCount_, std::uint64_t {0});
+
+        this->assert_throws([&]()
+        {
+            rog::check_domain(
+                rog::IntegerRange<int>(0, 9'999),
+                [](int const x){ return x == 5'000 ? throw std::runtime_error("") : x; },
+                identity
+            );
+        }, "Exception of the checked function is rethrown");
+    }
+};
+
+/**
+ *  \brief Leaf whose body is a function, runs it when it is made.
+ *  Makes the checked assertions public so that a check can look
+ *  at the messages they log.
+ */
+class AssertionProbe : public rog::LeafTest
+{
+public:
+    using body_t = std::function<void(AssertionProbe&)>;
+
+public:
+    using rog::LeafTest::assert_bytes_equal;
+    using rog::LeafTest::assert_max_allocations;
+    using rog::LeafTest::assert_no_allocations;
+    using rog::LeafTest::assert_range_equals;
+
+public:
+    explicit AssertionProbe (body_t body) :
+        rog::LeafTest("Assertion probe", rog::AssertPolicy::RunAll),
+        body_(std::move(body))
+    {
+        this->run();
+    }
+
+protected:
+    auto test () -> void override
+    {
+        body_(*this);
+    }
+
+private:
+    body_t body_;
+};
+
+/**
+ *  \brief Leaf with \p passCount passed and \p failCount failed assertions
+ *  recorded with policy \p record .
+ */
+class RecordedTest : public rog::LeafTest
+{
+public:
+    RecordedTest
+        ( rog::RecordPolicy const record
+        , std::size_t const       failureLimit
+        , int const               passCount
+        , int const               failCount ) :
+        rog::LeafTest("Recorded", rog::AssertPolicy::RunAll, record, failureLimit),
+        passCount_(passCount),
+        failCount_(failCount)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        for (auto i = 0; i < passCount_; ++i)
+        {
+            this->assert_equals(adl::PrintCounted {i}, adl::PrintCounted {i});
+        }
+        for (auto i = 0; i < failCount_; ++i)
+        {
+            this->assert_true(false, "Failure " + std::to_string(i));
+        }
+    }
+
+private:
+    int passCount_;
+    int failCount_;
+};
+
+/**
+ *  \brief Checks that messages of passed assertions are made only when
+ *  they are kept and that \c CountersOnly keeps exact counts.
+ */
+class RecordCheck : public rog::LeafTest
+{
+public:
+    RecordCheck () :
+        rog::LeafTest("Record check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        using rog::RecordPolicy;
+        auto const counters = rog::RunSettings {.recordPolicy_ = RecordPolicy::CountersOnly};
+        auto const fails = [] (rog::LeafTest const& t)
+        {
+            return std::ranges::count(t.output(), rog::TestMessageType::Fail, &rog::TestMessage::type_);
+        };
+
+        adl::printCount = 0;
+        auto all = RecordedTest(RecordPolicy::RecordAll, 2, 5, 0);
+        all.run();
+        this->assert_equals(adl::printCount, 10);
+        this->assert_equals(all.output().size(), std::size_t {5});
+
+        adl::printCount = 0;
+        all.run(counters);
+        this->assert_equals(adl::printCount, 0);
+        this->assert_equals(all.pass_count(), std::size_t {5});
+        this->assert_true(all.output().empty(), "Run policy drops passes");
+
+        auto limited = RecordedTest(RecordPolicy::CountersOnly, 2, 5, 10);
+        limited.run();
+        this->assert_equals(adl::printCount, 0);
+        this->assert_equals(limited.pass_count(), std::size_t {5});
+        this->assert_equals(limited.fail_count(), std::size_t {10});
+        this->assert_equals(fails(limited), std::ptrdiff_t {4});
+        this->assert_true(
+            has_message(limited, rog::TestMessageType::Info, "6 failures omitted.")
+                && has_message(limited, rog::TestMessageType::Fail, "Failure 0")
+                && has_message(limited, rog::TestMessageType::Fail, "Failure 9"),
+            "First and last failures are kept"
+        );
+        this->assert_equals(limited.result(), rog::TestResult::Partial);
+
+        // Failures that fit into both limits are all kept.
+        auto few = RecordedTest(RecordPolicy::CountersOnly, 2, 5, 3);
+        few.run();
+        this->assert_equals(fails(few), std::ptrdiff_t {3});
+        this->assert_equals(adl::printCount, 0);
+    }
+};
+
+/**
+ *  \brief Returns text of the first message of \p t .
+ */
+auto first_message (rog::LeafTest const& t) -> std::string
+{
+    return t.output().empty() ? std::string() : t.output().front().text_;
+}
+
+/**
+ *  \brief Checks that range and buffer assertions report the first
+ *  difference and the number of differences.
+ */
+class RangeCheck : public rog::LeafTest
+{
+public:
+    RangeCheck () :
+        rog::LeafTest("Range check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->check_first_difference<std::uint8_t>("bytes");
+        this->check_first_difference<std::uint32_t>("32-bit integers");
+        this->check_first_difference<std::uint64_t>("64-bit integers");
+        this->check_first_difference<std::string>("strings");
+
+        auto const equal = AssertionProbe([](AssertionProbe& t)
+        {
+            auto const v = std::vector<int>(100, 7);
+            t.assert_range_equals(v, v);
+        });
+        this->assert_equals(equal.result(), rog::TestResult::Pass);
+        this->assert_equals(first_message(equal), std::string("Ranges of 100 elements are equal"));
+
+        auto const longer = AssertionProbe([](AssertionProbe& t)
+        {
+            t.assert_range_equals(std::vector<int> {1, 2, 3}, std::vector<int> {1, 2, 3, 4, 5});
+        });
+        this->assert_equals(
+            first_message(longer),
+            std::string(
+                "First difference at index 3, 2 elements differ, expected size 3 got 5."
+                " Expected 1 2 3 [end] got 1 2 3 [4] 5"
+            )
+        );
+
+        auto expectedBytes = std::vector<std::byte>(100, std::byte {0x11});
+        auto actualBytes = expectedBytes;
+        expectedBytes[70] = std::byte {0xab};
+        actualBytes[70] = std::byte {0xcd};
+        actualBytes[99] = std::byte {0x00};
+        auto const bytes = AssertionProbe([&](AssertionProbe& t)
+        {
+            t.assert_bytes_equal(expectedBytes, actualBytes);
+        });
+        this->assert_equals(bytes.result(), rog::TestResult::Fail);
+        this->assert_true(
+            first_message(bytes).starts_with("First difference at index 70, 2 bytes differ."),
+            "Buffers report the first differing byte"
+        );
+        this->assert_true(
+            first_message(bytes).find("11 [ab] 11") != std::string::npos
+                && first_message(bytes).find("11 [cd] 11") != std::string::npos,
+            "Bytes are printed in hexadecimal"
+        );
+    }
+
+private:
+    /**
+     *  \brief Checks differences before, in and after the vectorized
+     *  blocks of the comparison.
+     */
+    template<class T>
+    auto check_first_difference (std::string_view const what) -> void
+    {
+        auto const make = [](std::size_t const i)
+        {
+            if constexpr (std::same_as<T, std::string>)
+            {
+                return std::to_string(i);
+            }
+            else
+            {
+                return static_cast<T>(i % 100);
+            }
+        };
+
+        auto expected = std::vector<T>();
+        for (auto i = std::size_t {0}; i < 1000; ++i)
+        {
+            expected.push_back(make(i));
+        }
+
+        auto reported = true;
+        for (auto const first : {0, 1, 15, 16, 17, 31, 32, 63, 64, 500, 998})
+        {
+            auto actual = expected;
+            actual[static_cast<std::size_t>(first)] = make(
+                static_cast<std::size_t>(first) + 1
+            );
+            actual.back() = make(1);
+            auto const probe = AssertionProbe([&](AssertionProbe& t)
+            {
+                t.assert_range_equals(expected, actual);
+            });
+            auto const prefix = "First difference at index " + std::to_string(first)
+                              + ", 2 elements differ.";
+            reported = reported
+                && probe.result() == rog::TestResult::Fail
+                && first_message(probe).starts_with(prefix);
+        }
+        this->assert_true(
+            reported,
+            "First difference of " + std::string(what) + " is reported"
+        );
+    }
+};
+
+/**
+ *  \brief Checks tolerance of floating-point ranges on NaNs, signed zeros,
+ *  infinities and bounds of the tolerances. Long ranges are compared
+ *  in SIMD blocks, short ones element by element, both must agree.
+ */
+class FloatCheck : public rog::LeafTest
+{
+public:
+    FloatCheck () :
+        rog::LeafTest("Float check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->check_tolerance<float>("floats");
+        this->check_tolerance<double>("doubles");
+    }
+
+private:
+    template<std::floating_point T>
+    struct Case
+    {
+        std::string_view name_;
+        T expected_;
+        T actual_;
+        rog::FloatTolerance tolerance_;
+        bool within_;
+    };
+
+    /**
+     *  \brief Returns value \p n representable values above \p x ,
+     *  or below it if \p n is negative.
+     */
+    template<std::floating_point T>
+    static auto ulps_from (T x, int const n) -> T
+    {
+        for (auto i = 0; i < std::abs(n); ++i)
+        {
+            auto const inf = std::numeric_limits<T>::infinity();
+            x = std::nextafter(x, n > 0 ? inf : -inf);
+        }
+        return x;
+    }
+
+    template<std::floating_point T>
+    auto check_tolerance (std::string_view const what) -> void
+    {
+        using limits = std::numeric_limits<T>;
+        auto const nan = limits::quiet_NaN();
+        auto const inf = limits::infinity();
+        auto const tiny = limits::denorm_min();
+        auto const cases = std::vector<Case<T>> {
+            {"NaN differs from NaN", nan, nan, {}, false},
+            {"NaN equals NaN if allowed", nan, nan, {.nanEqual_ = true}, true},
+            {"NaN differs from a number", nan, T {1}, {.absolute_ = 1e30, .nanEqual_ = true}, false},
+            {"Number differs from NaN", T {1}, nan, {.absolute_ = 1e30}, false},
+            {"Zeros of both signs are equal", T {0}, -T {0}, {}, true},
+            {"Infinity equals infinity", inf, inf, {}, true},
+            {"Infinities of both signs differ", inf, -inf, {.absolute_ = inf}, false},
+            {"Infinity differs from the largest number", inf, limits::max(), {.absolute_ = inf}, false},
+            {"Absolute error at the bound", T {1}, T {1.5}, {.absolute_ = 0.5}, true},
+            {"Absolute error above the bound", T {1}, T {1.5}, {.absolute_ = 0.25}, false},
+            {"Relative error at the bound", T {100}, T {101}, {.relative_ = 0.01}, true},
+            {"Relative error above the bound", T {100}, T {102}, {.relative_ = 0.01}, false},
+            {"ULPs above at the bound", T {1}, ulps_from(T {1}, 4), {.ulps_ = 4}, true},
+            {"ULPs above over the bound", T {1}, ulps_from(T {1}, 5), {.ulps_ = 4}, false},
+            {"ULPs below a power of two", T {1}, ulps_from(T {1}, -4), {.ulps_ = 4}, true},
+            {"ULPs across an exponent", ulps_from(T {2}, -2), ulps_from(T {2}, 2), {.ulps_ = 4}, true},
+            {"ULPs across zero at the bound", -tiny, tiny, {.ulps_ = 2}, true},
+            {"ULPs across zero over the bound", -tiny, tiny, {.ulps_ = 1}, false},
+        };
+
+        // The SIMD blocks hold 256 elements.
+        auto const layouts = {
+            std::pair<std::size_t, std::size_t> {512, 300},
+            std::pair<std::size_t, std::size_t> {300, 280},
+            std::pair<std::size_t, std::size_t> {100, 50}
+        };
+
+        for (auto const& c : cases)
+        {
+            auto agrees = true;
+            for (auto const& [size, index] : layouts)
+            {
+                auto expected = std::vector<T>(size, T {1});
+                auto actual = expected;
+                expected[index] = c.expected_;
+                actual[index] = c.actual_;
+                auto const probe = AssertionProbe([&](AssertionProbe& t)
+                {
+                    t.assert_range_equals(
+                        std::span<T const>(expected),
+                        std::span<T const>(actual),
+                        c.tolerance_
+                    );
+                });
+
+                auto const reported = c.within_
+                    ? first_message(probe).starts_with(std::to_string(size) + " elements within")
+                    : first_message(probe).starts_with(
+                        "1 of " + std::to_string(size) + " elements out of tolerance,"
+                        " first at index " + std::to_string(index)
+                      );
+                agrees = agrees && reported;
+            }
+            this->assert_true(agrees, std::string(c.name_) + " for " + std::string(what));
+        }
+    }
+};
+
+/**
+ *  \brief Checks that allocation assertions fail on functions that
+ *  allocate too much. Without tracking they only log that allocations
+ *  are not tracked.
+ */
+class AllocationCheck : public rog::LeafTest
+{
+public:
+    AllocationCheck () :
+        rog::LeafTest("Allocation check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const allocate = []()
+        {
+            auto first = std::make_unique<int>(1);
+            auto second = std::make_unique<int>(2);
+            rog::do_not_optimize(first);
+            rog::do_not_optimize(second);
+        };
+
+        auto reserved = DummyAllocationTest();
+        reserved.run();
+        this->assert_equals(reserved.result(), rog::TestResult::Pass);
+
+        auto const noAllocations = AssertionProbe([&](AssertionProbe& t)
+        {
+            t.assert_no_allocations(allocate);
+        });
+        auto const maxAllocations = AssertionProbe([&](AssertionProbe& t)
+        {
+            t.assert_max_allocations(1, allocate);
+            t.assert_max_allocations(2, allocate);
+        });
+
+        if constexpr (rog::details::TrackAllocations)
+        {
+            this->assert_equals(noAllocations.result(), rog::TestResult::Fail);
+            this->assert_equals(maxAllocations.result(), rog::TestResult::Partial);
+            this->assert_true(
+                first_message(maxAllocations).starts_with("Function made 2 allocations of ")
+                    && first_message(maxAllocations).ends_with(" bytes, at most 1 expected"),
+                "Failed assertion reports the allocations"
+            );
+            this->assert_true(
+                maxAllocations.allocations().count_ >= 4,
+                "Allocations of the checked functions count towards the test"
+            );
+        }
+        else
+        {
+            auto const untracked = [](rog::LeafTest const& t)
+            {
+                return t.result() == rog::TestResult::Pass
+                    && t.pass_count() == 0
+                    && t.fail_count() == 0
+                    && has_message(t, rog::TestMessageType::Info, "Allocations are not tracked");
+            };
+            this->assert_true(
+                untracked(noAllocations) && untracked(maxAllocations),
+                "Assertions only log that allocations are not tracked"
+            );
+        }
+    }
+};
+
+class PassingTest : public rog::LeafTest
+{
+public:
+    explicit PassingTest (std::string name) :
+        rog::LeafTest(std::move(name))
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->assert_true(true, "Passes");
+    }
+};
+
+class FailingTest : public rog::LeafTest
+{
+public:
+    FailingTest (std::string name, std::string message) :
+        rog::LeafTest(std::move(name)),
+        message_(std::move(message))
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->info(message_);
+        this->fail(message_);
+    }
+
+private:
+    std::string message_;
+};
+
+/**
+ *  \brief Suite of \p groupCount groups of \p leafCount passing leaves.
+ */
+class GroupedSuite : public rog::CompositeTest
+{
+public:
+    GroupedSuite (int const groupCount, int const leafCount) :
+        rog::CompositeTest("Grouped suite", rog::ExecutionPolicy::Parallel)
+    {
+        for (auto i = 0; i < groupCount; ++i)
+        {
+            auto group = std::make_unique<rog::CompositeTest>(
+                "Group " + std::to_string(i),
+                rog::ExecutionPolicy::Parallel
+            );
+            for (auto j = 0; j < leafCount; ++j)
+            {
+                group->subtests().emplace_back(
+                    std::make_unique<PassingTest>("Test " + std::to_string(j))
+                );
+            }
+            group->update_summary();
+            this->add_test(std::move(group));
+        }
+    }
+};
+
+/**
+ *  \brief Checks matching of glob and regex patterns and that runs
+ *  evaluate only the selected tests.
+ */
+class FilterCheck : public rog::LeafTest
+{
+public:
+    FilterCheck () :
+        rog::LeafTest("Filter check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->assert_true(rog::TestFilter().empty(), "Default filter is empty");
+
+        auto const star = rog::TestFilter().include("A/*");
+        this->assert_true(star.selects_leaf("A/x"), "Star matches a name");
+        this->assert_true(star.selects_leaf("A/x/y"), "Match of an ancestor selects descendants");
+        this->assert_false(star.selects_leaf("B/x"), "Star does not match other paths");
+        this->assert_false(
+            rog::TestFilter().include("A/*/z").selects_leaf("A/x/y/z"),
+            "Star does not match a slash"
+        );
+
+        auto const stars = rog::TestFilter().include("**/leaf");
+        this->assert_true(stars.selects_leaf("A/B/leaf"), "Double star matches slashes");
+        this->assert_false(stars.selects_leaf("A/B/leaf2"), "Glob matches whole paths");
+
+        auto const any = rog::TestFilter().include("A?B");
+        this->assert_true(any.selects_leaf("AxB"), "Question mark matches a character");
+        this->assert_false(any.selects_leaf("A/B"), "Question mark does not match a slash");
+
+        auto const both = rog::TestFilter().include("A/*").exclude("A/y");
+        this->assert_true(both.selects_leaf("A/x"), "Included path is selected");
+        this->assert_false(both.selects_leaf("A/y"), "Exclude wins over include");
+
+        auto const regex = rog::TestFilter().include_regex("A/(x|y)");
+        this->assert_true(regex.selects_leaf("A/y"), "Regex matches a path");
+        this->assert_false(regex.selects_leaf("A/xx"), "Regex matches whole paths");
+        this->assert_throws([]()
+        {
+            rog::TestFilter().include_regex("A/(");
+        }, "Invalid regex throws");
+
+        auto const deep = rog::TestFilter().include("A/B/*");
+        this->assert_true(deep.selects_composite("A"), "Ancestor of a match is run");
+        this->assert_false(deep.selects_composite("C"), "Composite without a match is pruned");
+        this->assert_false(both.selects_composite("A/y"), "Excluded composite is pruned");
+
+        auto const runs = {
+            std::pair {rog::TestFilter().include("*/Group 1"), std::size_t {4}},
+            std::pair {rog::TestFilter().include("*/Group 1").exclude("**/Test 2"), std::size_t {3}},
+            std::pair {rog::TestFilter().include_regex(".*/Test [01]"), std::size_t {6}},
+            std::pair {rog::TestFilter().exclude("*/Group ?"), std::size_t {0}},
+        };
+        for (auto const threadCount : {1u, 4u})
+        {
+            auto selected = true;
+            for (auto const& [filter, passed] : runs)
+            {
+                auto suite = GroupedSuite(3, 4);
+                suite.run(rog::RunSettings {.threadCount_ = threadCount, .filter_ = filter});
+                auto const summary = suite.summary();
+                selected = selected
+                    && summary.pass_ == passed
+                    && summary.notEvaluated_ == 12 - passed
+                    && summary.fail_ + summary.partial_ == 0;
+            }
+            this->assert_true(
+                selected,
+                "Runs on " + std::to_string(threadCount) + " threads evaluate the selected tests"
+            );
+        }
+    }
+};
+
+/**
+ *  \brief Checks that shards partition the leaves, that hashed shards
+ *  do not depend on the platform, and that balanced shards follow
+ *  the timings.
+ */
+class ShardCheck : public rog::LeafTest
+{
+public:
+    ShardCheck () :
+        rog::LeafTest("Shard check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto paths = std::vector<std::string>();
+        for (auto i = 0; i < 100; ++i)
+        {
+            paths.push_back("Suite/Test " + std::to_string(i));
+        }
+
+        auto const shards = std::vector<rog::TestShard> {
+            rog::TestShard(0, 3),
+            rog::TestShard(1, 3),
+            rog::TestShard(2, 3)
+        };
+        auto const partitioned = std::ranges::all_of(paths, [&](auto const& path)
+        {
+            return std::ranges::count_if(shards, [&](rog::TestShard const& shard)
+            {
+                return shard.selects(path);
+            }) == 1;
+        });
+        this->assert_true(partitioned, "Each leaf belongs to exactly one hashed shard");
+        this->assert_true(rog::TestShard().selects("Suite/Test"), "Only shard selects all leaves");
+
+        // FNV-1a of the path modulo the count of shards.
+        this->assert_true(rog::TestShard(1, 3).selects("a"), "Hash of a is stable");
+        this->assert_true(rog::TestShard(5, 7).selects("a"), "Hash of a is stable");
+        this->assert_true(
+            rog::TestShard(6, 7).selects("Grouped suite/Group 1/Test 2"),
+            "Hash of a path is stable"
+        );
+
+        using namespace std::chrono_literals;
+        auto const timings = rog::TestTimings {
+            {"a", 100ms}, {"b", 60ms}, {"c", 50ms}, {"d", 40ms}, {"e", 10ms}
+        };
+        auto const names = std::vector<std::string_view> {"e", "d", "c", "b", "a", "f"};
+        auto const first = rog::TestShard::balanced(0, 2, names, timings);
+        auto const second = rog::TestShard::balanced(1, 2, names, timings);
+        auto selected = std::string();
+        for (auto const name : names)
+        {
+            selected += first.selects(name) ? "0" : "";
+            selected += second.selects(name) ? "1" : "";
+        }
+        // Slowest first, f takes the mean of 52 ms:
+        // a 0, b 1, f 1, c 0, d 1, e 0.
+        this->assert_equals(selected, std::string("010101"));
+
+        auto passed = std::size_t {0};
+        auto disjoint = true;
+        for (auto i = 0u; i < 3; ++i)
+        {
+            auto suite = GroupedSuite(3, 4);
+            suite.run(rog::RunSettings {
+                .threadCount_ = 4,
+                .filter_ = rog::TestFilter().shard(rog::TestShard(i, 3))
+            });
+            auto const summary = suite.summary();
+            passed += summary.pass_;
+            disjoint = disjoint && summary.pass_ + summary.notEvaluated_ == 12;
+        }
+        this->assert_true(disjoint && passed == 12, "Shards of a run evaluate each leaf once");
+    }
+};
+
+/**
+ *  \brief Returns summary of \p t counted from its leaves.
+ */
+auto count_leaves (rog::Test const& t) -> rog::TestSummary
+{
+    auto const* const composite = dynamic_cast<rog::CompositeTest const*>(&t);
+    if (not composite)
+    {
+        return t.summary();
+    }
+
+    auto s = rog::TestSummary();
+    for (auto const& st : composite->subtests())
+    {
+        auto const c = count_leaves(*st);
+        s.pass_ += c.pass_;
+        s.fail_ += c.fail_;
+        s.partial_ += c.partial_;
+        s.notEvaluated_ += c.notEvaluated_;
+    }
+    return s;
+}
+
+/**
+ *  \brief Checks that a run stops after the maximum number of failures
+ *  and that the leaves it skipped count as not evaluated.
+ */
+class CancellationCheck : public rog::LeafTest
+{
+public:
+    CancellationCheck () :
+        rog::LeafTest("Cancellation check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto serial = rog::CompositeTest("Serial");
+        for (auto i = 0; i < 7; ++i)
+        {
+            auto const name = "Test " + std::to_string(i);
+            if (i % 2 == 0)
+            {
+                serial.subtests().emplace_back(std::make_unique<PassingTest>(name));
+            }
+            else
+            {
+                serial.subtests().emplace_back(std::make_unique<FailingTest>(name, "Fails"));
+            }
+        }
+        serial.update_summary();
+        serial.run(rog::RunSettings {.maxFailures_ = 2});
+        auto const s = serial.summary();
+        this->assert_true(
+            s.pass_ == 2 && s.fail_ == 2 && s.partial_ == 0 && s.notEvaluated_ == 3,
+            "Serial run stops after the second failure"
+        );
+        this->assert_equals(serial.subtests()[4]->result(), rog::TestResult::NotEvaluated);
+
+        // Leaves that run when the limit is reached may fail too.
+        auto const threads = 4u;
+        auto parallel = rog::CompositeTest("Parallel", rog::ExecutionPolicy::Parallel);
+        for (auto i = 0; i < 4; ++i)
+        {
+            auto group = std::make_unique<rog::CompositeTest>("Group " + std::to_string(i));
+            for (auto j = 0; j < 8; ++j)
+            {
+                group->subtests().emplace_back(
+                    std::make_unique<FailingTest>("Test " + std::to_string(j), "Fails")
+                );
+            }
+            group->update_summary();
+            parallel.subtests().emplace_back(std::move(group));
+        }
+        parallel.update_summary();
+        parallel.run(rog::RunSettings {.threadCount_ = threads, .maxFailures_ = 2});
+        auto const p = parallel.summary();
+        this->assert_true(
+            p.fail_ >= 2 && p.fail_ <= 2 + threads && p.fail_ + p.notEvaluated_ == 32,
+            "Parallel run stops after the second failure"
+        );
+        auto const counted = count_leaves(parallel);
+        this->assert_true(
+            counted.fail_ == p.fail_ && counted.notEvaluated_ == p.notEvaluated_,
+            "Summary counts the leaves that were not evaluated"
+        );
+    }
+};
+
+/**
+ *  \brief Records events of a run in the order they arrive.
+ */
+class EventRecorder : public rog::ITestListener
+{
+public:
+    enum class Event
+    {
+        RunStarted,
+        RunFinished,
+        TestStarted,
+        AssertionFailed,
+        TestFinished,
+        CompositeStarted,
+        CompositeFinished
+    };
+
+    struct Entry
+    {
+        Event event_;
+        std::string path_;
+    };
+
+public:
+    auto on_run_started (rog::Test const&) -> void override
+    {
+        this->add(Event::RunStarted, {});
+    }
+
+    auto on_run_finished (rog::Test const&) -> void override
+    {
+        this->add(Event::RunFinished, {});
+    }
+
+    auto on_test_started (rog::LeafTest const&, std::string_view const path) -> void override
+    {
+        this->add(Event::TestStarted, path);
+    }
+
+    auto on_assertion_failed
+        (rog::LeafTest const&, std::string_view const path, rog::TestMessage const&) -> void override
+    {
+        this->add(Event::AssertionFailed, path);
+    }
+
+    auto on_test_finished (rog::LeafTest const&, std::string_view const path) -> void override
+    {
+        this->add(Event::TestFinished, path);
+    }
+
+    auto on_composite_started (rog::CompositeTest const&, std::string_view const path) -> void override
+    {
+        this->add(Event::CompositeStarted, path);
+    }
+
+    auto on_composite_finished (rog::CompositeTest const&, std::string_view const path) -> void override
+    {
+        this->add(Event::CompositeFinished, path);
+    }
+
+    auto entries () const -> std::vector<Entry> const&
+    {
+        return entries_;
+    }
+
+private:
+    auto add (Event const event, std::string_view const path) -> void
+    {
+        auto lock = std::lock_guard<std::mutex>(mutex_);
+        entries_.emplace_back(Entry {event, std::string(path)});
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+/**
+ *  \brief Checks that events of a parallel run arrive in order: each leaf
+ *  starts before its failures and its finish, and each composite opens
+ *  before and closes after all events of its subtests.
+ */
+class EventOrderCheck : public rog::LeafTest
+{
+public:
+    EventOrderCheck () :
+        rog::LeafTest("Event order check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        using Event = EventRecorder::Event;
+        for (auto run = 0; run < 5; ++run)
+        {
+            auto suite = rog::CompositeTest("Ordered", rog::ExecutionPolicy::Parallel);
+            for (auto i = 0; i < 3; ++i)
+            {
+                auto group = std::make_unique<rog::CompositeTest>(
+                    "Group " + std::to_string(i),
+                    rog::ExecutionPolicy::Parallel
+                );
+                auto inner = std::make_unique<rog::CompositeTest>("Inner");
+                inner->subtests().emplace_back(std::make_unique<PassingTest>("Passes"));
+                inner->subtests().emplace_back(std::make_unique<FailingTest>("Fails", "Fails"));
+                inner->update_summary();
+                group->subtests().emplace_back(std::move(inner));
+                for (auto j = 0; j < 4; ++j)
+                {
+                    group->subtests().emplace_back(
+                        std::make_unique<PassingTest>("Test " + std::to_string(j))
+                    );
+                }
+                group->update_summary();
+                suite.subtests().emplace_back(std::move(group));
+            }
+            suite.update_summary();
+
+            auto recorder = EventRecorder();
+            suite.run(rog::RunSettings {.threadCount_ = 4, .listeners_ = {&recorder}});
+            auto const& es = recorder.entries();
+
+            auto ordered = es.size() > 2
+                && es.front().event_ == Event::RunStarted
+                && es.back().event_ == Event::RunFinished;
+            auto leaves = 0;
+            for (auto i = std::size_t {0}; i < es.size(); ++i)
+            {
+                auto const& path = es[i].path_;
+                auto const first = [&] (Event const e)
+                {
+                    return static_cast<std::size_t>(std::ranges::find_if(es, [&] (auto const& x)
+                    {
+                        return x.event_ == e && x.path_ == path;
+                    }) - es.begin());
+                };
+
+                if (es[i].event_ == Event::TestStarted)
+                {
+                    ++leaves;
+                    ordered = ordered && first(Event::TestStarted) == i && first(Event::TestFinished) > i;
+                }
+                else if (es[i].event_ == Event::AssertionFailed)
+                {
+                    ordered = ordered && first(Event::TestStarted) < i && first(Event::TestFinished) > i;
+                }
+                else if (es[i].event_ == Event::CompositeFinished)
+                {
+                    auto const start = first(Event::CompositeStarted);
+                    auto const prefix = path + "/";
+                    for (auto j = std::size_t {0}; j < es.size(); ++j)
+                    {
+                        if (es[j].path_.starts_with(prefix))
+                        {
+                            ordered = ordered && start < j && j < i;
+                        }
+                    }
+                }
+            }
+            this->assert_equals(leaves, 18);
+            this->assert_true(ordered, "Run " + std::to_string(run) + " reports events in order");
+        }
+    }
+};
+
+/**
+ *  \brief Leaf that fails while \p fails is set.
+ */
+class ToggledTest : public rog::LeafTest
+{
+public:
+    ToggledTest (std::string name, bool const& fails) :
+        rog::LeafTest(std::move(name)),
+        fails_(&fails)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        this->assert_false(*fails_, "Toggled off");
+    }
+
+private:
+    bool const* fails_;
+};
+
+/**
+ *  \brief Checks that each run of the same tree replaces the summaries
+ *  of its composites instead of adding to them.
+ */
+class SummaryCheck : public rog::LeafTest
+{
+public:
+    SummaryCheck () :
+        rog::LeafTest("Summary check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto fails = false;
+        auto root = rog::CompositeTest("Root");
+        auto group = std::make_unique<rog::CompositeTest>("Group", rog::ExecutionPolicy::Parallel);
+        group->subtests().emplace_back(std::make_unique<ToggledTest>("Toggled", fails));
+        group->subtests().emplace_back(std::make_unique<PassingTest>("Passes"));
+        group->update_summary();
+        root.subtests().emplace_back(std::move(group));
+        root.subtests().emplace_back(std::make_unique<PassingTest>("Passes"));
+        root.update_summary();
+
+        auto excluded = rog::TestFilter();
+        excluded.exclude("Root/Group/Toggled");
+        struct Run
+        {
+            bool fails_;
+            rog::RunSettings settings_;
+            rog::TestSummary expected_;
+            rog::TestResult result_;
+        };
+        auto const runs = {
+            Run {false, {}, {3, 0, 0, 0}, rog::TestResult::Pass},
+            Run {true, {.threadCount_ = 4}, {2, 1, 0, 0}, rog::TestResult::Partial},
+            Run {true, {}, {2, 1, 0, 0}, rog::TestResult::Partial},
+            Run {false, {.filter_ = excluded}, {2, 0, 0, 1}, rog::TestResult::Partial},
+            Run {false, {.threadCount_ = 4}, {3, 0, 0, 0}, rog::TestResult::Pass}
+        };
+
+        auto index = 0;
+        for (auto const& r : runs)
+        {
+            fails = r.fails_;
+            root.run(r.settings_);
+            auto const s = root.summary();
+            auto const counted = count_leaves(root);
+            auto const& e = r.expected_;
+            this->assert_true(
+                s.pass_ == e.pass_ && s.fail_ == e.fail_
+                    && s.partial_ == e.partial_ && s.notEvaluated_ == e.notEvaluated_
+                    && counted.pass_ == e.pass_ && counted.fail_ == e.fail_
+                    && counted.notEvaluated_ == e.notEvaluated_,
+                "Run " + std::to_string(index++) + " has a fresh summary"
+            );
+            this->assert_equals(root.result(), r.result_);
+        }
+    }
+};
+
+#if defined(__unix__) || defined(__APPLE__)
+auto read_all (std::FILE* const file) -> std::string
+{
+    auto text = std::string();
+    char buffer[4096];
+    std::fseek(file, 0, SEEK_SET);
+    for (auto n = std::fread(buffer, 1, sizeof(buffer), file);
+         n > 0;
+         n = std::fread(buffer, 1, sizeof(buffer), file))
+    {
+        text.append(buffer, n);
+    }
+    return text;
+}
+
+class HangingTest : public rog::LeafTest
+{
+public:
+    HangingTest (std::string name, bool const hangs) :
+        rog::LeafTest(std::move(name)),
+        hangs_(hangs)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        while (hangs_)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        this->assert_true(true, "Finished");
+    }
+
+private:
+    bool hangs_;
+};
+
+class HangingSuite : public rog::CompositeTest
+{
+public:
+    HangingSuite () :
+        rog::CompositeTest("Hanging suite", rog::ExecutionPolicy::Parallel)
+    {
+        for (auto i = 0; i < 3; ++i)
+        {
+            auto group = std::make_unique<rog::CompositeTest>(
+                "Group " + std::to_string(i),
+                rog::ExecutionPolicy::Parallel
+            );
+            for (auto j = 0; j < 4; ++j)
+            {
+                group->subtests().emplace_back(std::make_unique<HangingTest>(
+                    "Test " + std::to_string(j),
+                    i == 1 && j == 2
+                ));
+            }
+            group->update_summary();
+            this->add_test(std::move(group));
+        }
+    }
+};
+
+/**
+ *  \brief Checks that reports of a run aborted by a timeout are complete.
+ *  The abort exits the process, so the run is forked.
+ */
+class TimeoutReportCheck : public rog::LeafTest
+{
+public:
+    TimeoutReportCheck () :
+        rog::LeafTest("Timeout report check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto* const xml = std::tmpfile();
+        auto* const jsonl = std::tmpfile();
+        auto* const tap = std::tmpfile();
+        this->assert_true(xml && jsonl && tap, "Temporary files are open");
+        if (not xml || not jsonl || not tap)
+        {
+            return;
+        }
+
+        auto const pid = ::fork();
+        if (pid == 0)
+        {
+            auto const null = ::open("/dev/null", O_WRONLY);
+            ::dup2(null, STDERR_FILENO);
+            auto junitReporter = rog::JUnitXmlReporter(::fileno(xml));
+            auto jsonlReporter = rog::JsonLinesReporter(::fileno(jsonl));
+            auto tapReporter = rog::TapReporter(::fileno(tap));
+            auto suite = HangingSuite();
+            suite.run(rog::RunSettings {
+                .threadCount_ = 4,
+                .timeout_ = std::chrono::milliseconds(200),
+                .listeners_ = {&junitReporter, &jsonlReporter, &tapReporter}
+            });
+            std::_Exit(EXIT_SUCCESS);
+        }
+
+        auto status = 0;
+        ::waitpid(pid, &status, 0);
+        this->assert_true(
+            WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE,
+            "Timeout aborts the run"
+        );
+
+        // JUnit: testsuite is closed and its testcases are complete.
+        auto const junit = read_all(xml);
+        auto const testcases = count_of(junit, "<testcase ");
+        this->assert_equals(count_of(junit, "</testcase>"), testcases);
+        this->assert_true(junit.ends_with("</testsuite>\n</testsuites>\n"), "JUnit is closed");
+        this->assert_equals(count_of(junit, "Timed out after"), std::size_t {1});
+
+        // JSON Lines: composites are closed after their subtests and before the run ends.
+        auto open = std::vector<std::string>();
+        auto finished = std::size_t {0};
+        auto last = std::string_view();
+        auto const lines = read_all(jsonl);
+        auto balanced = true;
+        for (auto line = std::string_view(lines); not line.empty();)
+        {
+            auto const end = line.find('\n');
+            last = line.substr(0, end);
+            line.remove_prefix(end == std::string_view::npos ? line.size() : end + 1);
+
+            auto const event = json_field(last, "event");
+            if (event == "composite_started")
+            {
+                open.emplace_back(json_field(last, "path"));
+            }
+            else if (event == "composite_finished")
+            {
+                // Parallel siblings may interleave, descendants may not.
+                auto const path = std::string(json_field(last, "path"));
+                balanced = balanced
+                    && std::erase(open, path) == 1
+                    && std::ranges::none_of(open, [&path] (auto const& o)
+                    {
+                        return o.starts_with(path + "/");
+                    });
+            }
+            else if (event == "test_finished")
+            {
+                ++finished;
+            }
+        }
+        this->assert_true(balanced && open.empty(), "JSON Lines composites are balanced");
+        this->assert_equals(json_field(last, "event"), std::string_view("run_finished"));
+        this->assert_equals(json_field(last, "tests"), std::string_view(std::to_string(finished)));
+        this->assert_equals(finished, testcases);
+        this->assert_equals(json_field(last, "failed"), std::string_view("1"));
+
+        // TAP: plan matches the test points.
+        auto const tapText = read_all(tap);
+        auto const points = count_of(tapText, "\nok ") + count_of(tapText, "\nnot ok ");
+        this->assert_true(tapText.starts_with("TAP version 13\n"), "TAP has version");
+        this->assert_true(
+            tapText.ends_with("\n1.." + std::to_string(points) + "\n"),
+            "TAP plan counts test points"
+        );
+
+        std::fclose(xml);
+        std::fclose(jsonl);
+        std::fclose(tap);
+    }
+};
+
+class ReportedSuite : public rog::CompositeTest
+{
+public:
+    ReportedSuite () :
+        rog::CompositeTest("Reported <suite>")
+    {
+        this->add_test(std::make_unique<PassingTest>("Passing"));
+        this->add_test(std::make_unique<FailingTest>(
+            "Escaped <&\"'> #1",
+            "a < b && \"c\"\n\\next"
+        ));
+        auto excluded = std::make_unique<rog::CompositeTest>("Excluded");
+        excluded->subtests().emplace_back(std::make_unique<PassingTest>("Passing"));
+        excluded->update_summary();
+        this->add_test(std::move(excluded));
+        this->add_test(std::make_unique<DummyBenchmark>());
+    }
+};
+
+/**
+ *  \brief Checks that reporters escape names and messages, and that they
+ *  report only the selected tests.
+ */
+class ReporterCheck : public rog::LeafTest
+{
+public:
+    ReporterCheck () :
+        rog::LeafTest("Reporter check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto* const xml = std::tmpfile();
+        auto* const jsonl = std::tmpfile();
+        auto* const tap = std::tmpfile();
+        this->assert_true(xml && jsonl && tap, "Temporary files are open");
+        if (not xml || not jsonl || not tap)
+        {
+            return;
+        }
+
+        {
+            auto junitReporter = rog::JUnitXmlReporter(::fileno(xml));
+            auto jsonlReporter = rog::JsonLinesReporter(::fileno(jsonl));
+            auto tapReporter = rog::TapReporter(::fileno(tap));
+            auto suite = ReportedSuite();
+            suite.run(rog::RunSettings {
+                .listeners_ = {&junitReporter, &jsonlReporter, &tapReporter},
+                .filter_ = rog::TestFilter().exclude("*/Excluded")
+            });
+        }
+
+        auto const junit = read_all(xml);
+        this->assert_true(junit.starts_with("<?xml "), "JUnit has declaration");
+        this->assert_true(junit.ends_with("</testsuite>\n</testsuites>\n"), "JUnit is closed");
+        this->assert_true(
+            junit.find("<testsuite name=\"Reported &lt;suite&gt;\">") != std::string::npos,
+            "JUnit escapes the suite name"
+        );
+        this->assert_equals(count_of(junit, "<testcase "), std::size_t {3});
+        this->assert_equals(count_of(junit, "<failure "), std::size_t {1});
+        this->assert_true(
+            junit.find("name=\"Escaped &lt;&amp;&quot;&apos;&gt; #1\"") != std::string::npos
+                && junit.find("a &lt; b &amp;&amp; &quot;c&quot;\n\\next") != std::string::npos,
+            "JUnit escapes names and messages"
+        );
+        this->assert_equals(count_of(junit, "Excluded"), std::size_t {0});
+
+        auto const lines = read_all(jsonl);
+        auto events = std::vector<std::string_view>();
+        auto wellFormed = true;
+        for (auto line = std::string_view(lines); not line.empty();)
+        {
+            auto const end = line.find('\n');
+            auto const event = line.substr(0, end);
+            line.remove_prefix(end == std::string_view::npos ? line.size() : end + 1);
+            wellFormed = wellFormed && event.starts_with("{\"event\":\"") && event.ends_with('}');
+            events.push_back(json_field(event, "event"));
+        }
+        this->assert_true(wellFormed && lines.ends_with('\n'), "JSON Lines has one object per line");
+        this->assert_equals(std::ranges::count(events, "test_finished"), std::ptrdiff_t {2});
+        this->assert_equals(std::ranges::count(events, "benchmark_finished"), std::ptrdiff_t {1});
+        this->assert_true(
+            lines.find("\"tests\":3") != std::string::npos,
+            "JSON Lines counts the selected tests"
+        );
+        this->assert_true(
+            lines.find("\"Reported <suite>/Escaped <&\\\"'> #1\"") != std::string::npos
+                && lines.find("a < b && \\\"c\\\"\\n\\\\next") != std::string::npos,
+            "JSON Lines escapes names and messages"
+        );
+        this->assert_equals(count_of(lines, "Excluded"), std::size_t {0});
+
+        auto const tapText = read_all(tap);
+        this->assert_true(
+            tapText.starts_with("TAP version 13\nok 1 - Reported <suite>/Passing\n"),
+            "TAP numbers test points from one"
+        );
+        this->assert_true(
+            tapText.find("\nnot ok 2 - Reported <suite>/Escaped <&\"'> \\#1\n") != std::string::npos,
+            "TAP escapes directives in descriptions"
+        );
+        this->assert_true(
+            tapText.find("\n    - \"a < b && \\\"c\\\"\\n\\\\next\"\n") != std::string::npos,
+            "TAP quotes failures in YAML"
+        );
+        this->assert_true(
+            tapText.find("\nok 3 - Reported <suite>/Dummy benchmark\n") != std::string::npos
+                && tapText.ends_with("\n1..3\n"),
+            "TAP plan counts the selected tests"
+        );
+
+        std::fclose(xml);
+        std::fclose(jsonl);
+        std::fclose(tap);
+    }
+};
+
+/**
+ *  \brief Returns path of a new empty temporary file.
+ */
+auto temporary_path () -> std::string
+{
+    char path[] = "/tmp/rogXXXXXX";
+    auto const fd = ::mkstemp(path);
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    return path;
+}
+
+/**
+ *  \brief Returns contents of file at \p path , empty if it can not be read.
+ */
+auto read_file (std::string const& path) -> std::string
+{
+    auto* const file = std::fopen(path.c_str(), "rb");
+    if (not file)
+    {
+        return {};
+    }
+    auto text = read_all(file);
+    std::fclose(file);
+    return text;
+}
+
+/**
+ *  \brief Runs \p t with a binary log written to \p path .
+ */
+auto run_logged (rog::Test& t, std::string const& path, rog::RunSettings settings = {}) -> void
+{
+    auto const fd = ::open(path.c_str(), O_WRONLY | O_TRUNC);
+    {
+        auto writer = rog::BinaryLogWriter(fd);
+        settings.listeners_.push_back(&writer);
+        t.run(settings);
+    }
+    ::close(fd);
+}
+
+class SleepingTest : public rog::LeafTest
+{
+public:
+    SleepingTest (std::string name, std::chrono::milliseconds const duration) :
+        rog::LeafTest(std::move(name)),
+        duration_(duration)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        std::this_thread::sleep_for(duration_);
+        this->assert_true(true, "Slept");
+    }
+
+private:
+    std::chrono::milliseconds duration_;
+};
+
+/**
+ *  \brief Suite whose leaves change between the run before and after.
+ */
+class ChangingSuite : public rog::CompositeTest
+{
+public:
+    explicit ChangingSuite (bool const after) :
+        rog::CompositeTest("Changing suite")
+    {
+        auto const message = std::string("Fails");
+        if (after)
+        {
+            this->add_test(std::make_unique<PassingTest>("Flips to pass"));
+            this->add_test(std::make_unique<FailingTest>("Flips to fail", message));
+        }
+        else
+        {
+            this->add_test(std::make_unique<FailingTest>("Flips to pass", message));
+            this->add_test(std::make_unique<PassingTest>("Flips to fail"));
+        }
+        this->add_test(std::make_unique<SleepingTest>(
+            "Slows down",
+            std::chrono::milliseconds(after ? 50 : 0)
+        ));
+        this->add_test(std::make_unique<PassingTest>("Stays"));
+    }
+};
+
+/**
+ *  \brief Parallel suite of two composites with the same name, so that
+ *  their leaves have the same paths.
+ */
+class TwinSuite : public rog::CompositeTest
+{
+public:
+    TwinSuite () :
+        rog::CompositeTest("Twin suite", rog::ExecutionPolicy::Parallel)
+    {
+        for (auto const fails : {false, true})
+        {
+            auto twin = std::make_unique<rog::CompositeTest>("Twin", rog::ExecutionPolicy::Parallel);
+            for (auto i = 0; i < 4; ++i)
+            {
+                if (fails)
+                {
+                    twin->subtests().emplace_back(std::make_unique<FailingTest>("Leaf", "Fails"));
+                }
+                else
+                {
+                    twin->subtests().emplace_back(std::make_unique<PassingTest>("Leaf"));
+                }
+            }
+            twin->update_summary();
+            this->add_test(std::move(twin));
+        }
+    }
+};
+
+/**
+ *  \brief Checks that the binary log stores the tree, results and messages
+ *  of a run, survives being cut short, and that logs of two runs
+ *  are compared by paths.
+ */
+class BinaryLogCheck : public rog::LeafTest
+{
+public:
+    BinaryLogCheck () :
+        rog::LeafTest("Binary log check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const path = temporary_path();
+        auto suite = ReportedSuite();
+        run_logged(suite, path);
+
+        {
+            auto const log = rog::BinaryLog(path);
+            this->assert_true(log.is_open(), "Log is valid");
+            this->assert_equals(log.size(), std::size_t {6});
+
+            auto ordered = true;
+            auto failing = std::optional<std::size_t>();
+            auto benchmark = std::optional<std::size_t>();
+            for (auto i = std::size_t {0}; i < log.size(); ++i)
+            {
+                auto const e = log.entry(i);
+                ordered = ordered && (e.parent_ == rog::BinaryLog::NoParent || e.parent_ > i);
+                if (log.path(i) == "Reported <suite>/Escaped <&\"'> #1")
+                {
+                    failing = i;
+                }
+                if (e.kind_ == rog::LogEntryKind::Benchmark)
+                {
+                    benchmark = i;
+                }
+            }
+            this->assert_true(ordered, "Children precede parents");
+            this->assert_true(
+                log.entry(log.size() - 1).parent_ == rog::BinaryLog::NoParent
+                    && log.entry(log.size() - 1).name_ == "Reported <suite>",
+                "Root is the last entry"
+            );
+            this->assert_equals(log.entry(log.size() - 1).failCount_, std::uint64_t {1});
+
+            this->assert_has_value(failing);
+            if (failing)
+            {
+                auto const e = log.entry(*failing);
+                auto const fail = e.messageCount_ >= 2
+                    ? log.message(e, 1)
+                    : rog::LogMessage {rog::TestMessageType::Info, {}};
+                this->assert_true(
+                    e.result_ == rog::TestResult::Fail
+                        && e.failCount_ == 1
+                        && fail.type_ == rog::TestMessageType::Fail
+                        && fail.text_ == "a < b && \"c\"\n\\next",
+                    "Leaf keeps its result and messages"
+                );
+            }
+
+            this->assert_has_value(benchmark);
+            if (benchmark)
+            {
+                this->assert_true(
+                    log.entry(*benchmark).meanTime_.count() > 0
+                        && not log.measurement(*benchmark).times_.empty(),
+                    "Benchmark keeps its time and samples"
+                );
+            }
+        }
+
+        // A log cut short is read up to its last complete block.
+        {
+            auto* const file = std::fopen(path.c_str(), "rb");
+            auto const text = file ? read_all(file) : std::string();
+            if (file)
+            {
+                std::fclose(file);
+            }
+            auto* const cut = std::fopen(path.c_str(), "wb");
+            if (cut)
+            {
+                std::fwrite(text.data(), 1, text.size() - 3, cut);
+                std::fclose(cut);
+            }
+            auto const log = rog::BinaryLog(path);
+            this->assert_true(log.is_open() && log.size() <= 6, "Log cut short is read");
+
+            auto* const garbage = std::fopen(path.c_str(), "wb");
+            if (garbage)
+            {
+                std::fputs("not a log", garbage);
+                std::fclose(garbage);
+            }
+            this->assert_false(rog::BinaryLog(path).is_open(), "Other file is not a log");
+        }
+
+        auto const beforePath = temporary_path();
+        auto const afterPath = temporary_path();
+        auto before = ChangingSuite(false);
+        auto after = ChangingSuite(true);
+        run_logged(before, beforePath);
+        run_logged(after, afterPath);
+        {
+            auto const diff = rog::diff_logs(
+                rog::BinaryLog(beforePath),
+                rog::BinaryLog(afterPath)
+            );
+            this->assert_range_equals(
+                diff.newlyFailing_,
+                std::vector<std::string> {"Changing suite/Flips to fail"}
+            );
+            this->assert_range_equals(
+                diff.newlyPassing_,
+                std::vector<std::string> {"Changing suite/Flips to pass"}
+            );
+            this->assert_true(
+                diff.slower_.size() == 1 && diff.slower_.front().path_ == "Changing suite/Slows down",
+                "Slower leaf is found"
+            );
+        }
+
+        // Leaves are kept with their own parents although paths collide.
+        auto twins = TwinSuite();
+        run_logged(twins, path, rog::RunSettings {.threadCount_ = 4});
+        {
+            auto const log = rog::BinaryLog(path);
+            this->assert_equals(log.size(), std::size_t {11});
+            auto composites = 0;
+            auto sameResult = true;
+            for (auto i = std::size_t {0}; i < log.size(); ++i)
+            {
+                auto const e = log.entry(i);
+                if (e.kind_ == rog::LogEntryKind::Composite && e.name_ == "Twin")
+                {
+                    ++composites;
+                }
+                if (e.kind_ == rog::LogEntryKind::Leaf)
+                {
+                    sameResult = sameResult
+                        && e.parent_ != rog::BinaryLog::NoParent
+                        && log.entry(e.parent_).name_ == "Twin"
+                        && log.entry(e.parent_).result_ == e.result_;
+                }
+            }
+            this->assert_equals(composites, 2);
+            this->assert_true(sameResult, "Leaves are in their own twin");
+        }
+
+        std::remove(path.c_str());
+        std::remove(beforePath.c_str());
+        std::remove(afterPath.c_str());
+    }
+};
+
+class WorkBenchmark : public rog::BenchmarkTest
+{
+public:
+    WorkBenchmark (std::string name, int const work) :
+        rog::BenchmarkTest(
+            std::move(name),
+            rog::BenchmarkSettings {
+                .warmupTime_ = std::chrono::milliseconds(5),
+                .minSampleTime_ = std::chrono::milliseconds(2),
+                .sampleCount_ = 10
+            }
+        ),
+        work_(work)
+    {
+    }
+
+protected:
+    auto body () -> void override
+    {
+        auto sum = 0;
+        for (auto i = 0; i < work_; ++i)
+        {
+            sum += i;
+            rog::do_not_optimize(sum);
+        }
+    }
+
+private:
+    int work_;
+};
+
+/**
+ *  \brief Suite of benchmarks whose first one does \p work iterations.
+ */
+class GatedSuite : public rog::CompositeTest
+{
+public:
+    explicit GatedSuite (int const work) :
+        rog::CompositeTest("Gated suite")
+    {
+        this->add_test(std::make_unique<WorkBenchmark>("Changing", work));
+        this->add_test(std::make_unique<WorkBenchmark>("Same", 100));
+    }
+};
+
+/**
+ *  \brief Checks that a run compared with a baseline marks benchmarks
+ *  that became slower and counts them as failures.
+ */
+class BaselineCheck : public rog::LeafTest
+{
+public:
+    BaselineCheck () :
+        rog::LeafTest("Baseline check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const low = std::vector<double> {1, 2, 3, 4, 5, 6, 7, 8};
+        auto const high = std::vector<double> {11, 12, 13, 14, 15, 16, 17, 18};
+        this->assert_true(
+            rog::details::mann_whitney_greater(low, high) < 0.01,
+            "Larger sample is significant"
+        );
+        this->assert_true(
+            rog::details::mann_whitney_greater(high, low) > 0.99,
+            "Smaller sample is not significant"
+        );
+        this->assert_true(
+            rog::details::mann_whitney_greater(low, low) >= 0.4,
+            "Same sample is not significant"
+        );
+        this->assert_true(
+            rog::details::mann_whitney_greater({}, low) == 1.0,
+            "Empty sample is not significant"
+        );
+
+        auto const path = temporary_path();
+        auto before = GatedSuite(100);
+        run_logged(before, path);
+        {
+            auto const log = rog::BinaryLog(path);
+            auto const baseline = rog::Baseline(log, rog::RegressionSettings {.threshold_ = 10.0});
+            this->assert_equals(baseline.size(), std::size_t {2});
+
+            auto slower = GatedSuite(100000);
+            slower.run(rog::RunSettings {.baseline_ = &baseline});
+            auto const& changing = static_cast<rog::BenchmarkTest const&>(*slower.subtests()[0]);
+            this->assert_equals(changing.result(), rog::TestResult::Partial);
+            this->assert_true(
+                changing.regression().starts_with("Median time regressed from "),
+                "Regression is described"
+            );
+            this->assert_equals(slower.subtests()[1]->result(), rog::TestResult::Pass);
+
+            auto same = GatedSuite(100);
+            same.run(rog::RunSettings {.baseline_ = &baseline});
+            this->assert_equals(same.result(), rog::TestResult::Pass);
+
+            auto cancelled = GatedSuite(100000);
+            cancelled.run(rog::RunSettings {.maxFailures_ = 1, .baseline_ = &baseline});
+            this->assert_equals(cancelled.subtests()[0]->result(), rog::TestResult::Partial);
+            this->assert_equals(cancelled.subtests()[1]->result(), rog::TestResult::NotEvaluated);
+        }
+        std::remove(path.c_str());
+    }
+};
+
+/**
+ *  \brief Leaf that kills or hangs the worker process it runs in, after
+ *  it appended an attempt to \p attemptsPath . In the process that created
+ *  it, it just fails, so that a serial run has the same results.
+ */
+class DyingTest : public rog::LeafTest
+{
+public:
+    DyingTest (std::string name, bool const hangs, std::string attemptsPath) :
+        rog::LeafTest(std::move(name)),
+        hangs_(hangs),
+        attemptsPath_(std::move(attemptsPath)),
+        owner_(::getpid())
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        if (::getpid() == owner_)
+        {
+            this->fail("Dies in a worker");
+            return;
+        }
+
+        auto const fd = ::open(attemptsPath_.c_str(), O_WRONLY | O_APPEND);
+        [[maybe_unused]] auto const written = ::write(fd, "x", 1);
+        ::close(fd);
+        while (hangs_)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ::raise(SIGKILL);
+    }
+
+private:
+    bool hangs_;
+    std::string attemptsPath_;
+    pid_t owner_;
+};
+
+class CoordinatedSuite : public rog::CompositeTest
+{
+public:
+    CoordinatedSuite (std::string const& crashPath, std::string const& hangPath) :
+        rog::CompositeTest("Coordinated suite", rog::ExecutionPolicy::Parallel)
+    {
+        for (auto i = 0; i < 4; ++i)
+        {
+            this->add_test(std::make_unique<PassingTest>("Passes " + std::to_string(i)));
+        }
+        this->add_test(std::make_unique<DyingTest>("Crashes", false, crashPath));
+        this->add_test(std::make_unique<DyingTest>("Hangs", true, hangPath));
+        this->add_test(std::make_unique<FailingTest>("Fails", "Fails"));
+    }
+};
+
+/**
+ *  \brief Checks that leaves handed out to local workers are queued again
+ *  when their worker dies, fail once they killed \c MaxAttempts workers
+ *  or timed out, and that the merged results match a serial run.
+ */
+class CoordinatorCheck : public rog::LeafTest
+{
+public:
+    CoordinatorCheck () :
+        rog::LeafTest("Coordinator check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const crashPath = temporary_path();
+        auto const hangPath = temporary_path();
+        auto const socketPath = temporary_path();
+        std::remove(socketPath.c_str());
+
+        auto serial = CoordinatedSuite(crashPath, hangPath);
+        serial.run();
+
+        auto coordinated = CoordinatedSuite(crashPath, hangPath);
+        coordinated.run(rog::RunSettings {
+            .processCount_ = 2,
+            .coordinatorSocket_ = socketPath,
+            .timeout_ = std::chrono::milliseconds(300)
+        });
+
+        this->assert_equals(read_file(crashPath).size(), std::size_t {3});
+        this->assert_equals(read_file(hangPath).size(), std::size_t {1});
+
+        auto const leaf = [&coordinated] (std::size_t const i) -> rog::LeafTest const&
+        {
+            return static_cast<rog::LeafTest const&>(*coordinated.subtests()[i]);
+        };
+        this->assert_equals(leaf(0).result(), rog::TestResult::Pass);
+        this->assert_equals(leaf(4).result(), rog::TestResult::Fail);
+        this->assert_true(
+            has_message(leaf(4), rog::TestMessageType::Fail, "Crashed with SIGKILL"),
+            "Crash is failed with the exit reason"
+        );
+        this->assert_equals(leaf(5).result(), rog::TestResult::Fail);
+        this->assert_true(
+            has_message(leaf(5), rog::TestMessageType::Fail, "Timed out after "),
+            "Hang is failed with the time limit"
+        );
+        this->assert_true(
+            has_message(leaf(6), rog::TestMessageType::Fail, "Fails"),
+            "Messages of workers are merged"
+        );
+
+        auto const expected = serial.summary();
+        auto const actual = coordinated.summary();
+        this->assert_equals(actual.pass_, expected.pass_);
+        this->assert_equals(actual.fail_, expected.fail_);
+        this->assert_equals(actual.partial_, expected.partial_);
+        this->assert_equals(actual.notEvaluated_, expected.notEvaluated_);
+        this->assert_equals(coordinated.result(), serial.result());
+
+        std::remove(crashPath.c_str());
+        std::remove(hangPath.c_str());
+    }
+};
+
+/**
+ *  \brief Returns what \p write writes into the standard output.
+ */
+auto capture_stdout (std::function<void()> const& write) -> std::string
+{
+    auto* const file = std::tmpfile();
+    if (not file)
+    {
+        return {};
+    }
+
+    std::fflush(nullptr);
+    auto const out = ::dup(STDOUT_FILENO);
+    ::dup2(::fileno(file), STDOUT_FILENO);
+    write();
+    std::fflush(nullptr);
+    ::dup2(out, STDOUT_FILENO);
+    ::close(out);
+    auto text = read_all(file);
+    std::fclose(file);
+    return text;
+}
+
+/**
+ *  \brief Checks that the console emits colors only when asked to and
+ *  pads columns as \c std::setw did.
+ */
+class ConsoleCheck : public rog::LeafTest
+{
+public:
+    ConsoleCheck () :
+        rog::LeafTest("Console check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const write = [] (rog::ColorMode const mode)
+        {
+            return capture_stdout([mode]
+            {
+                auto console = rog::Console(mode);
+                console.print("pass", rog::Color::Green, 8);
+                console.print("exact", rog::Color::Default, 5);
+                console.print("longer than width", rog::Color::Red, 4);
+                console.println("line", rog::Color::Yellow, 6);
+                console.println("tail", rog::Color::Blue);
+            });
+        };
+
+        auto expected = std::ostringstream();
+        expected << std::left
+                 << std::setw(8) << "pass"
+                 << std::setw(5) << "exact"
+                 << std::setw(4) << "longer than width"
+                 << std::setw(6) << "line" << '\n'
+                 << "tail" << '\n';
+
+        auto const never = write(rog::ColorMode::Never);
+        this->assert_true(never.find('\x1B') == std::string::npos, "Never emits no escapes");
+        this->assert_equals(never, expected.str());
+
+        auto const always = write(rog::ColorMode::Always);
+        this->assert_true(always.find("\x1B[") != std::string::npos, "Always emits colors");
+
+        // Output into a file is not a terminal.
+        this->assert_equals(write(rog::ColorMode::Auto), expected.str());
+    }
+};
+
+class CountedSuite : public rog::CompositeTest
+{
+public:
+    CountedSuite () :
+        rog::CompositeTest("Counted suite")
+    {
+        this->add_test(std::make_unique<PassingTest>("Leaf"));
+        this->add_test(std::make_unique<WorkBenchmark>("Benchmark", 100));
+    }
+};
+
+/**
+ *  \brief Checks that hardware counters are empty when they are disabled
+ *  or not available, and that reporters then omit them instead
+ *  of printing zeros.
+ */
+class CountersCheck : public rog::LeafTest
+{
+public:
+    CountersCheck () :
+        rog::LeafTest("Counters check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        for (auto const enabled : {false, true})
+        {
+            auto* const xml = std::tmpfile();
+            auto* const jsonl = std::tmpfile();
+            auto* const tap = std::tmpfile();
+            if (not xml || not jsonl || not tap)
+            {
+                this->fail("Temporary files are not open");
+                return;
+            }
+
+            auto suite = CountedSuite();
+            auto const console = capture_stdout([&suite, xml, jsonl, tap, enabled]
+            {
+                auto junitReporter = rog::JUnitXmlReporter(::fileno(xml));
+                auto jsonlReporter = rog::JsonLinesReporter(::fileno(jsonl));
+                auto tapReporter = rog::TapReporter(::fileno(tap));
+                auto consoleReporter = rog::StreamingConsoleReporter(
+                    rog::ConsoleOutputType::Full,
+                    rog::ColorMode::Never
+                );
+                suite.run(rog::RunSettings {
+                    .hardwareCounters_ = enabled,
+                    .listeners_ = {&junitReporter, &jsonlReporter, &tapReporter, &consoleReporter}
+                });
+                rog::console_print_results(suite, rog::ConsoleOutputType::Full, rog::ColorMode::Never);
+            });
+            auto const reports = std::vector<std::string> {
+                read_all(xml), read_all(jsonl), read_all(tap), console
+            };
+            std::fclose(xml);
+            std::fclose(jsonl);
+            std::fclose(tap);
+
+            // Where counting works, only the counters it opened are reported.
+            for (auto const& t : suite.subtests())
+            {
+                for (auto const& [name, value] : rog::details::counter_fields(t->hardware_counters()))
+                {
+                    auto const label = std::string(name);
+                    auto spaced = label;
+                    std::ranges::replace(spaced, '_', ' ');
+                    if (not enabled)
+                    {
+                        this->assert_false(value.has_value(), "Disabled " + label + " is empty");
+                    }
+                    if (value)
+                    {
+                        continue;
+                    }
+                    for (auto const& report : reports)
+                    {
+                        this->assert_true(
+                            report.find(label) == std::string::npos
+                                && report.find(spaced) == std::string::npos,
+                            "Empty " + label + " is not reported"
+                        );
+                    }
+                }
+            }
+        }
+    }
+};
+
+/**
+ *  \brief Leaf that keeps the CPU busy for \p duration .
+ */
+class BusyTest : public rog::LeafTest
+{
+public:
+    BusyTest (std::string name, std::chrono::milliseconds const duration) :
+        rog::LeafTest(std::move(name)),
+        duration_(duration)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        auto const end = std::chrono::steady_clock::now() + duration_;
+        auto spins = 0;
+        while (std::chrono::steady_clock::now() < end)
+        {
+            ++spins;
+            rog::do_not_optimize(spins);
+        }
+        this->assert_true(spins > 0, "Spun");
+    }
+
+private:
+    std::chrono::milliseconds duration_;
+};
+
+class TimedSuite : public rog::CompositeTest
+{
+public:
+    TimedSuite () :
+        rog::CompositeTest("Timed suite", rog::ExecutionPolicy::Parallel)
+    {
+        for (auto const ms : {10, 0, 30, 20})
+        {
+            this->add_test(std::make_unique<SleepingTest>(
+                "Sleeps " + std::to_string(ms),
+                std::chrono::milliseconds(ms)
+            ));
+        }
+        this->add_test(std::make_unique<BusyTest>("Busy", std::chrono::milliseconds(5)));
+    }
+};
+
+/**
+ *  \brief Checks that wall and CPU times are recorded for every leaf and
+ *  that the slowest leaves are listed slowest first.
+ */
+class TimingCheck : public rog::LeafTest
+{
+public:
+    TimingCheck () :
+        rog::LeafTest("Timing check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        for (auto const threads : {1u, 4u})
+        {
+            auto suite = TimedSuite();
+            suite.run(rog::RunSettings {.threadCount_ = threads});
+            auto const timed = std::ranges::all_of(suite.subtests(), [](auto const& t)
+            {
+                return t->wall_time() > std::chrono::nanoseconds::zero()
+                    && t->cpu_time() >= std::chrono::nanoseconds::zero()
+                    && t->cpu_time() <= t->wall_time() + std::chrono::milliseconds(1);
+            });
+            this->assert_true(timed, "Every leaf has its times");
+            this->assert_true(
+                suite.subtests()[2]->wall_time() >= std::chrono::milliseconds(30),
+                "Wall time includes sleeping"
+            );
+            this->assert_true(
+                suite.subtests()[4]->cpu_time() > std::chrono::nanoseconds::zero(),
+                "CPU time includes spinning"
+            );
+
+            auto bySlowest = std::vector<rog::Test const*>();
+            for (auto const& t : suite.subtests())
+            {
+                bySlowest.emplace_back(t.get());
+            }
+            std::ranges::sort(bySlowest, std::ranges::greater(), &rog::Test::wall_time);
+
+            auto const printed = capture_stdout([&suite]
+            {
+                rog::console_print_slowest(suite, 3);
+            });
+            auto const at = [&printed] (rog::Test const* t)
+            {
+                return printed.find("Timed suite/" + std::string(t->name()) + "\n");
+            };
+            this->assert_true(
+                at(bySlowest[0]) < at(bySlowest[1])
+                    && at(bySlowest[1]) < at(bySlowest[2])
+                    && at(bySlowest[2]) != std::string::npos
+                    && at(bySlowest[3]) == std::string::npos
+                    && at(bySlowest[4]) == std::string::npos,
+                "Three slowest leaves are listed slowest first"
+            );
+        }
+    }
+};
+
+/**
+ *  \brief Runs \c rog::run_main with \p args and with its console output
+ *  discarded.
+ */
+auto run_main_quietly (std::vector<std::string> args) -> int
+{
+    args.insert(args.begin(), "librogtest");
+    auto argv = std::vector<char*>();
+    for (auto& a : args)
+    {
+        argv.emplace_back(a.data());
+    }
+    argv.emplace_back(nullptr);
+
+    std::fflush(nullptr);
+    auto const out = ::dup(STDOUT_FILENO);
+    auto const err = ::dup(STDERR_FILENO);
+    auto const null = ::open("/dev/null", O_WRONLY);
+    ::dup2(null, STDOUT_FILENO);
+    ::dup2(null, STDERR_FILENO);
+    auto const status = rog::run_main(static_cast<int>(args.size()), argv.data());
+    std::fflush(nullptr);
+    ::dup2(out, STDOUT_FILENO);
+    ::dup2(err, STDERR_FILENO);
+    ::close(null);
+    ::close(out);
+    ::close(err);
+    return status;
+}
+
+/**
+ *  \brief Checks that registered leaves are built only when selected and
+ *  run, that conflicting paths are rejected, and the exit codes
+ *  of \c rog::run_main .
+ */
+class RegistryCheck : public rog::LeafTest
+{
+public:
+    RegistryCheck () :
+        rog::LeafTest("Registry check", rog::AssertPolicy::RunAll)
+    {
+    }
+
+protected:
+    auto test () -> void override
+    {
+        // The registry outlives this check, so it holds the counters.
+        auto const selectedBuilds = std::make_shared<int>(0);
+        auto const skippedBuilds = std::make_shared<int>(0);
+        rog::register_test("Registry check/Selected", [selectedBuilds]
+        {
+            ++*selectedBuilds;
+            return std::unique_ptr<rog::LeafTest>(std::make_unique<PassingTest>("Selected"));
+        });
+        rog::register_test("Registry check/Skipped", [skippedBuilds]
+        {
+            ++*skippedBuilds;
+            return std::unique_ptr<rog::LeafTest>(std::make_unique<PassingTest>("Skipped"));
+        });
+        rog::register_test("Registry check/Fails", []
+        {
+            return std::unique_ptr<rog::LeafTest>(std::make_unique<FailingTest>("Fails", "Fails"));
+        });
+
+        auto filter = rog::TestFilter();
+        filter.include("Registry check/Selected");
+        auto const root = rog::make_registered_tests(filter);
+        this->assert_equals(*selectedBuilds, 0);
+        root->run(rog::RunSettings {.filter_ = filter});
+        this->assert_equals(*selectedBuilds, 1);
+        this->assert_equals(*skippedBuilds, 0);
+        this->assert_equals(root->summary().pass_, std::size_t {1});
+
+        auto const rejects = [] (std::string path)
+        {
+            try
+            {
+                rog::register_test(std::move(path), [] { return std::unique_ptr<rog::LeafTest>(); });
+            }
+            catch (std::invalid_argument const&)
+            {
+                return true;
+            }
+            return false;
+        };
+        this->assert_true(rejects("Registry check/Selected"), "Duplicate path is rejected");
+        this->assert_true(rejects("Registry check/Selected/Leaf"), "Leaf as a suite is rejected");
+        this->assert_true(rejects("Registry check"), "Suite as a leaf is rejected");
+
+        auto const path = temporary_path();
+        this->assert_equals(
+            run_main_quietly({"--filter", "Registry check/Selected", "--jsonl", path}),
+            0
+        );
+        auto paths = std::vector<std::string>();
+        auto const lines = read_file(path);
+        for (auto begin = std::size_t {0}, end = lines.find('\n');
+             end != std::string::npos;
+             begin = end + 1, end = lines.find('\n', begin))
+        {
+            auto const line = std::string_view(lines).substr(begin, end - begin);
+            if (json_field(line, "event") == "test_finished")
+            {
+                paths.emplace_back(json_field(line, "path"));
+            }
+        }
+        this->assert_equals(paths.size(), std::size_t {1});
+        this->assert_true(
+            not paths.empty() && paths.front() == "Registry check/Selected",
+            "Path has no leading slash"
+        );
+        std::remove(path.c_str());
+
+        this->assert_equals(run_main_quietly({"--filter", "Registry check/*"}), 1);
+        this->assert_equals(run_main_quietly({"--bogus"}), 2);
+        this->assert_equals(run_main_quietly({"--threads"}), 2);
+        this->assert_equals(run_main_quietly({"--threads", "many"}), 2);
+        this->assert_equals(run_main_quietly({"--shard-index", "2", "--shard-count", "2"}), 2);
+    }
+};
+#endif
+
+/**
+ *  \brief Checks of the library, the program fails if any of them fails.
+ */
+class Checks : public rog::CompositeTest
+{
+public:
+    Checks () :
+        rog::CompositeTest("Checks")
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        this->add_test(std::make_unique<TimeoutReportCheck>());
+        this->add_test(std::make_unique<ReporterCheck>());
+        this->add_test(std::make_unique<BinaryLogCheck>());
+        this->add_test(std::make_unique<BaselineCheck>());
+        this->add_test(std::make_unique<CoordinatorCheck>());
+        this->add_test(std::make_unique<RegistryCheck>());
+        this->add_test(std::make_unique<ConsoleCheck>());
+        this->add_test(std::make_unique<CountersCheck>());
+        this->add_test(std::make_unique<TimingCheck>());
+#endif
+        this->add_test(std::make_unique<SuiteCheck>());
+        this->add_test(std::make_unique<LazyCheck>());
+        this->add_test(std::make_unique<RecordCheck>());
+        this->add_test(std::make_unique<FilterCheck>());
+        this->add_test(std::make_unique<ShardCheck>());
+        this->add_test(std::make_unique<CancellationCheck>());
+        this->add_test(std::make_unique<EventOrderCheck>());
+        this->add_test(std::make_unique<SummaryCheck>());
+        this->add_test(std::make_unique<PropertyCheck>());
+        this->add_test(std::make_unique<DomainCheck>());
+        this->add_test(std::make_unique<RangeCheck>());
+        this->add_test(std::make_unique<FloatCheck>());
+        this->add_test(std::make_unique<AllocationCheck>());
+    }
+};
+
+auto main () -> int
+{
+    auto t = DummyTest();
+    t.run();
+    rog::console_print_results(t, rog::ConsoleOutputType::NoLeaf);
+
+    auto b = DummyBenchmark();
+    b.run();
+    rog::console_print_results(b, rog::ConsoleOutputType::Full);
+
+    auto checks = Checks();
+    checks.run();
+    rog::console_print_results(checks, rog::ConsoleOutputType::Full);
+    auto const summary = checks.summary();
+    return summary.fail_ + summary.partial_ > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
\ No newline at end of file